@@ -8,476 +8,4016 @@
 #include <SALT_ext_sensors.h>
 
 
+//---------------------------< C O N V E R S I O N S >--------------------------------------------------------
+//
+// raw sensor register values to rounded hundredths of a °C, °F, or %RH; integer math only
+//
+
+static inline int16_t tmp275_centi_c (uint16_t raw)			// 12-bit left-justified two's complement; 1/256 °C per lsb
+	{
+	int32_t	centi = (int32_t)(int16_t)raw * 100;
+
+	return (centi + ((0 > centi) ? -128 : 128)) / 256;
+	}
+
+static inline int16_t tmp275_centi_f (uint16_t raw)			// °F = (raw * 1.8 / 256) + 32
+	{
+	int32_t	centi = (int32_t)(int16_t)raw * 180;
+
+	return ((centi + ((0 > centi) ? -128 : 128)) / 256) + 3200;
+	}
+
+static inline int16_t hdc1080_centi_c (uint16_t raw)			// °C = (raw * 165 / 2^16) - 40
+	{
+	return (int16_t)(((((uint32_t)raw * 16500) + 32768) >> 16) - 4000);
+	}
+
+static inline int16_t hdc1080_centi_f (uint16_t raw)			// °F = (raw * 297 / 2^16) - 40
+	{
+	return (int16_t)(((((uint32_t)raw * 29700) + 32768) >> 16) - 4000);
+	}
+
+static inline int16_t hdc1080_centi_rh (uint16_t raw)			// %RH = raw * 100 / 2^16
+	{
+	return (int16_t)((((uint32_t)raw * 10000) + 32768) >> 16);
+	}
+
+static inline int16_t centi_c_to_f (int16_t centi_c)			// °F = (°C * 9 / 5) + 32
+	{
+	int32_t	centi = (int32_t)centi_c * 9;
+
+	return ((centi + ((0 > centi) ? -2 : 2)) / 5) + 3200;
+	}
+
+
+//---------------------------< C E N T I _ T E X T >----------------------------------------------------------
+//
+// format hundredths the way "% 3.1f" formats the value; no float math
+//
+
+static void centi_text (char* text, int16_t centi)
+	{
+	int16_t		tenths = (centi + ((0 > centi) ? -5 : 5)) / 10;	// round to tenths
+	uint16_t	mag = (0 > tenths) ? -tenths : tenths;
+
+	sprintf (text, "%c%d.%d", (0 > tenths) ? '-' : ' ', mag / 10, mag % 10);
+	}
+
+
+//---------------------------< E E P R O M   F I E L D S >----------------------------------------------------
+//
+// eeprom page type characters and little-endian multi-byte fields
+//
+
+static inline boolean eep_type_char (uint8_t c)				// allowed first character of a page type
+	{
+	return (('A' <= c) && ('Z' >= c)) || (('0' <= c) && ('9' >= c));
+	}
+
+static inline uint32_t le32_get (const uint8_t* ptr)
+	{
+	return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+	}
+
+static inline uint8_t* varint_put (uint8_t* ptr, uint32_t value)	// 7 bits per byte, low first; msb set on all but the last
+	{
+	while (0x7F < value)
+		{
+		*ptr++ = (uint8_t)value | 0x80;
+		value >>= 7;
+		}
+	*ptr++ = (uint8_t)value;
+	return ptr;
+	}
+
+static inline uint32_t zigzag (int32_t value)					// 0, -1, 1, -2 .. to 0, 1, 2, 3 ..
+	{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	}
+
+static inline uint32_t channels_open (uint32_t bits, uint8_t i)	// port sensor channel bits i .. up one; bit i clear
+	{
+	uint32_t	low = (1UL << i) - 1;
+	uint32_t	reg = (1UL << MAX_REG_SENSORS) - 1;
+
+	return (bits & (low | ~reg)) | (((bits & reg & ~low) << 1) & reg);
+	}
+
+static inline uint32_t channels_close (uint32_t bits, uint8_t i)	// port sensor channel bits i + 1 .. down one; bit i dropped
+	{
+	uint32_t	low = (1UL << i) - 1;
+	uint32_t	reg = (1UL << MAX_REG_SENSORS) - 1;
+
+	return (bits & (low | ~reg)) | (((bits & reg & ~low) >> 1) & ~low);
+	}
+
+
+//---------------------------< M U X - M O U N T E D   A D D R E S S E S >------------------------------------
+//
+// i2c addresses that may respond on port[7] of a mux; probed as a group during discovery.  Order must match the
+// MMS_xxx bit definitions in SALT_ext_sensors.h
+//
+
+static const uint8_t mms_addrs[MMS_ADDRS] = {MUX_EEP_ADDR, TMP275_SLAVE_ADDR_7, MUX_HDC1080_ADDR, MUX_MS8607_PT_ADDR};
+
+
+//---------------------------< P O R T   S E N S O R   D R I V E R S >----------------------------------------
+//
+// port sensor types; indexed by PORT_DRIVER_xxx
+//
+
+const SALT_ext_sensors::port_driver_t SALT_ext_sensors::port_drivers[PORT_DRIVERS] =
+	{
+	{"TMP275", TMP275_BASE_MIN, 2, &SALT_ext_sensors::port_tmp275_init, tmp275_centi_c, tmp275_centi_f, &SALT_ext_sensors::port_tmp275_float},
+	};
+
+
+//---------------------------< E V E N T   L O G   T E X T >--------------------------------------------------
+//
+// log_drain() text for each XLOG_xxx event code; indexed by code.  The event's mux[m].port[p].sensor[s] location
+// is printed ahead of the text.  A format specifier takes the event status; XLOG_MMS_xxx text takes the sensor
+// name instead.
+//
+
+const char* const SALT_ext_sensors::xlog_text[XLOG_CODES] =
+	{
+	"",													// XLOG_E7N; drained to logs.log_event()
+	"discovering external sensors...",
+	"discovery done (%dmS)",
+	"discovering mux-mounted sensors...",
+	"\trestored %d mux topology",
+	"\tfixed topology 0x%.04X verified",
+	"\tfixed topology 0x%.04X not found; runtime discovery",
+	" detected",
+	" not detected",
+	" tmp275 detected",
+	" tmp275 not detected",
+	" select fail (0x%.02X)",
+	" eeprom detected",
+	" eeprom not detected",
+	" uninitialized eeprom",
+	" unknown [sensor %d] type",
+	" [sensor %d] type not specified",
+	" eeprom read fail; mux-mounted sensors not set up",
+	" %s specified but not detected",
+	" %s init fail",
+	" %s initialized",
+	" MS8607 detected; expected HDC1080",
+	" registry full; sensor ignored",
+	" not responding; backed off (%d faults)",
+	" recovered (%d faults)",
+	" rate up to %dkHz",
+	" errors; rate down to %dkHz",
+	" plugged in; registry entry %d",
+	" unplugged; registry entry %d removed",
+	" replaced; registry entry %d set up again",
+	};
+
+
 //---------------------------< P I N G E X >------------------------------------------------------------------
 //
+// pings an i2c address on the bus of mux[m] (see mux_bus_set()), by default the external sensor net; returns
+// SUCCESS if the address was acked.  The bus work is SALT_ext_bus::ping().
+//
+
+uint8_t SALT_ext_sensors::pingex (uint8_t addr, uint8_t m)
+	{
+	return mux_bus ((MAX_MUXES > m) ? m : 0).ping (addr);
+	}
+
+
+//---------------------------< R A T E _ A P P L Y >----------------------------------------------------------
+//
+// set the bus rate to hz unless that is the rate last set; call only while no transfer is in progress
+//
+
+void SALT_ext_bus::rate_apply (uint32_t hz)
+	{
+	if (hz == rate_now)
+		return;
+	wire.setClock (hz);
+	rate_now = hz;
+	}
+
+
+//---------------------------< P I N G >----------------------------------------------------------------------
 //
+// pings an i2c address on this bus; returns SUCCESS if the address was acked
 //
 
-uint8_t SALT_ext_sensors::pingex (uint8_t addr, i2c_t3 wire)
+uint8_t SALT_ext_bus::ping (uint8_t addr)
 	{
 	wire.beginTransmission (addr);				// set the device slave address
-	return wire.endTransmission();						// send slave address; returns SUCCESS if the address was acked
+	return wire.endTransmission();				// send slave address; returns SUCCESS if the address was acked
 	}
 
 
-//---------------------------< S E N S O R _ D I S C O V E R >------------------------------------------------
+//---------------------------< P R O B E _ M A S K >----------------------------------------------------------
 //
-// Scan through the mux[].port[].sensor[] struct and interrogate the external i2c net for sensor node eeproms.
-// eeproms on sensor nodes have i2c slave addresses in the range 0x50-0x57.  The low nibble of the eeprom
-// slave address usually matches the low nibble of the sensor device on that node.  This code does not contemplate
-// the possibility that a sensor may have an address range that is limited with respect to the eeprom - the sensor
-// device may only support 1, 2, 4 addresses compared to the eeprom's 8 addresses.  This is presumably handled
-// in hardware by limiting the address jumper availability and hardwiring the appropriate eeprom address pins
-// to ground.
+// Pings each of up to eight consecutive i2c addresses base + n where bit n of want is set.  Returns a presence
+// bitmap: bit n is set when base + n acked.  Addresses whose want bit is clear are not probed.
 //
-// RULES:
-//	1. all muxes, ports, sensors must begin at zero
-//	2. no empties: if there are two muxes in a system they shall be mux[0] and mux[1]; not mux[0] and mux[m>1]
-//	3. when adding sensors to a mux, begin at port[0]; no empties
-//	4. when adding sensors to a port, begin with sensor[0]; no empties
+//	eep_mask = bus.probe_mask (EEP_BASE_MIN, 0xFF);		// which of 0x50-0x57 are present?
 //
-// TODO: what about the mux-mounted sensors on port[7]?  Because these are 'different', handle them elsewhere?
-// TODO: How to map physical sensor location to the electrical sensor location?  There is no map; we define the
-// physical and electrical locations.  See table on sheet 2 of the mux schematics.
+
+uint8_t SALT_ext_bus::probe_mask (uint8_t base, uint8_t want)
+	{
+	uint8_t	mask = 0;
+
+	for (uint8_t n = 0; n < 8; n++)
+		{
+		if ((want & (1 << n)) && (SUCCESS == ping (base + n)))
+			mask |= (1 << n);
+		}
+	return mask;
+	}
+
+
+//---------------------------< P R O B E _ L I S T >----------------------------------------------------------
 //
-// eeprom mapping?
-// eeprom is 4kx8 and has 128 32-byte pages.  page 0 identifies the assembly?
+// Pings each of count (max 8) arbitrary i2c addresses in addrs[].  Returns a presence bitmap: bit n is set when
+// addrs[n] acked.
 //
-// page 0:	information about the assembly
-//		0x0000 - 0x000F:	assembly name; 16 characters null filled; known assemblies are:
-//			"TMP275"
-//			"MUX"
-//		0x0010 - 0x0011:	assembly revision; two byte little endian; MM.mm in the form 0xMMmm
-//		0x0010: mm
-//		0x0011: MM
-//		0x0012 - 0x0015:	assembly manufacture date; four byte time_t little endian
-//		0x0016 - 0x0019:	assembly service date; four byte time_t little endian
-//		0x001A - 0x001F:	undefined; 6 bytes
+
+uint8_t SALT_ext_bus::probe_list (const uint8_t* addrs, uint8_t count)
+	{
+	uint8_t	mask = 0;
+
+	for (uint8_t n = 0; (n < count) && (n < 8); n++)
+		{
+		if (SUCCESS == ping (addrs[n]))
+			mask |= (1 << n);
+		}
+	return mask;
+	}
+
+
+//---------------------------< G R O U P _ N E W >------------------------------------------------------------
 //
-// page 1:	information about a sensor
-//		0x0020 - 0x002F:	sensor name; 16 characters null filled; known sensors are:
-//			"TMP275"		- temperature
-//			"HDC1080"		- temperature and relative humidity
-//			"MS8607PT"		- the pressure and temperature sensors (i2c address 0x76)
-//			"MS8607H"		- the relative humidity sensor (i2c address 0x40)
-//		0x0030:				sensor i2c address; one byte:
-//								bits 6..0: the i2c address
-//								bit 7:
-//									when 0, the value in bits 6..0 is a base address modified by the assembly's address jumpers
-//									when set, the value in bits 6..0 is an absolute address
-//		0x0031 - 0x003F:	undefined; 15 bytes
+// Returns the next free group, empty, or NULL when the ring is full.  The group is not queued until submit().
+// When rate is not NULL the bus is set to *rate as the group's first transfer starts.
 //
-// page 2:	information about a sensor (same format a page 1; repeat as often as necessary within reason)
+
+SALT_ext_xq::group_t* SALT_ext_xq::group_new (done_t done, void* ctx, uint16_t tag, const uint32_t* rate)
+	{
+	group_t*	group;
+
+	if (XQ_SIZE == pending ())
+		{
+		stats.full++;
+		return NULL;
+		}
+
+	group = &ring[tail & (XQ_SIZE - 1)];
+	group->ops = 0;
+	group->status = SUCCESS;
+	group->done = done;
+	group->ctx = ctx;
+	group->tag = tag;
+	group->rate = rate;
+	return group;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
 //
+// add a transfer that writes len bytes of data to addr; returns FAIL when the group or the transfer is too big
 //
-//	[assembly]
-//	# in case we perhaps do the right thing some day and place an eeprom on the same bus as the mux common
-//	type = MUX7
-//	revision = 2.0
-//	manuf date = 2017-08-19
-//	[sensor 1]
-//	type1 = TMP275
-//	# address is two hexadecimal digits
-//	address1 = 48
-//	absolute1 = no
-//	[sensor 2]
-//	type2 = HDC1080
-//	# address is two hexadecimal digits
-//	address2 = 40
-//	absolute2 = yes
+
+uint8_t SALT_ext_xq::write (group_t* group, uint8_t addr, const uint8_t* data, uint8_t len, uint8_t flags)
+	{
+	op_t*	op_ptr;
+
+	if ((XQ_OPS <= group->ops) || (XQ_DATA < len))
+		return FAIL;
+
+	op_ptr = &group->op[group->ops++];
+	op_ptr->addr = addr;
+	op_ptr->len = len;
+	op_ptr->read = false;
+	op_ptr->flags = flags;
+	op_ptr->status = FAIL;
+	op_ptr->started = false;
+	memcpy (op_ptr->data, data, len);
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// add a transfer that reads len bytes from addr into the op's data[]; returns FAIL when the group or the transfer
+// is too big
 //
 
+uint8_t SALT_ext_xq::read (group_t* group, uint8_t addr, uint8_t len, uint8_t flags)
+	{
+	op_t*	op_ptr;
 
-uint8_t SALT_ext_sensors::sensor_discover (void)
+	if ((XQ_OPS <= group->ops) || (XQ_DATA < len))
+		return FAIL;
+
+	op_ptr = &group->op[group->ops++];
+	op_ptr->addr = addr;
+	op_ptr->len = len;
+	op_ptr->read = true;
+	op_ptr->flags = flags;
+	op_ptr->status = FAIL;
+	op_ptr->started = false;
+	return SUCCESS;
+	}
+
+
+//---------------------------< S U B M I T >------------------------------------------------------------------
+//
+// queue the group most recently returned by group_new(); it starts on a later poll()
+//
+
+void SALT_ext_xq::submit (group_t* group)
 	{
-	uint8_t	m;				// indexer into mux
-	uint8_t	p;				// indexer into port
-	uint8_t	s;				// indexer into sensor
+	if (group == &ring[tail & (XQ_SIZE - 1)])
+		tail++;
+	}
 
-	uint8_t	mux_addr;
-	uint8_t	eep_addr;
-	uint8_t	sensor_addr;
-	uint8_t	sensor_type;											// temp value storage for type val read from eeprom
-	boolean	break_flag=false;	// used when breaking out of switch should cause break out of sensor for loop
 
-	uint32_t	start = millis();
+//---------------------------< P O L L >----------------------------------------------------------------------
+//
+// Collect the result of the transfer on the bus if it is complete, then start the next transfer.  A group whose
+// transfers are all done has its done() callback called and is removed from the ring.  When a transfer flagged
+// XQ_REQUIRED fails, the rest of the group's transfers are skipped (status FAIL) except those flagged XQ_ALWAYS.
+// Returns the number of groups still pending; never waits on the bus.
+//
 
-	Serial.printf ("discovering external sensors...\n");
+uint8_t SALT_ext_xq::poll (void)
+	{
+	group_t*	group;
+	op_t*		op_ptr;
+	boolean		skip;
+	boolean		stamped = false;								// start_us is now: a transfer just completed
 
-	for (m = 0; m < MAX_MUXES; m++)
+	while (pending ())
 		{
-		sensor_type = TMP275;								// spoof until eeprom code written
+		group = &ring[head & (XQ_SIZE - 1)];
 
-																	// perhaps this is a flaw in the design?  The local eeprom is 'hidden'
-																	// on port 7.  Shouldn't it be on the same 'bus' as the mux?
-		mux_addr = PCA9548A_BASE_MIN | (m & 7);						// make 9548A slave address from lowest base addr and mux array index
-		if (SUCCESS != pingex (mux_addr, Wire1))
+		if (active)
+			{
+			if (!bus.wire.done ())									// transfer still on the bus
+				return pending ();
+
+			active = false;
+			op_ptr = &group->op[op];
+			op_ptr->us = micros() - start_us;
+			start_us += op_ptr->us;									// one micros() per transfer: its completion is the next one's start
+			stamped = true;
+			op_ptr->bus_status = bus.wire.status ();
+			if (SUCCESS == bus.wire.getError ())
+				{
+				op_ptr->status = SUCCESS;
+				if (op_ptr->read)
+					{
+					if (op_ptr->len == bus.wire.available ())
+						{
+						for (uint8_t i = 0; i < op_ptr->len; i++)
+							op_ptr->data[i] = bus.wire.read ();
+						}
+					else
+						op_ptr->status = FAIL;
+					}
+				}
+			if (SUCCESS != op_ptr->status)
+				group->status = FAIL;
+			op++;
+			}
+
+		skip = false;												// find the next transfer to start
+		for (uint8_t i = 0; i < op; i++)
+			if ((group->op[i].flags & XQ_REQUIRED) && (SUCCESS != group->op[i].status))
+				skip = true;
+		while (skip && (op < group->ops) && !(group->op[op].flags & XQ_ALWAYS))
+			{
+			group->op[op].status = FAIL;							// skipped
+			op++;
+			}
+
+		if (op < group->ops)										// start it
+			{
+			op_ptr = &group->op[op];
+			if ((0 == op) && group->rate)
+				bus.rate_apply (*group->rate);						// the group's mux branch rate
+			if (op_ptr->read)
+				bus.wire.sendRequest (op_ptr->addr, op_ptr->len, I2C_STOP);
+			else
+				{
+				bus.wire.beginTransmission (op_ptr->addr);
+				bus.wire.write (op_ptr->data, op_ptr->len);
+				bus.wire.sendTransmission (I2C_STOP);
+				}
+			if (!stamped)
+				start_us = micros();
+			op_ptr->started = true;
+			stats.transfers++;
+			active = true;
+			return pending ();
+			}
+
+		stats.groups++;												// group complete
+		if (SUCCESS != group->status)
+			stats.failed++;
+		if (group->done)
+			group->done (group);
+		head++;														// free the entry after done() has used it
+		op = 0;
+		}
+
+	return 0;
+	}
+
+
+//---------------------------< F L U S H >--------------------------------------------------------------------
+//
+// run the engine until every queued group is done
+//
+
+void SALT_ext_xq::flush (void)
+	{
+	while (poll ())
+		bus.wire.finish ();
+	}
+
+
+//---------------------------< C L E A R >--------------------------------------------------------------------
+//
+// forget all samples; window lengths are kept
+//
+
+void SALT_ext_history::clear (void)
+	{
+	for (uint8_t i = 0; i < HIST_WINDOWS; i++)
+		{
+		window[i].count = 0;
+		window[i].sum = 0;
+		window[i].min_head = window[i].min_tail = 0;
+		window[i].max_head = window[i].max_tail = 0;
+		}
+	fill = 0;
+	}
+
+
+//---------------------------< W I N D O W _ S E T >----------------------------------------------------------
+//
+// Make window w cover the most recent len samples (clamped to 1 .. HIST_SIZE).  The window is rebuilt from the
+// samples still in the ring so its queries are valid immediately.
+//
+
+void SALT_ext_history::window_set (uint8_t w, uint8_t len)
+	{
+	window_t*	w_ptr = &window[w];
+	uint8_t		n;
+
+	if (HIST_WINDOWS <= w)
+		return;
+
+	w_ptr->len = (0 == len) ? 1 : ((HIST_SIZE < len) ? HIST_SIZE : len);
+	w_ptr->count = 0;
+	w_ptr->sum = 0;
+	w_ptr->min_head = w_ptr->min_tail = 0;
+	w_ptr->max_head = w_ptr->max_tail = 0;
+
+	n = (fill < w_ptr->len) ? fill : w_ptr->len;					// replay the newest n samples, oldest first
+	for (uint8_t at = seq - n; at != seq; at++)
+		window_add (w_ptr, at, ring[at & (HIST_SIZE - 1)]);
+	}
+
+
+//---------------------------< P U S H >----------------------------------------------------------------------
+//
+// add the newest sample to the ring and to every window
+//
+
+void SALT_ext_history::push (int16_t value)
+	{
+	for (uint8_t i = 0; i < HIST_WINDOWS; i++)
+		window_add (&window[i], seq, value);
+
+	ring[seq & (HIST_SIZE - 1)] = value;							// after window_add(); it may need the sample this overwrites
+	seq++;
+	if (HIST_SIZE > fill)
+		fill++;
+	}
+
+
+//---------------------------< W I N D O W _ A D D >----------------------------------------------------------
+//
+// Add sample at (sequence number) with value to window w.  When the window is full the sample that falls out of
+// it is subtracted from the sum.  Queue entries that fall out of the window are dropped from the front; entries
+// that the new sample makes irrelevant (not smaller for min_q, not larger for max_q) are dropped from the back.
+// Each sample enters and leaves each queue once so this is amortized constant time.
+//
+
+void SALT_ext_history::window_add (window_t* w, uint8_t at, int16_t value)
+	{
+	const uint8_t	mask = HIST_SIZE - 1;
+
+	if (w->len == w->count)
+		w->sum -= ring[(uint8_t)(at - w->len) & mask];				// oldest sample leaves the window
+	else
+		w->count++;
+	w->sum += value;
+
+	while ((w->min_head != w->min_tail) && (w->len <= (uint8_t)(at - w->min_q[w->min_head & mask])))
+		w->min_head++;
+	while ((w->min_head != w->min_tail) && (value <= ring[w->min_q[(uint8_t)(w->min_tail - 1) & mask] & mask]))
+		w->min_tail--;
+	w->min_q[w->min_tail++ & mask] = at;
+
+	while ((w->max_head != w->max_tail) && (w->len <= (uint8_t)(at - w->max_q[w->max_head & mask])))
+		w->max_head++;
+	while ((w->max_head != w->max_tail) && (value >= ring[w->max_q[(uint8_t)(w->max_tail - 1) & mask] & mask]))
+		w->max_tail--;
+	w->max_q[w->max_tail++ & mask] = at;
+	}
+
+
+//---------------------------< C O U N T _ G E T >------------------------------------------------------------
+
+uint8_t SALT_ext_history::count_get (uint8_t w)
+	{
+	return (HIST_WINDOWS > w) ? window[w].count : 0;
+	}
+
+
+//---------------------------< M I N _ G E T >----------------------------------------------------------------
+//
+// the newest queue entries are not yet in the ring when window_add() runs; by the time a query can run they are
+//
+
+int16_t SALT_ext_history::min_get (uint8_t w)
+	{
+	if (!count_get (w))
+		return 0;
+	return ring[window[w].min_q[window[w].min_head & (HIST_SIZE - 1)] & (HIST_SIZE - 1)];
+	}
+
+
+//---------------------------< M A X _ G E T >----------------------------------------------------------------
+
+int16_t SALT_ext_history::max_get (uint8_t w)
+	{
+	if (!count_get (w))
+		return 0;
+	return ring[window[w].max_q[window[w].max_head & (HIST_SIZE - 1)] & (HIST_SIZE - 1)];
+	}
+
+
+//---------------------------< M E A N _ G E T >--------------------------------------------------------------
+
+int16_t SALT_ext_history::mean_get (uint8_t w)
+	{
+	int32_t	count = count_get (w);
+
+	if (!count)
+		return 0;
+	if (0 > window[w].sum)
+		return (window[w].sum - (count / 2)) / count;				// round half away from zero
+	return (window[w].sum + (count / 2)) / count;
+	}
+
+
+//---------------------------< L A S T _ G E T >--------------------------------------------------------------
+
+int16_t SALT_ext_history::last_get (void)
+	{
+	if (!fill)
+		return 0;
+	return ring[(uint8_t)(seq - 1) & (HIST_SIZE - 1)];
+	}
+
+
+//---------------------------< C L E A R >--------------------------------------------------------------------
+
+void SALT_ext_istats::clear (void)
+	{
+	memset (this, 0, sizeof(*this));
+	}
+
+
+//---------------------------< R E C O R D >------------------------------------------------------------------
+//
+// count one transfer that took us microseconds and moved bytes data bytes when it succeeded; status is the
+// i2c_t3 status() after the transfer: I2C_WAITING when it succeeded
+//
+
+void SALT_ext_istats::record (uint32_t us, uint8_t bytes, uint8_t status)
+	{
+	uint8_t	b;
+
+	for (b = 0; (b < (ISTATS_BUCKETS - 1)) && (((uint32_t)ISTATS_BUCKET0_US << b) <= us); b++)
+		;
+	if (0xFFFF > hist[b])
+		hist[b]++;
+	if (us > max_us)
+		max_us = us;
+	transfers++;
+
+	if (I2C_WAITING == status)
+		this->bytes += bytes;
+	else if ((I2C_ADDR_NAK == status) || (I2C_DATA_NAK == status))
+		{
+		if (0xFFFF > naks)
+			naks++;
+		}
+	else if (0xFFFF > timeouts)
+		timeouts++;
+	}
+
+
+//---------------------------< M S 8 6 0 7   O S R S >--------------------------------------------------------
+//
+// per MS8607_OSR_xxx: datasheet max pressure or temperature conversion time, and the humidity resolution that
+// converts in about the same time (user register bits 7 and 0) with its max conversion time
+//
+
+static const struct
+	{
+	uint16_t	pt_us;
+	uint8_t		h_res;
+	uint16_t	h_us;
+	} ms8607_osrs[MS8607_OSRS] =
+	{
+	{560, 0x01, 3000},											// OSR 256; 8-bit rh
+	{1100, 0x01, 3000},											// OSR 512; 8-bit rh
+	{2170, 0x80, 5000},											// OSR 1024; 10-bit rh
+	{4320, 0x80, 5000},											// OSR 2048; 10-bit rh
+	{8610, 0x81, 9000},											// OSR 4096; 11-bit rh
+	{17200, 0x00, 16000},										// OSR 8192; 12-bit rh
+	};
+
+
+//---------------------------< P R O M _ C H E C K >----------------------------------------------------------
+//
+// CRC-4 over prom[] (with word 0's CRC nibble cleared and an eighth word of 0) as the datasheet specifies
+//
+
+boolean SALT_ext_ms8607::prom_check (void)
+	{
+	uint16_t	rem = 0;
+	uint16_t	word;
+
+	for (uint8_t cnt = 0; cnt < 16; cnt++)
+		{
+		word = (7 > (cnt >> 1)) ? prom[cnt >> 1] : 0;
+		if (0 == (cnt >> 1))
+			word &= 0x0FFF;
+		rem ^= (cnt & 1) ? (word & 0x00FF) : (word >> 8);
+		for (uint8_t bit = 8; bit > 0; bit--)
+			rem = (rem & 0x8000) ? ((rem << 1) ^ 0x3000) : (rem << 1);
+		}
+	return ((rem >> 12) & 0x000F) == (prom[0] >> 12);
+	}
+
+
+//---------------------------< C O M P E N S A T E >----------------------------------------------------------
+//
+// Datasheet first and second order compensation of d2 into data.centi_c and, with d1, of d1 into data.pa.
+// Leaves data.centi_c alone until there is a d2 and sets data.pa to 0 until there is a d1.
+//
+
+void SALT_ext_ms8607::compensate (void)
+	{
+	int32_t		dt;
+	int32_t		temp;
+	int64_t		t2;
+	int64_t		off2 = 0;
+	int64_t		sens2 = 0;
+	int64_t		off;
+	int64_t		sens;
+
+	if (!d2)
+		return;
+
+	dt = (int32_t)d2 - ((int32_t)prom[5] << 8);
+	temp = 2000 + (int32_t)(((int64_t)dt * prom[6]) >> 23);
+	if (2000 > temp)											// low temperature
+		{
+		t2 = (3 * (int64_t)dt * dt) >> 33;
+		off2 = (61 * (int64_t)(temp - 2000) * (temp - 2000)) >> 4;
+		sens2 = (29 * (int64_t)(temp - 2000) * (temp - 2000)) >> 4;
+		if (-1500 > temp)										// very low temperature
+			{
+			off2 += 17 * (int64_t)(temp + 1500) * (temp + 1500);
+			sens2 += 9 * (int64_t)(temp + 1500) * (temp + 1500);
+			}
+		}
+	else
+		t2 = (5 * (int64_t)dt * dt) >> 38;
+	data.centi_c = (int16_t)(temp - t2);
+
+	if (!d1)
+		{
+		data.pa = 0;
+		return;
+		}
+	off = ((int64_t)prom[2] << 17) + (((int64_t)prom[4] * dt) >> 6) - off2;
+	sens = ((int64_t)prom[1] << 16) + (((int64_t)prom[3] * dt) >> 7) - sens2;
+	data.pa = (int32_t)(((((int64_t)d1 * sens) >> 21) - off) >> 15);
+	}
+
+
+//---------------------------< C E N T I _ R H _ G E T >------------------------------------------------------
+//
+// %RH = -6 + (125 * raw / 2^16), then compensated by -0.18 %RH per °C from 20°C with data.centi_c; clamped to
+// 0 .. 100
+//
+
+int16_t SALT_ext_ms8607::centi_rh_get (uint16_t raw_rh)
+	{
+	int32_t	centi = -600 + (int32_t)((((uint32_t)raw_rh * 12500) + 32768) >> 16);
+
+	centi -= ((2000 - (int32_t)data.centi_c) * 18) / 100;
+	return (int16_t)((0 > centi) ? 0 : (10000 < centi) ? 10000 : centi);
+	}
+
+
+//---------------------------< P T _ U S >--------------------------------------------------------------------
+
+uint32_t SALT_ext_ms8607::pt_us (void)
+	{
+	return ms8607_osrs[osr].pt_us;
+	}
+
+
+//---------------------------< C O N V _ U S >----------------------------------------------------------------
+//
+// a trigger starts a humidity conversion and one pressure or temperature conversion; both are done after this
+//
+
+uint32_t SALT_ext_ms8607::conv_us (void)
+	{
+	return (ms8607_osrs[osr].pt_us > ms8607_osrs[osr].h_us) ? ms8607_osrs[osr].pt_us : ms8607_osrs[osr].h_us;
+	}
+
+
+//---------------------------< S E N S O R _ D I S C O V E R >------------------------------------------------
+//
+// Scan through the mux[].port[].sensor[] struct and interrogate the external i2c net for sensor node eeproms.
+// eeproms on sensor nodes have i2c slave addresses in the range 0x50-0x57.  The low nibble of the eeprom
+// slave address usually matches the low nibble of the sensor device on that node.  This code does not contemplate
+// the possibility that a sensor may have an address range that is limited with respect to the eeprom - the sensor
+// device may only support 1, 2, 4 addresses compared to the eeprom's 8 addresses.  This is presumably handled
+// in hardware by limiting the address jumper availability and hardwiring the appropriate eeprom address pins
+// to ground.
+//
+// RULES:
+//	1. all muxes, ports, sensors must begin at zero
+//	2. no empties: if there are two muxes in a system they shall be mux[0] and mux[1]; not mux[0] and mux[m>1]
+//	3. when adding sensors to a mux, begin at port[0]; no empties
+//	4. when adding sensors to a port, begin with sensor[0]; no empties
+//
+// TODO: what about the mux-mounted sensors on port[7]?  Because these are 'different', handle them elsewhere?
+// TODO: How to map physical sensor location to the electrical sensor location?  There is no map; we define the
+// physical and electrical locations.  See table on sheet 2 of the mux schematics.
+//
+// eeprom mapping?
+// eeprom is 4kx8 and has 128 32-byte pages.  page 0 identifies the assembly?
+//
+// page 0:	information about the assembly
+//		0x0000 - 0x000F:	assembly name; 16 characters null filled; known assemblies are:
+//			"TMP275"
+//			"MUX"
+//		0x0010 - 0x0011:	assembly revision; two byte little endian; MM.mm in the form 0xMMmm
+//		0x0010: mm
+//		0x0011: MM
+//		0x0012 - 0x0015:	assembly manufacture date; four byte time_t little endian
+//		0x0016 - 0x0019:	assembly service date; four byte time_t little endian
+//		0x001A - 0x001F:	undefined; 6 bytes
+//
+// page 1:	information about a sensor
+//		0x0020 - 0x002F:	sensor name; 16 characters null filled; known sensors are:
+//			"TMP275"		- temperature
+//			"HDC1080"		- temperature and relative humidity
+//			"MS8607PT"		- the pressure and temperature sensors (i2c address 0x76)
+//			"MS8607H"		- the relative humidity sensor (i2c address 0x40)
+//		0x0030:				sensor i2c address; one byte:
+//								bits 6..0: the i2c address
+//								bit 7:
+//									when 0, the value in bits 6..0 is a base address modified by the assembly's address jumpers
+//									when set, the value in bits 6..0 is an absolute address
+//		0x0031 - 0x003F:	undefined; 15 bytes
+//
+// page 2:	information about a sensor (same format a page 1; repeat as often as necessary within reason)
+//
+//
+//	[assembly]
+//	# in case we perhaps do the right thing some day and place an eeprom on the same bus as the mux common
+//	type = MUX7
+//	revision = 2.0
+//	manuf date = 2017-08-19
+//	[sensor 1]
+//	type1 = TMP275
+//	# address is two hexadecimal digits
+//	address1 = 48
+//	absolute1 = no
+//	[sensor 2]
+//	type2 = HDC1080
+//	# address is two hexadecimal digits
+//	address2 = 40
+//	absolute2 = yes
+//
+
+
+uint8_t SALT_ext_sensors::sensor_discover (void)
+	{
+	uint32_t	start = millis();
+
+	XLOG (XLOG_INFO, XLOG_DISCOVER_START, XLOG_NA, XLOG_NA, XLOG_NA, 0);
+
+	topology_fixed = 0;												// runtime path
+	if ((SUCCESS == topology_load ()) && (SUCCESS == topology_restore ()))	// warm boot: same sensors as last time
+		XLOG (XLOG_INFO, XLOG_TOPOLOGY_RESTORED, XLOG_NA, XLOG_NA, XLOG_NA, topology.muxes);
+	else
+		{
+		topology_clear ();											// forget anything a failed restore set up
+		discover_full ();
+		topology_save ();
+		}
+
+	thresh_bind (true);
+	XLOG (XLOG_INFO, XLOG_DISCOVER_DONE, XLOG_NA, XLOG_NA, XLOG_NA, millis() - start);
+	return SUCCESS;
+	}
+
+
+//---------------------------< M U X _ S E T U P >------------------------------------------------------------
+//
+// initialize the mux[m] instance; the mux is at 9548A base address + mux array index
+//
+
+void SALT_ext_sensors::mux_setup (uint8_t m)
+	{
+	SALT_ext_bus&	mux_bus_ref = mux_bus (m);
+
+	mux[m].imux.setup (PCA9548A_BASE_MIN | m, mux_bus_ref.wire, mux_bus_ref.name);	// initialize this instance
+	mux[m].imux.begin (mux_bus_ref.pins, mux_bus_ref.rate);
+	mux[m].imux.init ();
+	mux[m].control_known = false;								// don't know what init() left in the control register
+	mux[m].hdc1080_pending = false;								// until a mux-mounted sensor init() triggers one
+	mux[m].sensor_first = sensor_count;							// this mux's port sensors are added next
+	mux[m].sensor_count = 0;
+	mux[m].tmp275_history.clear ();
+	mux[m].hdc1080_t_history.clear ();
+	mux[m].hdc1080_rh_history.clear ();
+	mux[m].conv_us = HDC1080_CONV_TIME_US;
+	rate_reset (m);												// discovery runs at the base rate
+
+	mux[m].exists = true;										// so we can use mux-mounted sensors even when nothing attached to mux[m] ports
+	}
+
+
+//---------------------------< M U X _ B U S _ S E T >--------------------------------------------------------
+//
+// Put mux[m] and everything behind it on bus_ref instead of Wire1.  Call before sensor_discover(); bus_ref must
+// outlive this instance.
+//
+
+void SALT_ext_sensors::mux_bus_set (uint8_t m, SALT_ext_bus& bus_ref)
+	{
+	if (MAX_MUXES > m)
+		mux_bus_ptr[m] = &bus_ref;
+	}
+
+
+//---------------------------< B U S _ F I R S T >------------------------------------------------------------
+//
+// true when no lower-numbered mux is on mux[m]'s bus; loops over the muxes use it to visit each bus once
+//
+
+boolean SALT_ext_sensors::bus_first (uint8_t m)
+	{
+	for (uint8_t i = 0; i < m; i++)
+		{
+		if (&mux_bus (i) == &mux_bus (m))
+			return false;
+		}
+	return true;
+	}
+
+
+//---------------------------< B U S _ M U L T I >------------------------------------------------------------
+//
+// true when the muxes that exist are not all on the same bus
+//
+
+boolean SALT_ext_sensors::bus_multi (void)
+	{
+	for (uint8_t m = 1; (m < MAX_MUXES) && mux[m].exists; m++)
+		{
+		if (&mux_bus (m) != &mux_bus (0))
+			return true;
+		}
+	return false;
+	}
+
+
+//---------------------------< M U X _ P R O B E >------------------------------------------------------------
+//
+// Pings each mux[m] at 9548A base address + m on its bus.  Returns a presence bitmap: bit m is set when mux[m]
+// acked.  Same probes as bus.probe_mask (PCA9548A_BASE_MIN, (1 << MAX_MUXES) - 1) when all muxes share a bus.
+//
+
+uint8_t SALT_ext_sensors::mux_probe (void)
+	{
+	uint8_t	mask = 0;
+
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		{
+		if (SUCCESS == mux_bus (m).ping (PCA9548A_BASE_MIN | m))
+			mask |= (1 << m);
+		}
+	return mask;
+	}
+
+
+//---------------------------< P O R T _ S E N S O R _ S E T U P >--------------------------------------------
+//
+// Add mux[m].port[p].sensor[s] to the registry as a port_drivers[driver] sensor at addr, initialize it and, when
+// eep is true, its eeprom, and note the driver and address in topology.  The entry goes at its scan order (mux,
+// port, sensor) position: the end, during discovery, which adds sensors in that order; hot-plug opens a place
+// for it (registry_insert()).  mux[m]'s sensors are added after mux_setup (m).  mux[m].port[p] must be enabled.
+//
+
+void SALT_ext_sensors::port_sensor_setup (uint8_t m, uint8_t p, uint8_t s, boolean eep, uint8_t driver, uint8_t addr)
+	{
+	SALT_ext_bus&	mux_bus_ref = mux_bus (m);
+	sensor_t*		sensor_ptr;
+	uint8_t			i;
+
+	if (MAX_REG_SENSORS <= sensor_count)
+		{
+		XLOG (XLOG_INFO, XLOG_REGISTRY_FULL, m, p, s, 0);
+		return;
+		}
+
+	for (i = sensor_count; i && (((sensor[i - 1].m << 8) | (sensor[i - 1].p << 4) | sensor[i - 1].s) > ((m << 8) | (p << 4) | s)); i--)
+		;															// scan order position
+	if (sensor_count > i)
+		registry_insert (i, m);
+	sensor_ptr = &sensor[i];
+
+	if (eep)
+		{
+		sensor_ptr->ieep.setup (EEP_BASE_MIN | s, mux_bus_ref.wire, mux_bus_ref.name);
+		sensor_ptr->ieep.begin (mux_bus_ref.pins, mux_bus_ref.rate);
+		sensor_ptr->ieep.init ();
+		}
+
+	sensor_ptr->driver = driver;
+	sensor_ptr->addr = addr;
+	(this->*port_drivers[driver].init) (sensor_ptr, mux_bus_ref);	// set up only the driver that the eeprom names
+
+	sensor_ptr->history.clear ();
+	sensor_ptr->m = m;
+	sensor_ptr->p = p;
+	sensor_ptr->s = s;
+	topology.sensor[i].driver = driver;
+	topology.sensor[i].addr = addr;
+	sensor_count++;
+	mux[m].sensor_count++;
+	XLOG (XLOG_DETAIL, XLOG_TMP275_DETECTED, m, p, s, 0);
+	}
+
+
+//---------------------------< R E G I S T R Y _ F I N D >----------------------------------------------------
+//
+// returns the registry index of mux[m].port[p].sensor[s], or MEAS_NONE when the registry has no such sensor
+//
+
+uint8_t SALT_ext_sensors::registry_find (uint8_t m, uint8_t p, uint8_t s)
+	{
+	for (uint8_t i = mux[m].sensor_first; i < (mux[m].sensor_first + mux[m].sensor_count); i++)
+		{
+		if ((p == sensor[i].p) && (s == sensor[i].s))
+			return i;
+		}
+	return MEAS_NONE;
+	}
+
+
+//---------------------------< R E G I S T R Y _ I N S E R T >------------------------------------------------
+//
+// Open registry entry i for a new mux[m] sensor.  Entries i .. sensor_count - 1 move up one, with everything kept
+// by their meas channel: raw values, meas, polling and health state, transfer counters and the topology record
+// entries.  Entry i's channel state starts empty.  The caller sets up the entry and counts it; the registry must
+// not be full.
+//
+
+void SALT_ext_sensors::registry_insert (uint8_t i, uint8_t m)
+	{
+	uint8_t	n = sensor_count - i;									// entries that move
+
+	for (uint8_t j = sensor_count; j > i; j--)						// driver instances by assignment
+		sensor[j] = sensor[j - 1];
+	memmove (&topology.sensor[i + 1], &topology.sensor[i], n * sizeof(topology.sensor[0]));
+	memmove (&raw[i + 1], &raw[i], n * sizeof(raw[0]));
+	memmove (&meas.centi_c[i + 1], &meas.centi_c[i], n * sizeof(meas.centi_c[0]));
+	memmove (&meas.centi_f[i + 1], &meas.centi_f[i], n * sizeof(meas.centi_f[0]));
+	memmove (&poll[i + 1], &poll[i], n * sizeof(poll_t));
+	memmove (&health[i + 1], &health[i], n * sizeof(health_t));
+	memmove (&istats[i + 1], &istats[i], n * sizeof(SALT_ext_istats));
+
+	meas.valid = channels_open (meas.valid, i);
+	raw_fresh = channels_open (raw_fresh, i);
+	raw_failed = channels_open (raw_failed, i);
+	health_out = channels_open (health_out, i);
+	poll_due = channels_open (poll_due, i);
+
+	memset (&poll[i], 0, sizeof(poll_t));							// due every pass until it has a reference reading
+	memset (&health[i], 0, sizeof(health_t));
+	istats[i].clear ();
+
+	for (uint8_t j = m + 1; j < MAX_MUXES; j++)						// later muxes' sensors moved up
+		{
+		if (mux[j].exists)
+			mux[j].sensor_first++;
+		}
+	}
+
+
+//---------------------------< R E G I S T R Y _ D E L E T E >------------------------------------------------
+//
+// Remove registry entry i.  Entries i + 1 .. sensor_count - 1 move down one with everything kept by their meas
+// channel (see registry_insert()), and the registry and mux sensor counts drop by one.
+//
+
+void SALT_ext_sensors::registry_delete (uint8_t i)
+	{
+	uint8_t	m = sensor[i].m;
+	uint8_t	n = sensor_count - i - 1;								// entries that move
+
+	for (uint8_t j = i; j < (sensor_count - 1); j++)				// driver instances by assignment
+		sensor[j] = sensor[j + 1];
+	memmove (&topology.sensor[i], &topology.sensor[i + 1], n * sizeof(topology.sensor[0]));
+	memmove (&raw[i], &raw[i + 1], n * sizeof(raw[0]));
+	memmove (&meas.centi_c[i], &meas.centi_c[i + 1], n * sizeof(meas.centi_c[0]));
+	memmove (&meas.centi_f[i], &meas.centi_f[i + 1], n * sizeof(meas.centi_f[0]));
+	memmove (&poll[i], &poll[i + 1], n * sizeof(poll_t));
+	memmove (&health[i], &health[i + 1], n * sizeof(health_t));
+	memmove (&istats[i], &istats[i + 1], n * sizeof(SALT_ext_istats));
+
+	meas.valid = channels_close (meas.valid, i);
+	raw_fresh = channels_close (raw_fresh, i);
+	raw_failed = channels_close (raw_failed, i);
+	health_out = channels_close (health_out, i);
+	poll_due = channels_close (poll_due, i);
+
+	sensor_count--;
+	memset (&topology.sensor[sensor_count], 0, sizeof(topology.sensor[0]));
+	istats[sensor_count].clear ();
+	mux[m].sensor_count--;
+	for (uint8_t j = m + 1; j < MAX_MUXES; j++)						// later muxes' sensors moved down
+		{
+		if (mux[j].exists)
+			mux[j].sensor_first--;
+		}
+	}
+
+
+//---------------------------< P O R T _ D R I V E R _ R E A D >----------------------------------------------
+//
+// Read the type and address from the [sensor 1] page of the mux[m].port[p].sensor[s] node eeprom (one pointer
+// write and one 17-byte read) and find the type in port_drivers[].  An address with its msb set is absolute;
+// otherwise it is the type's base address (0: port_drivers[].base) and the sensor is at base + s, tracking the
+// node's address jumpers.  Nodes whose page can't be read or whose type is unknown are TMP275s at
+// TMP275_BASE_MIN + s, as every node was before the eeprom was read.  mux[m].port[p] must be enabled.
+//
+
+uint8_t SALT_ext_sensors::port_driver_read (uint8_t m, uint8_t p, uint8_t s, uint8_t* addr)
+	{
+	uint8_t		page[SENSOR_ADDR + 1];							// type and address
+	uint8_t		driver;
+
+	*addr = TMP275_BASE_MIN + s;								// default
+
+	if ((SUCCESS != eep_seek (m, EEP_BASE_MIN | s, SENSOR1_BASE)) ||
+			(SUCCESS != eep_read (m, EEP_BASE_MIN | s, page, sizeof(page))))
+		{
+		XLOG (XLOG_INFO, XLOG_EEP_NOT_DETECTED, m, p, s, 0);
+		return PORT_DRIVER_TMP275;
+		}
+	XLOG (XLOG_DETAIL, XLOG_EEP_DETECTED, m, p, s, 0);
+
+	if (!eep_type_char (page[SENSOR_TYPE]))						// 'erased'
+		{
+		XLOG (XLOG_INFO, XLOG_EEP_UNINIT, m, p, s, 0);
+		return PORT_DRIVER_TMP275;
+		}
+
+	page[SENSOR_ADDR - 1] = '\0';								// types are at most 15 characters
+	for (driver = 0; (PORT_DRIVERS > driver) && strcmp ((char*)&page[SENSOR_TYPE], port_drivers[driver].type); driver++)
+		;
+	if (PORT_DRIVERS == driver)
+		{
+		XLOG (XLOG_INFO, XLOG_EEP_TYPE_UNKNOWN, m, p, s, 1);
+		return PORT_DRIVER_TMP275;								// its tmp275 address acked
+		}
+
+	if (0x80 & page[SENSOR_ADDR])								// absolute
+		*addr = page[SENSOR_ADDR] & 0x7F;
+	else
+		*addr = (page[SENSOR_ADDR] ? page[SENSOR_ADDR] : port_drivers[driver].base) + s;
+	return driver;
+	}
+
+
+//---------------------------< P O R T _ T M P 2 7 5 _ I N I T >----------------------------------------------
+//
+// port_drivers[PORT_DRIVER_TMP275].init: set up sensor_ptr->itmp275 at sensor_ptr->addr on bus for 12-bit reads
+//
+
+void SALT_ext_sensors::port_tmp275_init (sensor_t* sensor_ptr, SALT_ext_bus& bus)
+	{
+	sensor_ptr->itmp275.setup (sensor_ptr->addr, bus.wire, bus.name);	// initialize this sensor instance
+	sensor_ptr->itmp275.begin (bus.pins, bus.rate);
+	sensor_ptr->itmp275.init (TMP275_CFG_RES12);
+	// set temp sensor pointer register to point at temperature register here or elsewhere?
+	}
+
+
+//---------------------------< P O R T _ T M P 2 7 5 _ F L O A T >--------------------------------------------
+//
+// port_drivers[PORT_DRIVER_TMP275].data_float: fill sensor_ptr->itmp275.data from the temperature register
+//
+
+void SALT_ext_sensors::port_tmp275_float (sensor_t* sensor_ptr, uint16_t raw)
+	{
+	sensor_ptr->itmp275.data.raw_temp = raw;
+	sensor_ptr->itmp275.data.deg_c = (int16_t)raw / 256.0;
+	sensor_ptr->itmp275.data.deg_f = (sensor_ptr->itmp275.data.deg_c * 1.8) + 32.0;
+	}
+
+
+//---------------------------< M U X _ S E N S O R S _ S E T U P >--------------------------------------------
+//
+// Initialize the mux-mounted sensors that mux[m].installed_sensors specifies and that mms_mask (the port[7]
+// presence bitmap from probe_list()) says are present.  Sensors that fail init are removed from
+// mux[m].installed_sensors.  mux[m].port[7] must be enabled.
+//
+
+void SALT_ext_sensors::mux_sensors_setup (uint8_t m, uint8_t mms_mask)
+	{
+	SALT_ext_bus&	mux_bus_ref = mux_bus (m);
+
+	if (TMP275 & mux[m].installed_sensors)										// should we expect a 275?
+		{
+		if (!(mms_mask & MMS_TMP275))											// did it ack?
+			XLOG (XLOG_INFO, XLOG_MMS_NOT_DETECTED, m, XLOG_NA, XLOG_NA, TMP275);
+		else
+			{
+			mux[m].itmp275.setup (TMP275_SLAVE_ADDR_7, mux_bus_ref.wire, mux_bus_ref.name);	// initialize this sensor instance
+			mux[m].itmp275.begin (mux_bus_ref.pins, mux_bus_ref.rate);
+			if (SUCCESS != mux[m].itmp275.init (TMP275_CFG_RES12))
+				{
+				mux[m].itmp275.~Systronix_TMP275();								// destructor this instance
+				XLOG (XLOG_INFO, XLOG_MMS_INIT_FAIL, m, XLOG_NA, XLOG_NA, TMP275);
+				mux[m].installed_sensors &= ~TMP275;							// remove TMP275 from installed sensors
+				}
+			else
+				{
+				XLOG (XLOG_DETAIL, XLOG_MMS_INITIALIZED, m, XLOG_NA, XLOG_NA, TMP275);
+				}
+			}
+		}
+
+	if (HDC1080 & mux[m].installed_sensors)											// should we expect a 1080?
+		{
+		if ((MMS_HDC1080 | MMS_MS8607_PT) == (mms_mask & (MMS_HDC1080 | MMS_MS8607_PT)))	// make sure we aren't accidentally talking to MS8607
+			XLOG (XLOG_INFO, XLOG_MMS_MS8607_NOT_HDC1080, m, XLOG_NA, XLOG_NA, 0);
+		else if (!(mms_mask & MMS_HDC1080))
+			XLOG (XLOG_INFO, XLOG_MMS_NOT_DETECTED, m, XLOG_NA, XLOG_NA, HDC1080);
+		else
+			{
+			mux[m].ihdc1080.setup (mux_bus_ref.wire, mux_bus_ref.name);				// initialize this sensor instance
+			mux[m].ihdc1080.begin (mux_bus_ref.pins, mux_bus_ref.rate);
+			if (SUCCESS != mux[m].ihdc1080.init (MODE_T_AND_H))						// temperature and humidity mode
+//		if (SUCCESS != mux[m].ihdc1080.init (0, TRIGGER_H))						// individual mode; humidity only
+				{
+				mux[m].ihdc1080.~Systronix_HDC1080();								// destructor this instance
+				XLOG (XLOG_INFO, XLOG_MMS_INIT_FAIL, m, XLOG_NA, XLOG_NA, HDC1080);
+				mux[m].installed_sensors &= ~HDC1080;								// remove HDC1080 from installed sensors
+				}
+			else
+				{
+				mux[m].hdc1080_trigger_us = micros();								// init() triggers the first conversion
+				mux[m].hdc1080_pending = true;
+				mux[m].conv_us = HDC1080_CONV_TIME_US;
+				XLOG (XLOG_DETAIL, XLOG_MMS_INITIALIZED, m, XLOG_NA, XLOG_NA, HDC1080);
+				}
+			}
+		}
+
+	if (MS8607 & mux[m].installed_sensors)											// should we expect an MS8607?
+		{
+		if ((MMS_MS8607_H | MMS_MS8607_PT) != (mms_mask & (MMS_MS8607_H | MMS_MS8607_PT)))	// both parts must ack
+			XLOG (XLOG_INFO, XLOG_MMS_NOT_DETECTED, m, XLOG_NA, XLOG_NA, MS8607);
+		else if (SUCCESS != ms8607_init (m))										// reset, PROM, resolution; starts the first conversions
+			{
+			XLOG (XLOG_INFO, XLOG_MMS_INIT_FAIL, m, XLOG_NA, XLOG_NA, MS8607);
+			mux[m].installed_sensors &= ~MS8607;									// remove MS8607 from installed sensors
+			}
+		else
+			{
+			XLOG (XLOG_DETAIL, XLOG_MMS_INITIALIZED, m, XLOG_NA, XLOG_NA, MS8607);
+			}
+		}
+	}
+
+
+//---------------------------< D I S C O V E R _ F U L L >----------------------------------------------------
+//
+// Probe every mux, port, sensor and eeprom address as described above, initialize what is found, and record it
+// in topology.
+//
+
+void SALT_ext_sensors::discover_full (void)
+	{
+	uint8_t	m;				// indexer into mux
+	uint8_t	p;				// indexer into port
+	uint8_t	s;				// indexer into sensor
+
+	uint8_t	mux_mask;		// presence bitmaps; bit n set when base address + n acked
+	uint8_t	eep_mask;
+	uint8_t	tmp275_mask;
+	uint8_t	mms_mask;		// mux-mounted presence bitmap; bit n set when mms_addrs[n] acked
+	uint8_t	type;			// byte 0 of the mux eeprom
+	uint8_t	driver;			// port sensor port_drivers[] index and address
+	uint8_t	addr;
+
+																	// perhaps this is a flaw in the design?  The local eeprom is 'hidden'
+																	// on port 7.  Shouldn't it be on the same 'bus' as the mux?
+	mux_mask = mux_probe ();										// 9548A slave addresses are lowest base addr + mux array index
+
+	for (m = 0; m < MAX_MUXES; m++)
+		{
+		if (!(mux_mask & (1 << m)))
+			{
+			XLOG (XLOG_DETAIL, XLOG_NOT_DETECTED, m, XLOG_NA, XLOG_NA, 0);
+			break;
+			}
+
+		mux_setup (m);
+		topology.muxes = m + 1;
+		XLOG (XLOG_DETAIL, XLOG_DETECTED, m, XLOG_NA, XLOG_NA, 0);
+		for (p = 0; p < MAX_PORTS; p++)								// here only when we were able to initialize a mux
+			{
+			if (SUCCESS != mux_control_write (m, mux[m].imux.port[p]))			// enable access to mux[m].port[p]
+				XLOG (XLOG_INFO, XLOG_SELECT_FAIL, m, p, XLOG_NA, mux[m].imux.port[p]);
+
+			// a sensor[s] exists when its tmp275 address acks; its eeprom, when there is one, says what it is.
+			// Sensors begin at sensor[0] with no empties so only the eeproms of contiguous tmp275s are probed.
+
+			tmp275_mask = mux_bus (m).probe_mask (TMP275_BASE_MIN, (1 << MAX_SENSORS) - 1);	// sensor slave addresses are lowest base addr + sensor array index
+			tmp275_mask &= ~(tmp275_mask + 1);						// keep only the contiguous run of ones from bit 0 (zero when bit 0 is clear)
+			eep_mask = tmp275_mask ? mux_bus (m).probe_mask (EEP_BASE_MIN, tmp275_mask) : 0;	// eeprom slave addresses are lowest base addr + sensor array index
+
+			for (s = 0; s < MAX_SENSORS; s++)
+				{
+				if (!(tmp275_mask & (1 << s)))
+					{
+					XLOG (XLOG_DETAIL, XLOG_TMP275_NOT_DETECTED, m, p, s, 0);
+					break;											// no empties; done with this port
+					}
+
+				addr = TMP275_BASE_MIN + s;							// nodes without an eeprom are TMP275s
+				driver = PORT_DRIVER_TMP275;
+				if (eep_mask & (1 << s))
+					driver = port_driver_read (m, p, s, &addr);
+				else
+					XLOG (XLOG_DETAIL, XLOG_EEP_NOT_DETECTED, m, p, s, 0);
+				port_sensor_setup (m, p, s, eep_mask & (1 << s), driver, addr);
+				}
+			topology.mux[m].port[p] = tmp275_mask | (eep_mask << 4);
+			if (!tmp275_mask)										// no sensors on this port; done with this mux
+				break;
+			}
+		mux_control_write (m, PCA9548A_PORTS_DISABLE);				// disable access to mux[m] ports
+		}
+
+	XLOG (XLOG_DETAIL, XLOG_DISCOVER_MMS, XLOG_NA, XLOG_NA, XLOG_NA, 0);
+
+	for (m = 0; m < MAX_MUXES; m++)												// here we discover mux-mounted sensors
+		{
+		if (mux[m].exists)														// on muxes that exist
+			{
+			if (SUCCESS != mux_control_write (m, mux[m].imux.port[7]))			// enable access to mux[m].port[7]
+				{
+				XLOG (XLOG_INFO, XLOG_SELECT_FAIL, m, 7, XLOG_NA, mux[m].imux.port[7]);
+				break;															// serious problem if we can't switch the multiplexer  TODO: what to do?
+				}
+
+			mms_mask = mux_bus (m).probe_list (mms_addrs, MMS_ADDRS);			// everything that might be on port[7]
+			topology.mux[m].mms_mask = mms_mask;
+
+			if (!(mms_mask & MMS_EEP))
+				{
+				XLOG (XLOG_INFO, XLOG_EEP_NOT_DETECTED, m, XLOG_NA, XLOG_NA, 0);
+				continue;														// no eeprom so no sensors here; try next mux
+				}
+			else
+				{
+				mux[m].ieep.setup (MUX_EEP_ADDR, mux_bus (m).wire, mux_bus (m).name);	// initialize eeprom instance
+				mux[m].ieep.begin (mux_bus (m).pins, mux_bus (m).rate);
+				mux[m].ieep.init ();
+				XLOG (XLOG_DETAIL, XLOG_EEP_DETECTED, m, XLOG_NA, XLOG_NA, 0);
+				}
+
+// PROBLEM: Because NAP have put muxes in the field without properly loaded eeproms and because there are also
+// previous versions out there that write 0x05 to address 0 in the eeprom (that was done to get this code working),
+// we somehow have to support those.  There have never been muxes with MS8607 so we only need to worry about
+// systems that have 0xFF or 0x05 in eeprom address 0; those get whichever of TMP275 and HDC1080 answered the probe
+			if ((SUCCESS != eep_desc_read (m, &type)) && (SUCCESS != eep_desc_read (m, &type)))	// one retry; type is byte 0 of page 0 ('M' is 0x4D)
+				{
+				mux_fault_log (E7N_MUX_FAULT_IDX, m);
+				XLOG (XLOG_INFO, XLOG_EEP_READ_FAIL, m, XLOG_NA, XLOG_NA, 0);
+				mux[m].installed_sensors = 0;								// unknown; not the probe guess an erased eeprom gets
+				topology_partial = true;									// don't let the next boot restore this
+				}
+			else if ((0x05 == type) || (0xFF == type))						// address 0 is 'erased' or 0x05
+				{
+				e7n.exception_add (E7N_UNINIT_MUX_IDX);
+				topology.mux[m].uninit_eep = true;								// so that restore raises the exception too
+				XLOG (XLOG_INFO, XLOG_EEP_UNINIT, m, XLOG_NA, XLOG_NA, 0);
+				mux[m].installed_sensors = ((mms_mask & MMS_TMP275) ? TMP275 : 0) |
+					((MMS_HDC1080 == (mms_mask & (MMS_HDC1080 | MMS_MS8607_PT))) ? HDC1080 : 0);
+				}
+			else
+				{
+				mux[m].installed_sensors = 0;								// init to be safe
+
+				for (s = 0; s < mux[m].desc.sensors; s++)					// [sensor 1] .. pages
+					{
+					const char*	sensor_type = mux[m].desc.sensor[s].type;
+
+					if (!strcmp (sensor_type, "TMP275"))
+						mux[m].installed_sensors |= TMP275;
+					else if (!strcmp (sensor_type, "HDC1080"))
+						mux[m].installed_sensors |= HDC1080;
+					else if (!strcmp (sensor_type, "MS8607PT") || !strcmp (sensor_type, "MS8607H"))
+						mux[m].installed_sensors |= MS8607;					// two pages, one sensor
+					else
+						XLOG (XLOG_INFO, XLOG_EEP_TYPE_UNKNOWN, m, XLOG_NA, XLOG_NA, s + 1);
+					}
+				if (!mux[m].desc.sensors)
+					XLOG (XLOG_INFO, XLOG_EEP_TYPE_NONE, m, XLOG_NA, XLOG_NA, 1);
+				}
+
+			// TODO: if tests on some value(s) stored in eeprom to determine which of the three sensors to use?
+			// If we do that just what is it that gets stored in eeprom?
+			// that same value will be used by the scanner to fetch sensor data
+
+
+//			Serial.printf ("installed_sensors: 0x%.2X\n", mux[m].installed_sensors);
+
+			topology.mux[m].installed_sensors = mux[m].installed_sensors;	// as specified by the eeprom; restore replays the setup below
+			mux_sensors_setup (m, mms_mask);										// initialize the sensors that are specified and present
+			}
+		else
+			break;
+
+		mux_control_write (m, PCA9548A_PORTS_DISABLE);										// disable access to mux[m] ports so that multiple muxes aren't accessed in parallel
+		}
+	}
+
+
+//---------------------------< E E P _ D E S C _ R E A D >----------------------------------------------------
+//
+// Read the mux[m] eeprom descriptor in one sequential read from address 0 and parse it into mux[m].desc: the
+// [assembly] page, then [sensor n] pages until the first page whose byte 0 is not a type character (A-Z, 0-9).
+// The first EEP_DESC_BULK pages are fetched together; after that the eeprom's address counter is at the next page
+// so each later page costs a one-byte current address read of its type character and, when that is one, a read of
+// the rest of the page.  mux[m].port[7] must be enabled.  Puts byte 0 of the eeprom at byte0_ptr.  Returns FAIL
+// when the seek or the first read fails; a failed read is not an erased eeprom.
+//
+
+uint8_t SALT_ext_sensors::eep_desc_read (uint8_t m, uint8_t* byte0_ptr)
+	{
+	eep_desc_t*	desc_ptr = &mux[m].desc;
+	uint8_t		buf[EEP_DESC_PAGES * PAGE_SIZE];
+	uint8_t*	page_ptr;
+
+	memset (desc_ptr, 0, sizeof(eep_desc_t));
+
+	if ((SUCCESS != eep_seek (m, MUX_EEP_ADDR, ASSY_PAGE_ADDR)) ||	// point to page 0, address 0
+			(SUCCESS != eep_read (m, MUX_EEP_ADDR, buf, EEP_DESC_BULK * PAGE_SIZE)))
+		return FAIL;
+	*byte0_ptr = buf[0];
+
+	for (uint8_t page = 0; page < EEP_DESC_PAGES; page++)
+		{
+		page_ptr = &buf[page * PAGE_SIZE];
+		if (EEP_DESC_BULK <= page)								// not in the bulk read; the address counter is at its byte 0
+			{
+			if ((SUCCESS != eep_read (m, MUX_EEP_ADDR, page_ptr, 1)) || !eep_type_char (*page_ptr) ||
+					(SUCCESS != eep_read (m, MUX_EEP_ADDR, page_ptr + 1, PAGE_SIZE - 1)))
+				break;
+			}
+		else if (!eep_type_char (*page_ptr))					// no more pages
+			break;
+
+		if (0 == page)											// [assembly]
+			{
+			memcpy (desc_ptr->assembly_type, &page_ptr[ASSEMBLY_TYPE], sizeof(desc_ptr->assembly_type) - 1);
+			desc_ptr->revision = page_ptr[ASSEMBLY_REV] | (page_ptr[ASSEMBLY_REV + 1] << 8);
+			desc_ptr->manufacture_date = le32_get (&page_ptr[ASSEMBLY_MANUF_DATE]);
+			desc_ptr->service_date = le32_get (&page_ptr[ASSEMBLY_SERV_DATE]);
+			desc_ptr->ports = page_ptr[ASSEMBLY_PORTS];
+			}
+		else													// [sensor n]
+			{
+			memcpy (desc_ptr->sensor[desc_ptr->sensors].type, &page_ptr[SENSOR_TYPE], sizeof(desc_ptr->sensor[0].type) - 1);
+			desc_ptr->sensor[desc_ptr->sensors].addr = page_ptr[SENSOR_ADDR];
+			desc_ptr->sensors++;
+			}
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< E E P _ S E E K >--------------------------------------------------------------
+//
+// Write mem_addr to the address counter of the eeprom at addr (the mux eeprom or a sensor node eeprom) behind
+// mux[m] and hold the bus for the eep_read() that follows; the transfer is counted in eep_istats[m].  Returns
+// SUCCESS when the eeprom acked.
+//
+
+uint8_t SALT_ext_sensors::eep_seek (uint8_t m, uint8_t addr, uint16_t mem_addr)
+	{
+	i2c_t3&		wire = mux_bus (m).wire;
+	uint32_t	start_us = micros();
+	uint8_t		ret_val;
+
+	wire.beginTransmission (addr);
+	wire.write ((uint8_t)(mem_addr >> 8));
+	wire.write ((uint8_t)mem_addr);
+	ret_val = wire.endTransmission (I2C_NOSTOP);				// repeated start for the read
+	istats_record (&eep_istats[m], m, micros() - start_us, 2, wire.status ());
+	return ret_val;
+	}
+
+
+//---------------------------< E E P _ R E A D >--------------------------------------------------------------
+//
+// current address read of len bytes from the eeprom at addr behind mux[m] into buf; the transfer is counted in
+// eep_istats[m].  Returns SUCCESS when the eeprom acked and sent len bytes.
+//
+
+uint8_t SALT_ext_sensors::eep_read (uint8_t m, uint8_t addr, uint8_t* buf, uint8_t len)
+	{
+	i2c_t3&		wire = mux_bus (m).wire;
+	uint32_t	start_us = micros();
+	size_t		count = wire.requestFrom (addr, (size_t)len);
+
+	istats_record (&eep_istats[m], m, micros() - start_us, len, wire.status ());
+	if (len != count)
+		return FAIL;
+
+	for (uint8_t i = 0; i < len; i++)
+		buf[i] = wire.read ();
+	return SUCCESS;
+	}
+
+
+//---------------------------< T O P O L O G Y _ R E S T O R E >----------------------------------------------
+//
+// Warm boot discovery.  Verifies topology (loaded from EEPROM) against the hardware with targeted probes and,
+// while each port is enabled, sets up what the record says is there:
+//	the muxes that ack must be exactly mux[0] .. mux[topology.muxes - 1]
+//	on each port with sensors, the tmp275 and eeprom presence bitmaps must match and the first empty sensor slot
+//		must still be empty; the first port without sensors after the last port with them must still be empty
+//		(hot-plug can leave empty ports and sensor slots between populated ones; those are probed too)
+//	the port[7] presence bitmap must match
+// The mux eeprom is not read; its decoded installed_sensors value comes from the record.  Returns FAIL at the
+// first mismatch; the caller then clears whatever was set up and does a full discovery.
+//
+
+uint8_t SALT_ext_sensors::topology_restore (void)
+	{
+	uint8_t	m;				// indexer into mux
+	uint8_t	p;				// indexer into port
+	uint8_t	tmp275_mask;	// expected presence bitmaps
+	uint8_t	eep_mask;
+	uint8_t	ports;			// ports up to and including the last with sensors
+	uint8_t	i;				// topology.sensor[] index of the next registry entry
+
+	if (((1 << topology.muxes) - 1) != mux_probe ())
+		return FAIL;												// a mux was added or removed
+
+	for (m = 0; m < topology.muxes; m++)
+		{
+		mux_setup (m);
+		for (ports = MAX_PORTS; ports && !(topology.mux[m].port[ports - 1] & 0x0F); ports--)
+			;
+
+		for (p = 0; p < MAX_PORTS; p++)
+			{
+			tmp275_mask = topology.mux[m].port[p] & 0x0F;
+			eep_mask = topology.mux[m].port[p] >> 4;
+
+			mux_control_write (m, mux[m].imux.port[p]);			// enable access to mux[m].port[p]
+			if (tmp275_mask != mux_bus (m).probe_mask (TMP275_BASE_MIN, (tmp275_mask | (tmp275_mask + 1)) & ((1 << MAX_SENSORS) - 1)))
+				return FAIL;										// sensor added or removed
+			if (!tmp275_mask && (p >= ports))						// first empty port is still empty; done with this mux
+				break;
+			if (!tmp275_mask)										// an empty port that hot-plug passed over
+				continue;
+			if (eep_mask != mux_bus (m).probe_mask (EEP_BASE_MIN, tmp275_mask))
+				return FAIL;										// sensor node eeprom added or removed
+
+			for (uint8_t s = 0; s < MAX_SENSORS; s++)
+				{
+				if (!(tmp275_mask & (1 << s)))
+					continue;
+				i = (MAX_REG_SENSORS > sensor_count) ? sensor_count : 0;	// past the registry port_sensor_setup() ignores it
+				if (PORT_DRIVERS <= topology.sensor[i].driver)
+					return FAIL;
+				port_sensor_setup (m, p, s, eep_mask & (1 << s), topology.sensor[i].driver, topology.sensor[i].addr);
+				}
+			}
+
+		mux_control_write (m, mux[m].imux.port[7]);				// enable access to mux[m].port[7]
+		if (topology.mux[m].mms_mask != mux_bus (m).probe_list (mms_addrs, MMS_ADDRS))
+			return FAIL;											// mux-mounted parts changed
+
+		if (topology.mux[m].mms_mask & MMS_EEP)
+			{
+			mux[m].ieep.setup (MUX_EEP_ADDR, mux_bus (m).wire, mux_bus (m).name);	// initialize eeprom instance
+			mux[m].ieep.begin (mux_bus (m).pins, mux_bus (m).rate);
+			mux[m].ieep.init ();
+			}
+		if (topology.mux[m].uninit_eep)
+			e7n.exception_add (E7N_UNINIT_MUX_IDX);
+
+		mux[m].installed_sensors = topology.mux[m].installed_sensors;
+		mux_sensors_setup (m, topology.mux[m].mms_mask);
+		mux_control_write (m, PCA9548A_PORTS_DISABLE);				// disable access to mux[m] ports so that multiple muxes aren't accessed in parallel
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< T O P O L O G Y _ C L E A R >--------------------------------------------------
+//
+// forget all muxes and sensors and empty the topology record; the driver instances are re-initialized by the
+// next discovery
+//
+
+void SALT_ext_sensors::topology_clear (void)
+	{
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		{
+		if (mux[m].exists)
+			mux_control_write (m, PCA9548A_PORTS_DISABLE);			// leave nothing enabled
+
+		mux[m].exists = false;
+		mux[m].installed_sensors = 0;
+		mux[m].sensor_first = 0;
+		mux[m].sensor_count = 0;
+		}
+	sensor_count = 0;
+	topology_fixed = 0;
+	raw_fresh = 0;
+	meas.valid = 0;
+	memset (poll, 0, sizeof(poll));								// every channel due until it has a reference reading
+	memset (health, 0, sizeof(health));
+	memset (mux_health, 0, sizeof(mux_health));
+	health_out = 0;
+	health_mux_out = 0;
+	raw_failed = 0;
+	thresh_channels = 0;										// unbound until the discovery ends (thresh_bind())
+	telemetry_since_key = TELEMETRY_KEY_INTERVAL;				// the next record describes the new registry
+	memset (&hotplug_stats, 0, sizeof(hotplug_stats));
+	istats_clear ();
+	snapshot_publish ();										// readers see that there are no readings
+
+	memset (&topology, 0, sizeof(topology));
+	topology_partial = false;
+	}
+
+
+//---------------------------< T O P O L O G Y _ L O A D >----------------------------------------------------
+//
+// read the topology record from EEPROM; returns FAIL if it is not a valid record for this library version
+//
+
+uint8_t SALT_ext_sensors::topology_load (void)
+	{
+	EEPROM.get (TOPOLOGY_EEP_ADDR, topology);
+
+	if ((TOPOLOGY_VERSION != topology.version) || (topology_check () != topology.check) ||
+			(0 == topology.muxes) || (MAX_MUXES < topology.muxes))
+		return FAIL;
+	return SUCCESS;
+	}
+
+
+//---------------------------< T O P O L O G Y _ S A V E >----------------------------------------------------
+//
+// write the topology record to EEPROM.  EEPROM.put() only writes bytes that changed so an unchanged topology
+// costs no EEPROM wear.  When discovery couldn't read a mux eeprom (topology_partial) the record would replay that
+// fault on every boot, so the last one is kept: the next boot restores that or discovers again.
+//
+
+void SALT_ext_sensors::topology_save (void)
+	{
+	if (topology_partial)
+		return;
+
+	topology.version = TOPOLOGY_VERSION;
+	topology.check = topology_check ();
+	EEPROM.put (TOPOLOGY_EEP_ADDR, topology);
+	}
+
+
+//---------------------------< T O P O L O G Y _ F O R G E T >------------------------------------------------
+//
+// invalidate the stored topology record so that the next sensor_discover() does a full discovery
+//
+
+void SALT_ext_sensors::topology_forget (void)
+	{
+	EEPROM.write (TOPOLOGY_EEP_ADDR, (uint8_t)~TOPOLOGY_VERSION);
+	}
+
+
+//---------------------------< T O P O L O G Y _ C H E C K >--------------------------------------------------
+//
+// returns the ones complement of the sum of all topology record bytes that precede the check byte
+//
+
+uint8_t SALT_ext_sensors::topology_check (void)
+	{
+	uint8_t*	ptr = (uint8_t*)&topology;
+	uint8_t		sum = 0;
+
+	while (ptr < &topology.check)
+		sum += *ptr++;
+	return ~sum;
+	}
+
+
+//---------------------------< S E N S O R _ S C A N >--------------------------------------------------------
+//
+// This function scans the sensors and calls each sensor's get_temperature_data() function to fill that sensor's
+// data struct.  Scanning begins at mux[0].port[0].sensor[0] and continues until all external sensors have been
+// queried.  This is the blocking form of scan_poll(); it runs scan_step() until the scan pass is complete.  When
+// a scan_poll() pass is in progress, sensor_scan() completes that pass.  When the muxes are on more than one bus,
+// sensor_scan() is instead the blocking form of scan_async() so that the buses' transfers overlap; HDC1080
+// readings are then those of the conversion triggered on the previous pass, as with scan_async().
+// TODO: How to map physical sensor location to the electrical sensor location?
+//
+
+uint8_t SALT_ext_sensors::sensor_scan (void)
+	{
+	if ((SCAN_IDLE == scan.state) && bus_multi ())					// muxes on more than one bus: run the buses concurrently
+		{
+		while (SCAN_BUSY == scan_async ())
+			;
+		return SUCCESS;
+		}
+
+	while (SUCCESS != scan_step ())									// SCAN_WAIT spins here until the hdc1080 is ready
+		;
+	return SUCCESS;
+	}
+
+
+//---------------------------< S C A N _ P O L L >------------------------------------------------------------
+//
+// Cooperative form of sensor_scan().  Each call resumes the scan pass where the previous call left off and does
+// bus steps until the pass is complete or until scan_slice_us has elapsed.  The time bound is checked between
+// steps; a single step (one mux control_write() or one sensor read) is never split so a call can overrun the
+// slice by at most one step.  A call always does at least one step so that the scan makes progress.
+//
+// When the next step is an HDC1080 read and that device's conversion is not yet complete, returns immediately
+// so that the caller can do other work during the wait.
+//
+// Returns SUCCESS when the call completed a scan pass, SCAN_BUSY else.  The next call after SUCCESS starts a new
+// pass.
+//
+
+uint8_t SALT_ext_sensors::scan_poll (void)
+	{
+	uint32_t	start = micros();
+	uint8_t		ret_val;
+
+	do
+		{
+		ret_val = scan_step ();
+		if (SCAN_WAIT == ret_val)										// hdc1080 conversion in progress
+			return SCAN_BUSY;											// yield; don't spin
+		}
+	while ((SCAN_BUSY == ret_val) && ((micros() - start) < scan_slice_us));
+
+	return ret_val;
+	}
+
+
+//---------------------------< S C A N _ S L I C E _ S E T >--------------------------------------------------
+//
+// set the maximum time in microseconds that a single scan_poll() call may spend on bus work.
+//
+
+void SALT_ext_sensors::scan_slice_set (uint32_t slice_us)
+	{
+	scan_slice_us = slice_us;
+	}
+
+
+//---------------------------< S C A N _ A S Y N C >----------------------------------------------------------
+//
+// Non-blocking sensor_scan() on the transaction queues.  The first call queues a whole scan pass as mux select ->
+// read -> mux disable groups (see xq_scan_queue()); that call and each later call advance the queues without
+// waiting on a bus.  Muxes on different buses are scanned concurrently.  The sensor data structs are updated by xq_result() as each group completes.  Returns
+// SCAN_BUSY while the pass is in progress and SUCCESS when it is complete; FAIL (nothing queued) when a scan_poll()
+// pass is in progress.  Don't mix with scan_poll() or sensor_scan() while a pass is in progress; they wait for
+// the queue to empty before they touch the bus.
+//
+
+uint8_t SALT_ext_sensors::scan_async (void)
+	{
+	if (!xq_scan_active)
+		{
+		if (SCAN_IDLE != scan.state)
+			return FAIL;
+		xq_scan_queue ();
+		xq_scan_active = true;
+		}
+
+	if (xq_poll ())
+		return SCAN_BUSY;
+
+	xq_scan_active = false;
+	pass_end ();
+	return SUCCESS;
+	}
+
+
+//---------------------------< X Q _ S C A N _ Q U E U E >----------------------------------------------------
+//
+// Queue one scan_async() pass.  Muxes that are not known to be disabled are disabled first; then, for each mux,
+// one group for the mux-mounted sensors (TMP275 read; HDC1080 read and re-trigger when its conversion is
+// complete, or trigger when none is pending; see scan_mms_plan()), with an MS8607 one more for its pressure and
+// temperature pipeline (read the conversion in progress, start the other), and one group per port with sensors
+// (a read of each sensor).  Every group starts with a port select (XQ_REQUIRED) and ends with a mux disable
+// (XQ_ALWAYS) so that only one mux on a bus is ever enabled and the paralleled muxes are left disabled between
+// groups.  Each mux's groups go on the queue of its own bus.
+//
+// Group tags are (m << 8) | p where p is the port, 7 for the mux-mounted sensors, or XQ_TAG_DISABLE.
+//
+
+void SALT_ext_sensors::xq_scan_queue (void)
+	{
+	SALT_ext_xq::group_t*	group;
+	uint8_t		disable = PCA9548A_PORTS_DISABLE;
+	uint8_t		trigger = MUX_HDC1080_TRIG_PTR;
+	uint8_t		measure = MS8607_H_MEASURE;
+	uint8_t		adc = MS8607_PT_ADC;
+	uint8_t		next;				// ms8607 pressure or temperature conversion to start
+	uint8_t		plan;				// MMS_HDC1080_xxx
+	boolean		hdc1080;			// hdc1080 or ms8607 humidity part read or triggered
+	boolean		ms8607;
+	boolean		tmp275;
+	uint8_t		m;
+	uint8_t		p;
+	uint8_t		i;					// indexer into sensor registry
+
+	pass_begin ();
+	for (m = 0; (m < MAX_MUXES) && mux[m].exists; m++)
+		{
+		SALT_ext_xq&	xq = mux_bus (m).xq;
+
+		if (mux_control_cached (m, PCA9548A_PORTS_DISABLE))		// left disabled by its last group
+			continue;
+
+		group = xq.group_new (xq_done, this, (m << 8) | XQ_TAG_DISABLE, &rate_stats[m].hz);
+		xq.write (group, PCA9548A_BASE_MIN | m, &disable, 1, XQ_ALWAYS);
+		xq.submit (group);
+		}
+
+	for (m = 0; (m < MAX_MUXES) && mux[m].exists; m++)
+		{
+		SALT_ext_xq&	xq = mux_bus (m).xq;
+
+		plan = scan_mms_plan (m);									// LATER: read on a later pass
+		hdc1080 = (MMS_HDC1080_READ == plan) || (MMS_HDC1080_TRIGGER == plan);
+		ms8607 = mux[m].installed_sensors & MS8607;
+		tmp275 = (mux[m].installed_sensors & TMP275) && poll_is_due (MEAS_MUX_TMP275 + m);
+
+		if (hdc1080 || tmp275)
+			{
+			group = xq.group_new (xq_done, this, (m << 8) | 7, &rate_stats[m].hz);
+			xq.write (group, PCA9548A_BASE_MIN | m, &mux[m].imux.port[7], 1, XQ_REQUIRED);
+			if (tmp275)
+				xq.read (group, TMP275_SLAVE_ADDR_7, 2);
+			if (MMS_HDC1080_READ == plan)
+				xq.read (group, MUX_HDC1080_ADDR, ms8607 ? 3 : 4);			// temperature and humidity; ms8607 humidity and crc
+			if (hdc1080)
+				xq.write (group, MUX_HDC1080_ADDR, ms8607 ? &measure : &trigger, 1);	// trigger the next conversion
+			xq.write (group, PCA9548A_BASE_MIN | m, &disable, 1, XQ_ALWAYS);
+			xq.submit (group);
+			}
+
+		if (hdc1080 && ms8607)										// ms8607 pressure and temperature: read the conversion in progress, start the other
+			{
+			SALT_ext_ms8607*	ms8607_ptr = &mux[m].ims8607;
+
+			next = ((MS8607_PT_CONV_T == ms8607_ptr->pending) ? MS8607_PT_CONV_P : MS8607_PT_CONV_T) + (2 * ms8607_ptr->osr);
+			group = xq.group_new (xq_done, this, (m << 8) | 7, &rate_stats[m].hz);
+			xq.write (group, PCA9548A_BASE_MIN | m, &mux[m].imux.port[7], 1, XQ_REQUIRED);
+			if (ms8607_ptr->pending)
+				{
+				xq.write (group, MUX_MS8607_PT_ADDR, &adc, 1);
+				xq.read (group, MUX_MS8607_PT_ADDR, 3);
+				}
+			xq.write (group, MUX_MS8607_PT_ADDR, &next, 1);
+			xq.write (group, PCA9548A_BASE_MIN | m, &disable, 1, XQ_ALWAYS);
+			xq.submit (group);
+			}
+
+		group = NULL;												// mux[m]'s registry entries that are due, one group per port
+		for (i = mux[m].sensor_first; i < (mux[m].sensor_first + mux[m].sensor_count); i++)
+			{
+			if (!poll_is_due (i))
+				continue;
+
+			if (!group || (sensor[i].p != p))						// first sensor due on this port
+				{
+				if (group)
+					{
+					xq.write (group, PCA9548A_BASE_MIN | m, &disable, 1, XQ_ALWAYS);
+					xq.submit (group);
+					}
+				p = sensor[i].p;
+				group = xq.group_new (xq_done, this, (m << 8) | sensor[i].p, &rate_stats[m].hz);
+				xq.write (group, PCA9548A_BASE_MIN | m, &mux[m].imux.port[sensor[i].p], 1, XQ_REQUIRED);
+				}
+			xq.read (group, sensor[i].addr, port_drivers[sensor[i].driver].len);
+			}
+		if (group)
+			{
+			xq.write (group, PCA9548A_BASE_MIN | m, &disable, 1, XQ_ALWAYS);
+			xq.submit (group);
+			}
+		}
+	}
+
+
+//---------------------------< X Q _ D O N E >----------------------------------------------------------------
+//
+// SALT_ext_xq done() callback for scan_async() groups; ctx is the SALT_ext_sensors instance that queued the group
+//
+
+void SALT_ext_sensors::xq_done (SALT_ext_xq::group_t* group)
+	{
+	((SALT_ext_sensors*)group->ctx)->xq_result (group);
+	}
+
+
+//---------------------------< X Q _ P O L L >----------------------------------------------------------------
+//
+// advance the transaction queue of each mux's bus once; returns the number of groups still pending on all of them
+//
+
+uint8_t SALT_ext_sensors::xq_poll (void)
+	{
+	uint8_t	pending = 0;
+
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		{
+		if (bus_first (m))
+			pending += mux_bus (m).xq.poll ();
+		}
+	return pending;
+	}
+
+
+//---------------------------< X Q _ F L U S H >--------------------------------------------------------------
+//
+// run the queues until every queued group on every bus is done; the buses keep running concurrently
+//
+
+void SALT_ext_sensors::xq_flush (void)
+	{
+	while (xq_poll ())
+		;
+	}
+
+
+//---------------------------< X Q _ R E S U L T >------------------------------------------------------------
+//
+// Store the results of a completed scan_async() group in the sensor data structs and handle faults the same way
+// scan_step() does.  op[0] is the port select; the last op is the mux disable.
+//
+
+void SALT_ext_sensors::xq_result (SALT_ext_xq::group_t* group)
+	{
+	uint8_t					m = group->tag >> 8;
+	uint8_t					p = group->tag & 0xFF;
+	SALT_ext_xq::op_t*		op_ptr;
+	uint8_t					n;								// registry index of the sensor that a port group op read
+
+	mux[m].control = PCA9548A_PORTS_DISABLE;
+	mux[m].control_known = (SUCCESS == group->op[group->ops - 1].status);	// disable acked
+
+	for (uint8_t i = 0; i < group->ops; i++)						// the mux writes: select and disable
+		{
+		op_ptr = &group->op[i];
+		if (op_ptr->started && ((PCA9548A_BASE_MIN | m) == op_ptr->addr))
+			istats_record (&mux_istats[m], m, op_ptr->us, 1, op_ptr->bus_status);
+		}
+
+	if (XQ_TAG_DISABLE == p)
+		return;
+
+	if (SUCCESS != group->op[0].status)
+		{
+		mux_fault_log (E7N_MUX_FAULT_IDX, m);						// unable to set the multiplexer
+		mux_health_update (m, false);
+		return;
+		}
+	mux_health_update (m, true);
+
+	for (n = mux[m].sensor_first; (7 != p) && (p != sensor[n].p); n++)	// port groups read the due sensors from sensor[n] on
+		;
+
+	for (uint8_t i = 1; i < (group->ops - 1); i++)
+		{
+		op_ptr = &group->op[i];
+
+		if (7 != p)													// port sensor; op[i] reads the next sensor due
+			{
+			while (!poll_is_due (n))								// not queued this pass
+				n++;
+			if (op_ptr->started)
+				istats_record (&istats[n], m, op_ptr->us, op_ptr->len, op_ptr->bus_status);
+			if (SUCCESS == op_ptr->status)
+				raw_store (n, op_ptr->data);
+			else if (!e7n.e7n_msg[E7N_EXT_TEMP_FAULT_IDX].queued)	// once any single sensor is queued other sensor faults not logged
+				{
+				e7n.exception_add (E7N_EXT_TEMP_FAULT_IDX);			// unable to read this sensor
+				XLOG (XLOG_FAULT, XLOG_E7N, m, p, sensor[n].s, E7N_EXT_TEMP_FAULT_IDX);
+				}
+			if (SUCCESS != op_ptr->status)
+				raw_failed |= (1UL << n);
+			n++;
+			}
+		else if (MUX_MS8607_PT_ADDR == op_ptr->addr)				// mux-mounted MS8607 pressure and temperature
+			{
+			SALT_ext_ms8607*	ms8607_ptr = &mux[m].ims8607;
+
+			if (op_ptr->started)
+				istats_record (&istats[MEAS_MUX_HDC1080 + m], m, op_ptr->us, op_ptr->len, op_ptr->bus_status);
+			if (op_ptr->read)										// the conversion in progress
+				{
+				uint32_t	adc = ((uint32_t)op_ptr->data[0] << 16) | (op_ptr->data[1] << 8) | op_ptr->data[2];
+
+				if ((SUCCESS == op_ptr->status) && adc && (MS8607_PT_CONV_P == ms8607_ptr->pending))
+					ms8607_ptr->d1 = adc;
+				else if ((SUCCESS == op_ptr->status) && adc)
+					ms8607_ptr->d2 = adc;
+				}
+			else if (MS8607_PT_ADC != op_ptr->data[0])				// the next conversion
+				{
+				ms8607_ptr->pending = (SUCCESS == op_ptr->status) ? (op_ptr->data[0] & 0xF0) : 0;
+				ms8607_ptr->pending_us = micros();
+				}
+			if (SUCCESS != op_ptr->status)
+				mux_fault_log (E7N_MUX_THSNSR_FAULT_IDX, m);		// unable to read this sensor
+			}
+		else if (TMP275_SLAVE_ADDR_7 == op_ptr->addr)				// mux-mounted TMP275
+			{
+			if (op_ptr->started)
+				istats_record (&istats[MEAS_MUX_TMP275 + m], m, op_ptr->us, op_ptr->len, op_ptr->bus_status);
+			if (SUCCESS == op_ptr->status)
+				raw_store (MEAS_MUX_TMP275 + m, op_ptr->data);
+			else
+				{
+				mux_fault_log (E7N_MUX_TSNSR_FAULT_IDX, m);			// unable to read this sensor
+				raw_failed |= (1UL << (MEAS_MUX_TMP275 + m));
+				}
+			}
+		else if (op_ptr->read)										// mux-mounted HDC1080
+			{
+			if (op_ptr->started)
+				istats_record (&istats[MEAS_MUX_HDC1080 + m], m, op_ptr->us, op_ptr->len, op_ptr->bus_status);
+			if ((SUCCESS == op_ptr->status) && (mux[m].installed_sensors & MS8607))
+				{
+				raw_rh[m] = ((op_ptr->data[0] << 8) | op_ptr->data[1]) & 0xFFFC;	// clear the status bits
+				raw_fresh |= (1UL << (MEAS_MUX_HDC1080 + m));
+				}
+			else if (SUCCESS == op_ptr->status)
+				{
+				raw_rh[m] = (op_ptr->data[2] << 8) | op_ptr->data[3];
+				raw_store (MEAS_MUX_HDC1080 + m, op_ptr->data);
+				}
+			else
+				{
+				mux_fault_log ((mux[m].installed_sensors & MS8607) ? E7N_MUX_THSNSR_FAULT_IDX : E7N_MUX_HSNSR_FAULT_IDX, m);	// unable to read this sensor
+				raw_failed |= (1UL << (MEAS_MUX_HDC1080 + m));
+				}
+			mux[m].hdc1080_pending = false;							// read, or lost; the trigger that follows sets it
+			}
+		else														// HDC1080 trigger
+			{
+			if (op_ptr->started)
+				istats_record (&istats[MEAS_MUX_HDC1080 + m], m, op_ptr->us, op_ptr->len, op_ptr->bus_status);
+			mux[m].hdc1080_pending = (SUCCESS == op_ptr->status);
+			if (SUCCESS == op_ptr->status)
+				mux[m].hdc1080_trigger_us = micros();
+			}
+		}
+	}
+
+
+//---------------------------< S C A N _ S T E P >------------------------------------------------------------
+//
+// Does one bus step of a scan pass.  The pass visits each mux once: port[7] first for the mux-mounted HDC1080
+// (see README) and TMP275, then the port sensors.  On the port[7] visit an HDC1080 whose conversion is complete
+// is read, which starts the next conversion; one with no conversion pending is triggered (see scan_mms_plan()).
+// Those triggered, and those still converting, are collected last, in reverse visit order so that the most
+// recently visited mux, which is still enabled, is read first.  The steps, in order:
+//	for each mux[m] that exists:
+//		enable port[7]; read HDC1080 if its conversion is complete, else trigger it if none is pending; read TMP275
+//		for each port[p] that has sensors: enable port[p]; read each sensor[s]
+//	for each mux[m] in scan.collect, last visited first, once its conversion is complete:
+//		enable port[7]; read HDC1080
+//	disable all muxes
+//
+// At the example loop() cadence every conversion is complete by the next pass, so nothing waits and port[7] is
+// enabled once per mux.  Back-to-back passes wait at the end for the conversions the previous pass started.
+//
+// With adaptive polling, sensors that are not due this pass (see poll_plan()) are skipped, and so are the port
+// selects that only they needed.
+//
+// All mux control register writes go through mux_control_write() which skips writes that would not change the
+// mux and which disables any other enabled mux before enabling a port so that the paralleled muxes are never
+// enabled at the same time.  HDC1080 reads are not attempted until HDC1080_CONV_TIME_US after the trigger so the
+// HDC1080 does not nack the read.  A mux-mounted MS8607 takes the HDC1080 steps: its trigger and its collection
+// each read one pressure or temperature conversion and start the other (see ms8607_trigger()), and the collection
+// reads the humidity part; mux[m].conv_us is its conversion time at ms8607_osr.
+//
+// State transitions that don't touch the bus are taken here without returning.
+//
+// Returns SCAN_BUSY after a bus step when there is more to do, SCAN_WAIT without touching the bus when the next
+// step is an HDC1080 read that is not yet ready, and SUCCESS when the scan pass is complete.
+//
+
+uint8_t SALT_ext_sensors::scan_step (void)
+	{
+	sensor_t*	sensor_ptr;
+
+	while (1)
+		{
+		switch (scan.state)
+			{
+			case SCAN_IDLE:												// start a new scan pass
+				xq_flush ();											// finish queued scan_async() work; this pass needs the bus
+				pass_begin ();
+				scan.m = 0;
+				scan.p = 0;
+				scan.s = 0;
+				scan.state = SCAN_MUX_SELECT;
+				break;
+
+			case SCAN_MUX_SELECT:
+				if ((MAX_MUXES <= scan.m) || !mux[scan.m].exists)		// no more muxes
+					{
+					scan.m--;											// last visited mux; wraps to 0xFF when there are no muxes
+					scan.state = SCAN_HDC_SELECT;						// collect hdc1080 results
+					break;
+					}
+
+				scan.hdc1080 = scan_mms_plan (scan.m);
+
+				if ((MMS_HDC1080_TRIGGER != scan.hdc1080) && (MMS_HDC1080_READ != scan.hdc1080) &&
+						!((mux[scan.m].installed_sensors & TMP275) && poll_is_due (MEAS_MUX_TMP275 + scan.m)))	// nothing to do on port[7]
+					{
+					scan.p = SCAN_NO_PORT;
+					scan.s = 0;
+					scan.state = SCAN_PORT_SENSOR;
+					break;
+					}
+
+				if (SUCCESS != scan_mms_select (scan.m))				// enable access to mux[m].port[7]
+					{
+					scan.m = 0;
+					scan.state = SCAN_DISABLE;							// serious problem if we can't switch the multiplexer; abandon this pass  TODO: what to do?
+					return SCAN_BUSY;
+					}
+				scan.state = SCAN_MMS_HDC1080;
+				return SCAN_BUSY;
+
+			case SCAN_MMS_HDC1080:
+				scan.state = SCAN_MMS_TMP275;
+				if (scan_mms_humidity (scan.m, scan.hdc1080))
+					return SCAN_BUSY;
+				break;
+
+			case SCAN_MMS_TMP275:
+				scan.p = SCAN_NO_PORT;
+				scan.s = 0;
+				scan.state = SCAN_PORT_SENSOR;
+				if ((mux[scan.m].installed_sensors & TMP275) && poll_is_due (MEAS_MUX_TMP275 + scan.m))
+					{
+					scan_mms_tmp275 (scan.m);
+					return SCAN_BUSY;
+					}
+				break;
+
+			case SCAN_PORT_SENSOR:
+				if (mux[scan.m].sensor_count <= scan.s)					// no (more) sensors on this mux, next mux
+					{
+					scan.m++;
+					scan.state = SCAN_MUX_SELECT;
+					break;
+					}
+
+				if (!poll_is_due (mux[scan.m].sensor_first + scan.s))	// not read this pass
+					{
+					scan.s++;
+					break;
+					}
+
+				sensor_ptr = &sensor[mux[scan.m].sensor_first + scan.s];
+				if (scan.p != sensor_ptr->p)							// first sensor on this port
+					{
+					if (SUCCESS != scan_port_select (scan.m, sensor_ptr->p))	// mux may still be on another port; skip this one's sensors
+						{
+						while ((mux[scan.m].sensor_count > scan.s) && (sensor_ptr->p == sensor[mux[scan.m].sensor_first + scan.s].p))
+							scan.s++;
+						return SCAN_BUSY;
+						}
+					scan.p = sensor_ptr->p;
+					return SCAN_BUSY;
+					}
+
+				scan_port_sensor (mux[scan.m].sensor_first + scan.s);
+				scan.s++;												// next sensor
+				return SCAN_BUSY;
+
+			case SCAN_HDC_SELECT:										// here we collect mux-mounted HDC1080 results
+				if (MAX_MUXES <= scan.m)								// all muxes done (m wrapped past 0)
+					{
+					scan.m = 0;
+					scan.state = SCAN_DISABLE;
+					break;
+					}
+
+				if (!scan_mms_collecting (scan.m))						// read on the visit, not due, or its trigger failed
+					{
+					scan.m--;
+					break;
+					}
+
+				if (!scan_mms_ready (scan.m))							// conversion not yet complete; hdc1080 would nack
+					return SCAN_WAIT;									// come back to this step
+
+				if (SUCCESS != scan_mms_select (scan.m))				// enable access to mux[m].port[7]
+					{
+					scan.m = 0;
+					scan.state = SCAN_DISABLE;							// serious problem if we can't switch the multiplexer; abandon this pass  TODO: what to do?
+					return SCAN_BUSY;
+					}
+				scan.state = SCAN_HDC_HDC1080;
+				return SCAN_BUSY;
+
+			case SCAN_HDC_HDC1080:
+				scan_mms_hdc1080 (scan.m);
+				scan.m--;												// previously visited mux
+				scan.state = SCAN_HDC_SELECT;
+				return SCAN_BUSY;
+
+			case SCAN_DISABLE:											// leave all muxes disabled between scan passes
+				if ((MAX_MUXES <= scan.m) || !mux[scan.m].exists)		// all muxes disabled
+					{
+					scan.state = SCAN_IDLE;
+					pass_end ();
+					return SUCCESS;										// scan pass complete
+					}
+
+				if (mux_control_cached (scan.m, PCA9548A_PORTS_DISABLE))	// already disabled; no bus step
+					{
+					scan.m++;
+					break;
+					}
+
+				mux_control_write (scan.m, PCA9548A_PORTS_DISABLE);		// disable access to mux[m] ports; one attempt only
+				scan.m++;
+				return SCAN_BUSY;
+			}
+		}
+	}
+
+
+//---------------------------< S C A N _ M M S _ P L A N >----------------------------------------------------
+//
+// What this pass's visit to mux[m].port[7] does with the mux humidity part (HDC1080 or MS8607):
+//	MMS_HDC1080_NONE		none installed, or not due this pass (adaptive polling)
+//	MMS_HDC1080_TRIGGER		no conversion pending (its trigger or last read failed): start one
+//	MMS_HDC1080_READ		the pending conversion is complete: read it, which starts the next
+//	MMS_HDC1080_LATER		the pending conversion is still running: leave it
+// A conversion is never re-triggered while its result is unread.  TRIGGER and LATER set bit m in scan.collect;
+// scan_step() and sensor_scan_fixed() collect those at the end of the pass.  scan_async() reads a LATER
+// conversion on a later pass instead.
+//
+
+uint8_t SALT_ext_sensors::scan_mms_plan (uint8_t m)
+	{
+	if (!(mux[m].installed_sensors & RH_SENSORS) || !poll_is_due (MEAS_MUX_HDC1080 + m))
+		return MMS_HDC1080_NONE;
+
+	if (mux[m].hdc1080_pending && scan_mms_ready (m))
+		return MMS_HDC1080_READ;
+
+	scan.collect |= (1 << m);
+	return mux[m].hdc1080_pending ? MMS_HDC1080_LATER : MMS_HDC1080_TRIGGER;
+	}
+
+
+//---------------------------< S C A N _ M M S _ R E A D Y >--------------------------------------------------
+//
+// returns true when the mux[m] HDC1080 (or MS8607) conversion started by the last trigger is complete
+//
+
+boolean SALT_ext_sensors::scan_mms_ready (uint8_t m)
+	{
+	return mux[m].conv_us <= (micros() - mux[m].hdc1080_trigger_us);
+	}
+
+
+//---------------------------< S C A N _ M M S _ C O L L E C T I N G >----------------------------------------
+//
+// returns true when the end of this pass collects the mux[m] HDC1080: scan_mms_plan() marked it, and the
+// conversion it triggered or left running is still pending
+//
+
+boolean SALT_ext_sensors::scan_mms_collecting (uint8_t m)
+	{
+	return (scan.collect & (1 << m)) && mux[m].hdc1080_pending;
+	}
+
+
+//---------------------------< S C A N _ M M S _ H U M I D I T Y >--------------------------------------------
+//
+// scan step on the mux[m].port[7] visit for scan_mms_plan()'s plan: read the conversion (which starts the next)
+// or trigger one.  Returns true when it used the bus.  mux[m].port[7] must be enabled.
+//
+
+boolean SALT_ext_sensors::scan_mms_humidity (uint8_t m, uint8_t plan)
+	{
+	if (MMS_HDC1080_READ == plan)
+		scan_mms_hdc1080 (m);
+	else if (MMS_HDC1080_TRIGGER == plan)
+		scan_mms_trigger (m);
+	else
+		return false;
+	return true;
+	}
+
+
+//---------------------------< S C A N _ P O R T _ S E L E C T >----------------------------------------------
+//
+// scan step: enable access to mux[m].port[p].  Adds and logs a mux fault when the mux doesn't ack, as
+// xq_result() does for a failed scan_async() select; the mux may still be on another port so the caller skips
+// port[p]'s sensors rather than read someone else's.
+//
+
+uint8_t SALT_ext_sensors::scan_port_select (uint8_t m, uint8_t p)
+	{
+	if (SUCCESS != mux_control_write (m, mux[m].imux.port[p]))
+		{
+		mux_fault_log (E7N_MUX_FAULT_IDX, m);							// unable to set the multiplexer
+		mux_health_update (m, false);
+		return FAIL;
+		}
+	mux_health_update (m, true);
+	return SUCCESS;
+	}
+
+
+//---------------------------< S C A N _ M M S _ S E L E C T >------------------------------------------------
+//
+// scan step: enable access to mux[m].port[7].  Adds and logs a mux fault when the mux doesn't ack; the caller
+// then abandons the scan pass.
+//
+
+uint8_t SALT_ext_sensors::scan_mms_select (uint8_t m)
+	{
+	if (SUCCESS != mux_control_write (m, mux[m].imux.port[7]))
+		{
+		mux_fault_log (E7N_MUX_FAULT_IDX, m);							// unable to set the multiplexer
+		mux_health_update (m, false);
+		return FAIL;
+		}
+	mux_health_update (m, true);
+	return SUCCESS;
+	}
+
+
+//---------------------------< S C A N _ M M S _ T R I G G E R >----------------------------------------------
+//
+// scan step: trigger a conversion on the mux[m] HDC1080 (or MS8607); mux[m].port[7] must be enabled
+//
+
+void SALT_ext_sensors::scan_mms_trigger (uint8_t m)
+	{
+	boolean	ms8607 = mux[m].installed_sensors & MS8607;
+
+	if (SUCCESS != (ms8607 ? ms8607_trigger (m) : hdc1080_trigger (m)))
+		{
+		mux[m].control_known = false;									// mux may have been reset
+		mux_fault_log (ms8607 ? E7N_MUX_THSNSR_FAULT_IDX : E7N_MUX_HSNSR_FAULT_IDX, m);	// unable to trigger this sensor
+		raw_failed |= (1UL << (MEAS_MUX_HDC1080 + m));
+		}
+	}
+
+
+//---------------------------< S C A N _ M M S _ T M P 2 7 5 >------------------------------------------------
+//
+// scan step: read the mux[m] TMP275; mux[m].port[7] must be enabled
+//
+
+void SALT_ext_sensors::scan_mms_tmp275 (uint8_t m)
+	{
+	uint8_t	data[2];
+
+	if (SUCCESS != raw_read (m, MEAS_MUX_TMP275 + m, TMP275_SLAVE_ADDR_7, data, 2))			// attempt to get the sensor's data
+		{
+		mux[m].control_known = false;									// mux may have been reset
+		mux_fault_log (E7N_MUX_TSNSR_FAULT_IDX, m);					// unable to read this sensor
+		raw_failed |= (1UL << (MEAS_MUX_TMP275 + m));
+		}
+	else
+		raw_store (MEAS_MUX_TMP275 + m, data);
+	}
+
+
+//---------------------------< S C A N _ M M S _ H D C 1 0 8 0 >----------------------------------------------
+//
+// scan step: read the mux[m] HDC1080 temperature and humidity registers and trigger the next conversion;
+// mux[m].port[7] must be enabled and the conversion must be complete.  An MS8607 has its humidity register read
+// and is triggered; its temperature and pressure come from the conversions that ms8607_trigger() reads.
+//
+
+void SALT_ext_sensors::scan_mms_hdc1080 (uint8_t m)
+	{
+	boolean	ms8607 = mux[m].installed_sensors & MS8607;
+	uint8_t	data[4];
+
+	if (SUCCESS != raw_read (m, MEAS_MUX_HDC1080 + m, MUX_HDC1080_ADDR, data, ms8607 ? 3 : 4))	// attempt to get the sensor's data
+		{
+		mux[m].control_known = false;									// mux may have been reset
+		mux_fault_log (ms8607 ? E7N_MUX_THSNSR_FAULT_IDX : E7N_MUX_HSNSR_FAULT_IDX, m);	// unable to read this sensor
+		raw_failed |= (1UL << (MEAS_MUX_HDC1080 + m));
+		mux[m].hdc1080_pending = false;									// the next visit starts a new conversion
+		return;
+		}
+
+	if (ms8607)
+		{
+		raw_rh[m] = ((data[0] << 8) | data[1]) & 0xFFFC;				// clear the status bits; data[2] is the crc
+		raw_fresh |= (1UL << (MEAS_MUX_HDC1080 + m));
+		ms8607_trigger (m);												// next pressure or temperature and humidity conversions
+		return;
+		}
+
+	raw_rh[m] = (data[2] << 8) | data[3];
+	raw_store (MEAS_MUX_HDC1080 + m, data);
+	hdc1080_trigger (m);												// start the next conversion
+	}
+
+
+//---------------------------< S C A N _ P O R T _ S E N S O R >----------------------------------------------
+//
+// scan step: read registry entry sensor[i] with its driver's data layout; its port must be enabled
+//
+
+void SALT_ext_sensors::scan_port_sensor (uint8_t i)
+	{
+	sensor_t*	sensor_ptr = &sensor[i];
+	uint8_t		data[XQ_DATA];
+
+	if (SUCCESS != raw_read (sensor_ptr->m, i, sensor_ptr->addr, data, port_drivers[sensor_ptr->driver].len))	// attempt to get the sensor's data
+		{
+		mux[sensor_ptr->m].control_known = false;						// mux may have been reset
+		if (!e7n.e7n_msg[E7N_EXT_TEMP_FAULT_IDX].queued)				// if not yet queued
+			{															// once any single sensor is queued other sensor faults not logged
+			e7n.exception_add (E7N_EXT_TEMP_FAULT_IDX);					// unable to read this sensor
+			XLOG (XLOG_FAULT, XLOG_E7N, sensor_ptr->m, sensor_ptr->p, sensor_ptr->s, E7N_EXT_TEMP_FAULT_IDX);	// log_drain() logs it
+			}
+		raw_failed |= (1UL << i);
+		}
+	else
+		raw_store (i, data);
+	}
+
+
+//---------------------------< R A W _ R E A D >--------------------------------------------------------------
+//
+// Read len bytes of meas channel n from the register that addr's pointer register selects (the temperature
+// register for TMP275s; the temperature and humidity registers for the HDC1080) and count the transfer in
+// istats[n].  Returns SUCCESS when the device acked and sent len bytes.
+//
+
+uint8_t SALT_ext_sensors::raw_read (uint8_t m, uint8_t n, uint8_t addr, uint8_t* data, uint8_t len)
+	{
+	i2c_t3&		wire = mux_bus (m).wire;
+	uint32_t	start_us = micros();
+	size_t		count = wire.requestFrom (addr, (size_t)len);
+
+	istats_record (&istats[n], m, micros() - start_us, len, wire.status ());
+	if (len != count)
+		return FAIL;
+
+	for (uint8_t i = 0; i < len; i++)
+		data[i] = wire.read ();
+	return SUCCESS;
+	}
+
+
+//---------------------------< R A W _ S T O R E >------------------------------------------------------------
+//
+// store the big-endian temperature register bytes read for meas channel n; HDC1080 callers store raw_rh first
+//
+
+void SALT_ext_sensors::raw_store (uint8_t n, uint8_t* data)
+	{
+	raw[n] = (data[0] << 8) | data[1];
+	raw_fresh |= (1UL << n);
+	}
+
+
+//---------------------------< M E A S _ C O N V E R T >------------------------------------------------------
+//
+// Convert every raw value read since the last call to hundredths in meas with integer math and push it to its
+// channel's history, then check the threshold subscriptions (thresh_eval()) and update the channels' health and
+// adaptive polling intervals.  When data_float is set, also fill the drivers' float data struct fields so that consumers
+// of the *_data_ptr_get() structs see the same values as before.  Called by pass_end() at the end of each scan pass.
+//
+
+void SALT_ext_sensors::meas_convert (void)
+	{
+	uint32_t	fresh = raw_fresh;
+	uint8_t		n;
+	uint8_t		m;
+
+	raw_fresh = 0;
+	meas.valid |= fresh;
+
+	for (n = 0; n < MEAS_MUX_TMP275; n++)							// port sensors, by their drivers
+		{
+		if (!(fresh & (1UL << n)))
+			continue;
+
+		const port_driver_t*	driver_ptr = &port_drivers[sensor[n].driver];
+
+		meas.centi_c[n] = driver_ptr->centi_c (raw[n]);
+		meas.centi_f[n] = driver_ptr->centi_f (raw[n]);
+		sensor[n].history.push (meas.centi_c[n]);
+		if (data_float)
+			(this->*driver_ptr->data_float) (&sensor[n], raw[n]);
+		}
+
+	for (m = 0; n < MEAS_MUX_HDC1080; m++, n++)						// mux-mounted TMP275s
+		{
+		if (!(fresh & (1UL << n)))
+			continue;
+
+		meas.centi_c[n] = tmp275_centi_c (raw[n]);
+		meas.centi_f[n] = tmp275_centi_f (raw[n]);
+		mux[m].tmp275_history.push (meas.centi_c[n]);
+		if (data_float)
+			{
+			mux[m].itmp275.data.raw_temp = raw[n];
+			mux[m].itmp275.data.deg_c = (int16_t)raw[n] / 256.0;
+			mux[m].itmp275.data.deg_f = (mux[m].itmp275.data.deg_c * 1.8) + 32.0;
+			}
+		}
+
+	for (m = 0, n = MEAS_MUX_HDC1080; m < MAX_MUXES; m++, n++)		// HDC1080s
+		{
+		if (!(fresh & (1UL << n)))
+			continue;
+		if (mux[m].installed_sensors & MS8607)
+			{
+			ms8607_convert (m);
+			continue;
+			}
+
+		meas.centi_c[n] = hdc1080_centi_c (raw[n]);
+		meas.centi_f[n] = hdc1080_centi_f (raw[n]);
+		meas.centi_rh[m] = hdc1080_centi_rh (raw_rh[m]);
+
+		mux[m].hdc1080_t_history.push (meas.centi_c[n]);
+		mux[m].hdc1080_rh_history.push (meas.centi_rh[m]);
+		if (data_float)
+			{
+			mux[m].ihdc1080.data.raw_temp = raw[n];
+			mux[m].ihdc1080.data.raw_rh = raw_rh[m];
+			mux[m].ihdc1080.data.deg_c = ((raw[n] * 165.0) / 65536.0) - 40.0;
+			mux[m].ihdc1080.data.deg_f = (mux[m].ihdc1080.data.deg_c * 1.8) + 32.0;
+			mux[m].ihdc1080.data.rh = (raw_rh[m] * 100.0) / 65536.0;
+			}
+		}
+
+	thresh_eval (fresh);
+	health_update (fresh, raw_failed);
+	raw_failed = 0;
+	if (poll_adaptive)
+		poll_update (fresh);
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ C O N V E R T >--------------------------------------------------
+//
+// meas_convert() for the mux[m] MS8607: compensate the latest pressure and temperature results and the humidity
+// read this pass into its data struct, meas, and the mux humidity channel histories
+//
+
+void SALT_ext_sensors::ms8607_convert (uint8_t m)
+	{
+	SALT_ext_ms8607*	ms8607_ptr = &mux[m].ims8607;
+	uint8_t				n = MEAS_MUX_HDC1080 + m;
+
+	ms8607_ptr->compensate ();
+	ms8607_ptr->data.raw_pressure = ms8607_ptr->d1;
+	ms8607_ptr->data.raw_temp = ms8607_ptr->d2;
+	ms8607_ptr->data.raw_rh = raw_rh[m];
+	ms8607_ptr->data.centi_rh = ms8607_ptr->centi_rh_get (raw_rh[m]);
+
+	meas.centi_c[n] = ms8607_ptr->data.centi_c;
+	meas.centi_f[n] = centi_c_to_f (ms8607_ptr->data.centi_c);
+	meas.centi_rh[m] = ms8607_ptr->data.centi_rh;
+	meas.pa[m] = ms8607_ptr->data.pa;
+
+	mux[m].hdc1080_t_history.push (meas.centi_c[n]);
+	mux[m].hdc1080_rh_history.push (meas.centi_rh[m]);
+	if (data_float)
+		{
+		ms8607_ptr->data.deg_c = ms8607_ptr->data.centi_c / 100.0;
+		ms8607_ptr->data.deg_f = (ms8607_ptr->data.deg_c * 1.8) + 32.0;
+		ms8607_ptr->data.rh = ms8607_ptr->data.centi_rh / 100.0;
+		ms8607_ptr->data.mbar = ms8607_ptr->data.pa / 100.0;
+		}
+	}
+
+
+//---------------------------< P A S S _ B E G I N >----------------------------------------------------------
+//
+// start of a scan pass: stamp it for scan_time and plan which channels it reads
+//
+
+void SALT_ext_sensors::pass_begin (void)
+	{
+	pass_start_us = micros();
+	pass_active = true;
+	scan.collect = 0;
+	poll_plan ();
+	}
+
+
+//---------------------------< P A S S _ E N D >--------------------------------------------------------------
+//
+// end of a scan pass: record its duration in scan_time, convert what it read, publish the result, write it to
+// the telemetry sink, and probe for hot-plugged sensors
+//
+
+void SALT_ext_sensors::pass_end (void)
+	{
+	uint32_t	us = micros() - pass_start_us;
+	uint32_t	fresh = raw_fresh;								// meas_convert() clears these
+	uint32_t	failed = raw_failed;
+
+	pass_active = false;
+	scan_time.passes++;
+	scan_time.last_us = us;
+	scan_time.total_us += us;
+	if (us > scan_time.max_us)
+		scan_time.max_us = us;
+	meas_convert ();
+	snapshot_publish ();
+	telemetry_write (fresh, failed);
+	hotplug_run ();
+	}
+
+
+//---------------------------< S N A P S H O T _ P U B L I S H >----------------------------------------------
+//
+// Copy meas into the snapshot[] entry that readers are not pointed at and then point them at it.  The entry's seq
+// is made odd before the copy and even after it, with a memory barrier at each step, so a reader that holds the
+// entry from two publishes ago sees seq change.  Runs in whatever context the scan runs in (loop(), an interrupt
+// or another task); readers need no lock.
+//
+
+void SALT_ext_sensors::snapshot_publish (void)
+	{
+	snapshot_t*	next = &snapshot[snapshot_pub ^ 1];
+
+	snapshot_seq += 2;
+	next->seq = snapshot_seq - 1;								// being rewritten
+	__sync_synchronize ();
+	next->pass_ms = millis();
+	memcpy (&next->meas, &meas, sizeof(meas_t));
+	__sync_synchronize ();
+	next->seq = snapshot_seq;
+	__sync_synchronize ();
+	snapshot_pub ^= 1;											// readers now get next
+	}
+
+
+//---------------------------< S N A P S H O T _ G E T >------------------------------------------------------
+//
+// Returns the snapshot of the most recent scan pass, in place, and its seq in *seq.  Read what is needed from it,
+// then call snapshot_check() and read again if that returns false (a scan published twice in the meantime):
+//
+//	do
+//		{
+//		snap = ext_sensors.snapshot_get (&seq);
+//		centi_c = snap->meas.centi_c[n];
+//		centi_rh = snap->meas.centi_rh[m];
+//		}
+//	while (!ext_sensors.snapshot_check (snap, seq));
+//
+// Unlike meas and the drivers' data structs (tmp275_data_ptr_get() etc.), which a scan writes as it goes, a
+// snapshot holds every reading of one pass and its pass_ms.
+//
+
+const SALT_ext_sensors::snapshot_t* SALT_ext_sensors::snapshot_get (uint32_t* seq)
+	{
+	const snapshot_t*	snap = &snapshot[snapshot_pub];
+
+	*seq = snap->seq;
+	__sync_synchronize ();										// seq before the reader's reads
+	return snap;
+	}
+
+
+//---------------------------< S N A P S H O T _ C H E C K >--------------------------------------------------
+//
+// true when snap, as returned by snapshot_get() with seq, hasn't been rewritten since; the reads made from it in
+// between are from one scan pass
+//
+
+boolean SALT_ext_sensors::snapshot_check (const snapshot_t* snap, uint32_t seq)
+	{
+	__sync_synchronize ();										// the reader's reads before seq
+	return !(seq & 1) && (seq == snap->seq);
+	}
+
+
+//---------------------------< T H R E S H _ A D D >----------------------------------------------------------
+//
+// Subscribe to the readings of mux[m].port[p].sensor[s] (see meas_channel_get()): cb is called, from inside the
+// scan pass that read it, when a reading of quantity (THRESH_C, THRESH_RH or THRESH_PA) goes above high or below
+// low, and when it comes back hyst inside that limit.  THRESH_NO_HIGH and THRESH_NO_LOW leave a side off.  A
+// reading already outside a limit is reported on its first pass.  The location needn't have a sensor yet; each
+// discovery binds the subscription to whatever is there and starts it over at THRESH_IN.  Returns the thresh[]
+// index, or THRESH_NONE when thresh[] is full or an argument is bad.
+//
+
+uint8_t SALT_ext_sensors::thresh_add (uint8_t m, uint8_t p, uint8_t s, uint8_t quantity, int32_t low, int32_t high,
+		int32_t hyst, thresh_cb_t cb, void* ctx)
+	{
+	thresh_t*	thresh_ptr;
+	uint8_t		i;
+
+	if (!cb || (THRESH_PA < quantity) || (low > high) || (0 > hyst))
+		return THRESH_NONE;
+
+	for (i = 0; (i < THRESH_MAX) && thresh[i].cb; i++)				// find a free entry
+		;
+	if (THRESH_MAX == i)
+		return THRESH_NONE;
+
+	thresh_ptr = &thresh[i];
+	thresh_ptr->ctx = ctx;
+	thresh_ptr->high = high;
+	thresh_ptr->low = low;
+	thresh_ptr->hyst = hyst;
+	thresh_ptr->value = 0;
+	thresh_ptr->m = m;
+	thresh_ptr->p = p;
+	thresh_ptr->s = s;
+	thresh_ptr->quantity = quantity;
+	thresh_ptr->state = THRESH_IN;
+	thresh_ptr->n = thresh_channel (i);
+	thresh_ptr->cb = cb;											// last: the entry is in use
+	thresh_map ();
+	return i;
+	}
+
+
+//---------------------------< T H R E S H _ R E M O V E >----------------------------------------------------
+//
+// end subscription thresh[i]; its index may be returned by a later thresh_add().  Safe to call from a callback.
+//
+
+void SALT_ext_sensors::thresh_remove (uint8_t i)
+	{
+	if (THRESH_MAX <= i)
+		return;
+
+	thresh[i].cb = NULL;
+	thresh_map ();
+	}
+
+
+//---------------------------< T H R E S H _ C H A N N E L >--------------------------------------------------
+//
+// returns the meas channel that thresh[i] watches: the channel at its location, when that channel has its
+// quantity; else MEAS_NONE
+//
+
+uint8_t SALT_ext_sensors::thresh_channel (uint8_t i)
+	{
+	thresh_t*	thresh_ptr = &thresh[i];
+	uint8_t		n = meas_channel_get (thresh_ptr->m, thresh_ptr->p, thresh_ptr->s);
+
+	if ((MEAS_NONE == n) || (THRESH_C == thresh_ptr->quantity))
+		return n;
+	if ((MEAS_MUX_HDC1080 > n) || (MEAS_MUX_HDC1080 + MAX_MUXES <= n))	// humidity and pressure are on the mux humidity channels
+		return MEAS_NONE;
+	if ((THRESH_PA == thresh_ptr->quantity) && !(mux[thresh_ptr->m].installed_sensors & MS8607))
+		return MEAS_NONE;
+	return n;
+	}
+
+
+//---------------------------< T H R E S H _ B I N D >--------------------------------------------------------
+//
+// Point every subscription at the meas channel now at its location.  With restart (the end of discovery) every
+// subscription starts over at THRESH_IN; after a hot-plug change only those whose sensor came or went do, and the
+// others keep their state on the channel their sensor moved to.
+//
+
+void SALT_ext_sensors::thresh_bind (boolean restart)
+	{
+	uint8_t	n;
+
+	for (uint8_t i = 0; i < THRESH_MAX; i++)
+		{
+		n = thresh_channel (i);
+		if (restart || ((MEAS_NONE == n) != (MEAS_NONE == thresh[i].n)))
+			thresh[i].state = THRESH_IN;
+		thresh[i].n = n;
+		}
+	thresh_map ();
+	}
+
+
+//---------------------------< T H R E S H _ M A P >----------------------------------------------------------
+//
+// rebuild thresh_channels from the bound subscriptions
+//
+
+void SALT_ext_sensors::thresh_map (void)
+	{
+	uint32_t	channels = 0;
+
+	for (uint8_t i = 0; i < THRESH_MAX; i++)
+		{
+		if (thresh[i].cb && (MEAS_NONE != thresh[i].n))
+			channels |= (1UL << thresh[i].n);
+		}
+	thresh_channels = channels;
+	}
+
+
+//---------------------------< T H R E S H _ E V A L >--------------------------------------------------------
+//
+// Called by meas_convert() with the channels read this pass, once their readings are in meas.  Moves each
+// subscription on a fresh channel to the state its reading puts it in and calls its callback when the state
+// changed.  Going straight from above high to below low (or back) is one crossing.
+//
+
+void SALT_ext_sensors::thresh_eval (uint32_t fresh)
+	{
+	thresh_t*	thresh_ptr;
+	int32_t		value;
+	uint8_t		state;
+
+	fresh &= thresh_channels;
+	if (!fresh)
+		return;
+
+	for (uint8_t i = 0; i < THRESH_MAX; i++)
+		{
+		thresh_ptr = &thresh[i];
+		if (!thresh_ptr->cb || (MEAS_NONE == thresh_ptr->n) || !(fresh & (1UL << thresh_ptr->n)))
+			continue;
+
+		if (THRESH_C == thresh_ptr->quantity)
+			value = meas.centi_c[thresh_ptr->n];
+		else if (THRESH_RH == thresh_ptr->quantity)
+			value = meas.centi_rh[thresh_ptr->n - MEAS_MUX_HDC1080];
+		else
+			value = meas.pa[thresh_ptr->n - MEAS_MUX_HDC1080];
+
+		state = thresh_ptr->state;
+		if (value > thresh_ptr->high)
+			state = THRESH_ABOVE;
+		else if (value < thresh_ptr->low)
+			state = THRESH_BELOW;
+		else if ((THRESH_ABOVE == state) && (value < (thresh_ptr->high - thresh_ptr->hyst)))
+			state = THRESH_IN;
+		else if ((THRESH_BELOW == state) && (value > (thresh_ptr->low + thresh_ptr->hyst)))
+			state = THRESH_IN;
+
+		if (state == thresh_ptr->state)
+			continue;
+		thresh_ptr->state = state;
+		thresh_ptr->value = value;
+		thresh_ptr->cb (thresh_ptr);
+		}
+	}
+
+
+//---------------------------< T E L E M E T R Y _ S I N K _ S E T >------------------------------------------
+//
+// From the end of the next scan pass, encode each pass as a binary record (see T E L E M E T R Y   R E C O R D in
+// SALT_ext_sensors.h) and call sink with it and ctx.  The first record is a key record.  sink runs in the scan's
+// context and must not keep the record pointer; to log, append the bytes to a file or buffer.  NULL stops the
+// records.  Clears telemetry_stats.
+//
+
+void SALT_ext_sensors::telemetry_sink_set (telemetry_sink_t sink, void* ctx)
+	{
+	telemetry_sink = sink;
+	telemetry_ctx = ctx;
+	telemetry_since_key = TELEMETRY_KEY_INTERVAL;
+	memset (&telemetry_stats, 0, sizeof(telemetry_stats));
+	}
+
+
+//---------------------------< T E L E M E T R Y _ K E Y >----------------------------------------------------
+//
+// make the next record a key record so that the stream can be decoded from there; call when the sink starts a
+// new file
+//
+
+void SALT_ext_sensors::telemetry_key (void)
+	{
+	telemetry_since_key = TELEMETRY_KEY_INTERVAL;
+	}
+
+
+//---------------------------< T E L E M E T R Y _ E N C O D E >----------------------------------------------
+//
+// Encode this pass into telemetry_buf.  fresh and failed are the channels the pass read and failed to read.  A
+// channel is present when it has a sensor: registry entries 0 .. sensor_count - 1 and the installed mux-mounted
+// sensors.  The entries are coded against telemetry_prev, which a key record zeroes, and telemetry_prev is left
+// holding this record's values.  Returns the record length.
+//
+
+uint16_t SALT_ext_sensors::telemetry_encode (uint32_t fresh, uint32_t failed)
+	{
+	uint8_t*	ptr = &telemetry_buf[8];						// past the fixed header
+	uint32_t	present = (1UL << sensor_count) - 1;
+	uint32_t	pass_ms = snapshot[snapshot_pub].pass_ms;		// just published
+	boolean		key;
+	uint8_t		sum = 0;
+	uint16_t	len;
+	uint8_t		m;
+
+	for (m = 0; m < MAX_MUXES; m++)
+		{
+		if (mux[m].installed_sensors & TMP275)
+			present |= (1UL << (MEAS_MUX_TMP275 + m));
+		if (mux[m].installed_sensors & RH_SENSORS)
+			present |= (1UL << (MEAS_MUX_HDC1080 + m));
+		}
+
+	key = (TELEMETRY_KEY_INTERVAL <= telemetry_since_key) || (present != telemetry_prev.present);
+	if (key)
+		{
+		memset (&telemetry_prev, 0, sizeof(telemetry_prev));	// key record entries are the values
+		telemetry_prev.present = present;
+		telemetry_since_key = 0;
+		}
+	telemetry_since_key++;
+
+	ptr = varint_put (ptr, present);
+	ptr = varint_put (ptr, meas.valid & present);
+	ptr = varint_put (ptr, fresh & present);
+	ptr = varint_put (ptr, failed & present);
+
+	if (key)
+		{
+		*ptr++ = MAX_REG_SENSORS;								// the channel layout
+		*ptr++ = MAX_MUXES;
+		for (uint8_t i = 0; i < sensor_count; i++)
+			{
+			*ptr++ = sensor[i].m;
+			*ptr++ = (sensor[i].p << 4) | sensor[i].s;
+			}
+		}
+
+	for (uint8_t n = 0; n < MEAS_CHANNELS; n++)
+		{
+		if (!(present & (1UL << n)))
+			continue;
+
+		ptr = varint_put (ptr, zigzag (meas.centi_c[n] - telemetry_prev.centi_c[n]));
+		telemetry_prev.centi_c[n] = meas.centi_c[n];
+		if (MEAS_MUX_HDC1080 > n)
+			continue;
+
+		m = n - MEAS_MUX_HDC1080;								// mux humidity part: humidity and pressure too
+		ptr = varint_put (ptr, zigzag (meas.centi_rh[m] - telemetry_prev.centi_rh[m]));
+		ptr = varint_put (ptr, zigzag (meas.pa[m] - telemetry_prev.pa[m]));
+		telemetry_prev.centi_rh[m] = meas.centi_rh[m];
+		telemetry_prev.pa[m] = meas.pa[m];
+		}
+
+	len = (ptr - telemetry_buf) + 1;							// + check
+	telemetry_buf[0] = TELEMETRY_MAGIC;
+	telemetry_buf[1] = (TELEMETRY_VERSION << 4) | (key ? TELEMETRY_KEY : 0);
+	telemetry_buf[2] = (uint8_t)len;
+	telemetry_buf[3] = (uint8_t)(len >> 8);
+	telemetry_buf[4] = (uint8_t)pass_ms;
+	telemetry_buf[5] = (uint8_t)(pass_ms >> 8);
+	telemetry_buf[6] = (uint8_t)(pass_ms >> 16);
+	telemetry_buf[7] = (uint8_t)(pass_ms >> 24);
+
+	for (ptr = telemetry_buf; ptr < &telemetry_buf[len - 1]; ptr++)
+		sum += *ptr;
+	*ptr = ~sum;
+	return len;
+	}
+
+
+//---------------------------< T E L E M E T R Y _ W R I T E >------------------------------------------------
+//
+// called by pass_end(): when there is a sink, encode the pass that just ended and hand the record to the sink
+//
+
+void SALT_ext_sensors::telemetry_write (uint32_t fresh, uint32_t failed)
+	{
+	uint16_t	len;
+
+	if (NULL == telemetry_sink)
+		return;
+
+	len = telemetry_encode (fresh, failed);
+	telemetry_stats.records++;
+	if (telemetry_buf[1] & TELEMETRY_KEY)
+		telemetry_stats.keys++;
+	telemetry_stats.bytes += len;
+	telemetry_sink (telemetry_buf, len, telemetry_ctx);
+	}
+
+
+//---------------------------< D A T A _ F L O A T _ S E T >--------------------------------------------------
+//
+// When enable is true (the default) each scan pass also fills the deg_c, deg_f and rh fields of the drivers' data
+// structs (see the *_data_ptr_get() functions).  Sketches that use meas instead can turn this off to save the
+// float conversions.
+//
+
+void SALT_ext_sensors::data_float_set (boolean enable)
+	{
+	data_float = enable;
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ O S R _ S E T >--------------------------------------------------
+//
+// Set the oversampling ratio (MS8607_OSR_xxx) of the mux-mounted MS8607 pressure and temperature conversions and
+// with it the humidity resolution.  Higher ratios are quieter and take longer: 0.56mS and 8-bit rh at
+// MS8607_OSR_256, 17.2mS and 12-bit rh at MS8607_OSR_8192.  Taken up by the next sensor_discover().
+//
+
+void SALT_ext_sensors::ms8607_osr_set (uint8_t osr)
+	{
+	if (MS8607_OSRS > osr)
+		ms8607_osr = osr;
+	}
+
+
+//---------------------------< P O L L _ P L A N >------------------------------------------------------------
+//
+// Called at the start of each scan_step() and scan_async() pass: sets poll_due to the channels that are read this
+// pass.  Channels and muxes that are backed off (see health_tick()) are left out.  Adds the bus time that
+// sensor_scan() would have spent on the reads, port selects and mux disables that adaptive polling skipped, at
+// each mux's branch rate, to poll_saved_ns; scan_async(), which disables the mux after every group, saves somewhat
+// more.  Every channel is due when adaptive polling is off and nothing is backed off.
+//
+
+void SALT_ext_sensors::poll_plan (void)
+	{
+	uint32_t	bits;									// bit times skipped on mux[m]'s branch
+	uint8_t		ports;									// ports of mux[m] with sensors not backed off ..
+	uint8_t		ports_due;								// .. and with a sensor due this pass
+	uint8_t		p_seen;									// last port counted in ports
+	uint8_t		p;										// last port counted in ports_due
+	boolean		mms;									// port[7] visited this pass
+	boolean		mms_skipped;							// a mux-mounted sensor was skipped by adaptive polling
+	uint8_t		i;
+
+	if (!poll_adaptive && !health_out && !health_mux_out)
+		{
+		poll_due = 0xFFFFFFFF;
+		return;
+		}
+
+	poll_due = 0;
+	for (uint8_t m = 0; (m < MAX_MUXES) && mux[m].exists; m++)
+		{
+		if (!health_tick (&mux_health[m]))						// mux backed off; nothing on it is due
+			continue;
+
+		bits = 0;
+		mms = false;
+		mms_skipped = false;
+		if ((mux[m].installed_sensors & TMP275) && health_tick (&health[MEAS_MUX_TMP275 + m]))
+			{
+			if (poll_tick (MEAS_MUX_TMP275 + m))
+				mms = true;
+			else
+				{
+				bits += POLL_BITS (2);							// read
+				mms_skipped = true;
+				}
+			}
+		if ((mux[m].installed_sensors & RH_SENSORS) && health_tick (&health[MEAS_MUX_HDC1080 + m]))
+			{
+			if (poll_tick (MEAS_MUX_HDC1080 + m))
+				mms = true;
+			else
+				{
+				bits += (3 * POLL_BITS (1)) + POLL_BITS (4);	// trigger, port[7] select to collect, read, re-trigger
+				mms_skipped = true;
+				}
+			}
+		if (!mms && mms_skipped)
+			bits += POLL_BITS (1);								// port[7] select
+
+		ports = 0;
+		ports_due = 0;
+		p_seen = SCAN_NO_PORT;
+		p = SCAN_NO_PORT;
+		for (i = mux[m].sensor_first; i < (mux[m].sensor_first + mux[m].sensor_count); i++)
+			{
+			if (!health_tick (&health[i]))
+				continue;
+			if (sensor[i].p != p_seen)
+				{
+				p_seen = sensor[i].p;
+				ports++;
+				}
+			if (!poll_tick (i))
+				bits += POLL_BITS (2);							// read
+			else if (sensor[i].p != p)
+				{
+				p = sensor[i].p;
+				ports_due++;
+				}
+			}
+		bits += (ports - ports_due) * POLL_BITS (1);			// port selects
+		if (!mms && !ports_due && (mms_skipped || ports))
+			bits += POLL_BITS (1);								// mux not visited; no disable
+
+		if (rate_stats[m].hz)
+			poll_saved_ns += (uint64_t)bits * 1000000000 / rate_stats[m].hz;
+		}
+	}
+
+
+//---------------------------< P O L L _ T I C K >------------------------------------------------------------
+//
+// Returns true and sets channel n's poll_due bit when its wait has run out; else counts down its wait
+//
+
+boolean SALT_ext_sensors::poll_tick (uint8_t n)
+	{
+	if (poll[n].wait)
+		{
+		poll[n].wait--;
+		return false;
+		}
+
+	poll_due |= (1UL << n);
+	return true;
+	}
+
+
+//---------------------------< P O L L _ U P D A T E >--------------------------------------------------------
+//
+// Called by meas_convert() with the channels read this pass.  A channel whose reading (and, for the HDC1080,
+// humidity) is within the deadband of its reference reading doubles its interval up to POLL_INTERVAL_MAX.  A
+// channel without a reference reading, or whose reading has moved beyond the deadband, takes the reading as its
+// new reference and goes back on every pass; so does a channel whose read failed.
+//
+
+void SALT_ext_sensors::poll_update (uint32_t fresh)
+	{
+	poll_t*		poll_ptr;
+	boolean		steady;
+
+	for (uint8_t n = 0; n < MEAS_CHANNELS; n++)
+		{
+		if (!poll_is_due (n))
+			continue;
+
+		poll_ptr = &poll[n];
+		if (!(fresh & (1UL << n)))								// read failed or abandoned
+			{
+			poll_ptr->interval = 0;
+			poll_ptr->wait = 0;
+			continue;
+			}
+
+		steady = poll_ptr->interval && (poll_deadband_c >= abs (meas.centi_c[n] - poll_ptr->ref_c));
+		if (MEAS_MUX_HDC1080 <= n)
+			steady = steady && (poll_deadband_rh >= abs (meas.centi_rh[n - MEAS_MUX_HDC1080] - poll_ptr->ref_rh));
+
+		if (!steady)
+			{
+			poll_ptr->interval = 1;
+			poll_ptr->ref_c = meas.centi_c[n];
+			if (MEAS_MUX_HDC1080 <= n)
+				poll_ptr->ref_rh = meas.centi_rh[n - MEAS_MUX_HDC1080];
+			}
+		else if ((POLL_INTERVAL_MAX / 2) >= poll_ptr->interval)
+			poll_ptr->interval *= 2;
+		else
+			poll_ptr->interval = POLL_INTERVAL_MAX;
+		poll_ptr->wait = poll_ptr->interval - 1;
+		}
+	}
+
+
+//---------------------------< P O L L _ A D A P T I V E _ S E T >--------------------------------------------
+//
+// When enable is true, each scan pass reads only the sensors that are due; steady sensors are read as seldom as
+// once every POLL_INTERVAL_MAX passes.  Enabling puts every sensor back on every pass and restarts the bus time
+// saved estimate.  sensor_scan_fixed() runs sensor_scan() while adaptive polling is on.
+//
+
+void SALT_ext_sensors::poll_adaptive_set (boolean enable)
+	{
+	poll_adaptive = enable;
+	poll_snap_all ();
+	poll_due = 0xFFFFFFFF;
+	if (enable)
+		{
+		poll_saved_ns = 0;
+		poll_start_ms = millis();
+		}
+	}
+
+
+//---------------------------< P O L L _ D E A D B A N D _ S E T >--------------------------------------------
+//
+// set the change in hundredths of a °C and of a %RH from a sensor's reference reading that puts the sensor back
+// on every pass
+//
+
+void SALT_ext_sensors::poll_deadband_set (int16_t centi_c, int16_t centi_rh)
+	{
+	poll_deadband_c = centi_c;
+	poll_deadband_rh = centi_rh;
+	}
+
+
+//---------------------------< P O L L _ S N A P >------------------------------------------------------------
+//
+// Put mux[m].port[p].sensor[s] (see meas_channel_get()) back on every pass starting with the next one; for the
+// control loop when it needs fresh readings from that sensor.  The sensor backs off again once it is steady.
+//
+
+void SALT_ext_sensors::poll_snap (uint8_t m, uint8_t p, uint8_t s)
+	{
+	uint8_t	n = meas_channel_get (m, p, s);
+
+	if (MEAS_NONE == n)
+		return;
+
+	poll[n].interval = 0;
+	poll[n].wait = 0;
+	}
+
+
+//---------------------------< P O L L _ S N A P _ A L L >----------------------------------------------------
+//
+// put every sensor back on every pass starting with the next one
+//
+
+void SALT_ext_sensors::poll_snap_all (void)
+	{
+	memset (poll, 0, sizeof(poll));
+	}
+
+
+//---------------------------< P O L L _ S A V E D _ G E T >--------------------------------------------------
+//
+// Returns the estimated bus time, in microseconds per hour, that adaptive polling has saved since it was enabled:
+// the reads and port selects it skipped, each at its mux branch's rate when it was skipped, scaled to an hour.
+//
+
+uint32_t SALT_ext_sensors::poll_saved_get (void)
+	{
+	uint32_t	elapsed_ms = millis() - poll_start_ms;
+
+	if (!poll_adaptive || !elapsed_ms)
+		return 0;
+
+	return (uint32_t)((poll_saved_ns / 1000) * 3600000 / elapsed_ms);
+	}
+
+
+//---------------------------< H E A L T H _ T I C K >--------------------------------------------------------
+//
+// Returns true when the sensor or mux is not backed off or when its recovery probe is due this pass; else counts
+// down its wait and returns false
+//
+
+boolean SALT_ext_sensors::health_tick (health_t* health_ptr)
+	{
+	if (!health_ptr->backoff || !health_ptr->wait)
+		return true;
+
+	health_ptr->wait--;
+	return false;
+	}
+
+
+//---------------------------< H E A L T H _ F A I L >--------------------------------------------------------
+//
+// Count a failed read or select.  The HEALTH_FAILS_MAXth consecutive failure starts a backoff of 2 passes; each
+// failed recovery probe after that doubles it, up to HEALTH_BACKOFF_MAX.  Returns true when this failure started
+// the backoff.
+//
+
+boolean SALT_ext_sensors::health_fail (health_t* health_ptr)
+	{
+	boolean	started = false;
+
+	if (0xFF > health_ptr->fails)
+		health_ptr->fails++;
+	if (0xFFFF > health_ptr->faults)
+		health_ptr->faults++;
+
+	if (health_ptr->backoff)
+		health_ptr->backoff = ((HEALTH_BACKOFF_MAX / 2) >= health_ptr->backoff) ? (health_ptr->backoff * 2) : HEALTH_BACKOFF_MAX;
+	else if (HEALTH_FAILS_MAX <= health_ptr->fails)
+		{
+		health_ptr->backoff = 2;
+		started = true;
+		}
+
+	health_ptr->wait = health_ptr->backoff ? (health_ptr->backoff - 1) : 0;
+	return started;
+	}
+
+
+//---------------------------< H E A L T H _ U P D A T E >----------------------------------------------------
+//
+// Called by meas_convert() with the channels read (fresh) and the channels whose read failed this pass.  Channels
+// in neither, because their pass was abandoned or they weren't due, are left as they are.
+//
+
+void SALT_ext_sensors::health_update (uint32_t fresh, uint32_t failed)
+	{
+	uint8_t		m;
+	uint8_t		p;
+	uint8_t		s;
+	uint32_t	bit;
+
+	for (uint8_t n = 0; n < MEAS_CHANNELS; n++)
+		{
+		bit = 1UL << n;
+		if (!((fresh | failed) & bit))
+			continue;
+
+		if (MEAS_MUX_TMP275 > n)								// location for the event log
+			{
+			m = sensor[n].m;
+			p = sensor[n].p;
+			s = sensor[n].s;
+			}
+		else
+			{
+			m = (MEAS_MUX_HDC1080 > n) ? (n - MEAS_MUX_TMP275) : (n - MEAS_MUX_HDC1080);
+			p = 7;
+			s = (MEAS_MUX_HDC1080 > n) ? 0 : 1;
+			}
+
+		if (fresh & bit)
+			{
+			if (health[n].backoff)
+				XLOG (XLOG_INFO, XLOG_RECOVERED, m, p, s, health[n].faults);
+			health[n].fails = 0;
+			health[n].backoff = 0;
+			health_out &= ~bit;
+			}
+		else if (health_fail (&health[n]))
+			{
+			XLOG (XLOG_FAULT, XLOG_BACKOFF, m, p, s, health[n].faults);
+			health_out |= bit;
+			}
+		}
+	}
+
+
+//---------------------------< M U X _ H E A L T H _ U P D A T E >--------------------------------------------
+//
+// count a good (ok true) or failed port select on mux[m]
+//
+
+void SALT_ext_sensors::mux_health_update (uint8_t m, boolean ok)
+	{
+	if (ok)
+		{
+		if (mux_health[m].backoff)
+			XLOG (XLOG_INFO, XLOG_RECOVERED, m, XLOG_NA, XLOG_NA, mux_health[m].faults);
+		mux_health[m].fails = 0;
+		mux_health[m].backoff = 0;
+		health_mux_out &= ~(1 << m);
+		}
+	else if (health_fail (&mux_health[m]))
+		{
+		XLOG (XLOG_FAULT, XLOG_BACKOFF, m, XLOG_NA, XLOG_NA, mux_health[m].faults);
+		health_mux_out |= (1 << m);
+		}
+	}
+
+
+//---------------------------< F A U L T S _ G E T >----------------------------------------------------------
+//
+// returns the number of failed reads of mux[m].port[p].sensor[s] (see meas_channel_get()) since discovery; 0 when
+// there is no such sensor
+//
+
+uint16_t SALT_ext_sensors::faults_get (uint8_t m, uint8_t p, uint8_t s)
+	{
+	uint8_t	n = meas_channel_get (m, p, s);
+
+	return (MEAS_NONE == n) ? 0 : health[n].faults;
+	}
+
+
+//---------------------------< B A C K O F F _ G E T >--------------------------------------------------------
+//
+// returns the number of scan passes between recovery probes of mux[m].port[p].sensor[s]; 0 when it is not backed
+// off or when there is no such sensor
+//
+
+uint8_t SALT_ext_sensors::backoff_get (uint8_t m, uint8_t p, uint8_t s)
+	{
+	uint8_t	n = meas_channel_get (m, p, s);
+
+	return (MEAS_NONE == n) ? 0 : health[n].backoff;
+	}
+
+
+//---------------------------< M U X _ F A U L T S _ G E T >--------------------------------------------------
+//
+// returns the number of failed port selects of mux[m] since discovery
+//
+
+uint16_t SALT_ext_sensors::mux_faults_get (uint8_t m)
+	{
+	return (MAX_MUXES > m) ? mux_health[m].faults : 0;
+	}
+
+
+//---------------------------< M U X _ B A C K O F F _ G E T >------------------------------------------------
+//
+// returns the number of scan passes between recovery probes of mux[m]; 0 when it is not backed off
+//
+
+uint8_t SALT_ext_sensors::mux_backoff_get (uint8_t m)
+	{
+	return (MAX_MUXES > m) ? mux_health[m].backoff : 0;
+	}
+
+
+//---------------------------< H O T P L U G _ S E T >--------------------------------------------------------
+//
+// When enable is true, the end of each scan pass probes port sensor slots for sensors that were plugged in,
+// unplugged or replaced and changes the registry to match; see hotplug_run().  Off by default.
+//
+
+void SALT_ext_sensors::hotplug_set (boolean enable)
+	{
+	hotplug = enable;
+	}
+
+
+//---------------------------< H O T P L U G _ S L I C E _ S E T >--------------------------------------------
+//
+// set the maximum time in microseconds that hot-plug probing may add to the end of a scan pass
+//
+
+void SALT_ext_sensors::hotplug_slice_set (uint32_t slice_us)
+	{
+	hotplug_slice_us = slice_us;
+	}
+
+
+//---------------------------< H O T P L U G _ R U N >--------------------------------------------------------
+//
+// Called by pass_end().  Goes on round the port sensor slots of the muxes that exist and aren't backed off from
+// hotplug_slot, probing each empty or backed off one (hotplug_probe()), until hotplug_slice_us has elapsed or
+// every slot has been looked at once.  As with scan_poll() the time is checked between probes, so a probe that
+// finds a sensor and sets it up can overrun the slice.  Leaves the muxes disabled.
+//
+
+void SALT_ext_sensors::hotplug_run (void)
+	{
+	uint32_t	start;
+	uint8_t		slot;
+	uint8_t		m;
+	boolean		probed = false;
+
+	if (!hotplug)
+		return;
+
+	start = micros();
+	for (uint8_t n = 0; n < HOTPLUG_SLOTS; n++)						// at most once round per pass
+		{
+		slot = hotplug_slot;
+		hotplug_slot = ((HOTPLUG_SLOTS - 1) > slot) ? (slot + 1) : 0;
+		m = slot / (MAX_PORTS * MAX_SENSORS);
+		if (!mux[m].exists || (health_mux_out & (1 << m)))
+			continue;
+
+		if (hotplug_probe (m, (slot / MAX_SENSORS) % MAX_PORTS, slot % MAX_SENSORS))
+			{
+			probed = true;
+			if ((micros() - start) >= hotplug_slice_us)
+				break;
+			}
+		}
+
+	if (!probed)													// healthy sensors in every slot that has one; no bus work
+		return;
+
+	for (m = 0; (m < MAX_MUXES) && mux[m].exists; m++)				// leave all muxes disabled between scan passes
+		mux_control_write (m, PCA9548A_PORTS_DISABLE);
+	hotplug_stats.us += micros() - start;
+	}
+
+
+//---------------------------< H O T P L U G _ P R O B E >----------------------------------------------------
+//
+// Probe mux[m].port[p].sensor[s] when it is empty or its sensor is backed off; returns true when that used the
+// bus.  As in discovery a sensor exists when its tmp275 address acks, and its eeprom, when it has one, says
+// what it is.
+//	empty slot that acks: plugged in; the sensor is added to the registry
+//	backed off sensor that doesn't ack: unplugged; its entry is removed
+//	backed off sensor that acks as another type or address: replaced; its entry is set up again from scratch
+//	backed off sensor that acks as the same type and address: its driver is initialized again in case it was
+//		power cycled; health recovery probes decide whether it is back
+//
+
+boolean SALT_ext_sensors::hotplug_probe (uint8_t m, uint8_t p, uint8_t s)
+	{
+	uint8_t		i = registry_find (m, p, s);
+	uint8_t		driver = PORT_DRIVER_TMP275;						// nodes without an eeprom are TMP275s
+	uint8_t		addr = TMP275_BASE_MIN + s;
+	boolean		eep;
+
+	if ((MEAS_NONE != i) ? !(health_out & (1UL << i)) : (MAX_REG_SENSORS <= sensor_count))
+		return false;												// healthy sensor; or empty and no room in the registry
+
+	hotplug_stats.probes++;
+	if (SUCCESS != mux_control_write (m, mux[m].imux.port[p]))		// enable access to mux[m].port[p]
+		return true;
+
+	if (SUCCESS != mux_bus (m).ping (TMP275_BASE_MIN + s))
+		{
+		if (MEAS_NONE != i)											// unplugged
+			{
+			XLOG (XLOG_INFO, XLOG_HOTPLUG_REMOVED, m, p, s, i);
+			registry_delete (i);
+			topology.mux[m].port[p] &= ~(0x11 << s);
+			hotplug_stats.removed++;
+			hotplug_changed (m);
+			}
+		return true;
+		}
+
+	eep = (SUCCESS == mux_bus (m).ping (EEP_BASE_MIN | s));
+	if (eep)
+		driver = port_driver_read (m, p, s, &addr);
+
+	if (MEAS_NONE == i)												// plugged in
+		{
+		port_sensor_setup (m, p, s, eep, driver, addr);
+		XLOG (XLOG_INFO, XLOG_HOTPLUG_ADDED, m, p, s, registry_find (m, p, s));
+		hotplug_stats.added++;
+		}
+	else if ((driver != sensor[i].driver) || (addr != sensor[i].addr))	// replaced
+		{
+		registry_delete (i);
+		port_sensor_setup (m, p, s, eep, driver, addr);
+		XLOG (XLOG_INFO, XLOG_HOTPLUG_REPLACED, m, p, s, i);
+		hotplug_stats.replaced++;
+		}
+	else
+		{
+		(this->*port_drivers[driver].init) (&sensor[i], mux_bus (m));	// same kind of sensor; may have lost its configuration
+		mux_bus (m).rate_now = 0;									// the driver's begin() may have reset the bus rate
+		return true;
+		}
+
+	topology.mux[m].port[p] = (topology.mux[m].port[p] & ~(0x11 << s)) | (1 << s) | (eep ? (0x10 << s) : 0);
+	hotplug_changed (m);
+	return true;
+	}
+
+
+//---------------------------< H O T P L U G _ C H A N G E D >------------------------------------------------
+//
+// after hot-plug changed the registry behind mux[m]: re-bind the threshold subscriptions, save the topology
+// record so that the next warm boot restores what is there now, and publish the new channel layout
+//
+
+void SALT_ext_sensors::hotplug_changed (uint8_t m)
+	{
+	topology_fixed = 0;												// the registry no longer holds the fixed topology
+	mux_bus (m).rate_now = 0;										// the drivers' begin() may have reset the bus rate
+	thresh_bind (false);
+	topology_save ();
+	snapshot_publish ();
+	}
+
+
+//---------------------------< A U T O   R A T E   S T E P S >------------------------------------------------
+//
+// the auto rate ladder; step 0 is also the fallback for a bus whose base rate is below I2C_RATE_400
+//
+
+static const uint32_t	rate_steps[RATE_STEPS] = {I2C_RATE_100, I2C_RATE_400, I2C_RATE_1000};
+
+
+//---------------------------< I S T A T S _ R E C O R D >----------------------------------------------------
+//
+// Record a transfer behind mux[m] (or to mux[m]) in istats_ptr.  During a scan pass also count it at mux[m]'s rate
+// and, with rate_auto set, in mux[m]'s error window: RATE_ERRORS_MAX errors step the branch down at once; a window
+// of RATE_WINDOW transfers with fewer errors is clean and, unless the branch is waiting out a hold, steps it up.
+//
+
+void SALT_ext_sensors::istats_record (SALT_ext_istats* istats_ptr, uint8_t m, uint32_t us, uint8_t bytes, uint8_t status)
+	{
+	rate_t*			rate_ptr = &rate[m];
+	rate_stats_t*	stats_ptr = &rate_stats[m];
+	boolean			error = (I2C_WAITING != status);
+
+	istats_ptr->record (us, bytes, status);
+	if (!pass_active)
+		return;												// discovery probes nack by design
+
+	stats_ptr->transfers[rate_ptr->step]++;
+	if (error)
+		stats_ptr->errors[rate_ptr->step]++;
+	if (!rate_auto)
+		return;
+
+	rate_ptr->window++;
+	if (error && (RATE_ERRORS_MAX <= ++rate_ptr->errors))	// too many errors at this rate
+		{
+		rate_ptr->window = 0;
+		rate_ptr->errors = 0;
+		if (0 == rate_ptr->step)
+			return;											// nowhere to go
+		if (!rate_ptr->hold)
+			rate_ptr->hold = 1;
+		else
+			rate_ptr->hold = ((RATE_HOLD_MAX / 2) >= rate_ptr->hold) ? (rate_ptr->hold * 2) : RATE_HOLD_MAX;
+		rate_ptr->wait = rate_ptr->hold;
+		rate_ptr->climbed = false;
+		rate_step (m, rate_ptr->step - 1);
+		}
+	else if (RATE_WINDOW <= rate_ptr->window)				// a clean window
+		{
+		rate_ptr->window = 0;
+		rate_ptr->errors = 0;
+		if (rate_ptr->climbed)								// the step it climbed to is good
+			{
+			rate_ptr->climbed = false;
+			rate_ptr->hold = 0;
+			}
+		if (rate_ptr->wait)
+			rate_ptr->wait--;
+		else if ((RATE_AUTO_MAX > rate_ptr->step) && ((RATE_STEPS - 1) > rate_ptr->step))
+			{
+			rate_ptr->climbed = true;
+			rate_step (m, rate_ptr->step + 1);
+			}
+		}
+	}
+
+
+//---------------------------< R A T E _ R E S E T >----------------------------------------------------------
+//
+// put mux[m] back on the base rate of its bus and clear its auto rate state and counters
+//
+
+void SALT_ext_sensors::rate_reset (uint8_t m)
+	{
+	uint32_t	base = mux_bus (m).rate;
+	uint8_t		step;
+
+	for (step = RATE_STEPS - 1; step && (rate_steps[step] > base); step--)	// highest step no faster than the base rate
+		;
+	memset (&rate[m], 0, sizeof(rate_t));
+	memset (&rate_stats[m], 0, sizeof(rate_stats_t));
+	rate[m].step = step;
+	rate_stats[m].hz = base;
+	}
+
+
+//---------------------------< R A T E _ S T E P >------------------------------------------------------------
+//
+// move mux[m] to rate_steps[step]; takes effect at the mux's next select (mux_control_write() or scan_async()
+// group)
+//
+
+void SALT_ext_sensors::rate_step (uint8_t m, uint8_t step)
+	{
+	if (step > rate[m].step)
+		{
+		rate_stats[m].ups++;
+		XLOG (XLOG_INFO, XLOG_RATE_UP, m, XLOG_NA, XLOG_NA, rate_steps[step] / 1000);
+		}
+	else
+		{
+		rate_stats[m].downs++;
+		XLOG (XLOG_FAULT, XLOG_RATE_DOWN, m, XLOG_NA, XLOG_NA, rate_steps[step] / 1000);
+		}
+	rate[m].step = step;
+	rate_stats[m].hz = rate_steps[step];
+	}
+
+
+//---------------------------< R A T E _ A U T O _ S E T >----------------------------------------------------
+//
+// When enable is true each mux branch looks for the highest rate, up to rate_steps[RATE_AUTO_MAX], at which its
+// scan traffic stays below RATE_ERRORS_MAX errors per RATE_WINDOW transfers (see A U T O   R A T E in the header).
+// Every branch starts over from its bus base rate either way; so does every sensor_discover().
+//
+
+void SALT_ext_sensors::rate_auto_set (boolean enable)
+	{
+	rate_auto = enable;
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		rate_reset (m);
+	}
+
+
+//---------------------------< R A T E _ G E T >--------------------------------------------------------------
+//
+// returns the rate in Hz that mux[m] and everything behind it runs at; 0 when there is no mux[m]
+//
+
+uint32_t SALT_ext_sensors::rate_get (uint8_t m)
+	{
+	return ((MAX_MUXES > m) && mux[m].exists) ? rate_stats[m].hz : 0;
+	}
+
+
+//---------------------------< R A T E _ S T A T S _ P T R _ G E T >------------------------------------------
+//
+// returns a pointer to mux[m]'s auto rate state and per-rate transfer and error counters or NULL
+//
+
+SALT_ext_sensors::rate_stats_t* SALT_ext_sensors::rate_stats_ptr_get (uint8_t m)
+	{
+	return ((MAX_MUXES > m) && mux[m].exists) ? &rate_stats[m] : NULL;
+	}
+
+
+//---------------------------< M U X _ C O N T R O L _ W R I T E >--------------------------------------------
+//
+// Write control to mux[m]'s control register unless the mux has already confirmed that value.  Before enabling
+// any port on mux[m], every other mux on the same bus that is not known to be disabled is disabled so that only
+// one mux on a bus is ever enabled at a time.  A write that fails leaves the control register unknown so that the next write to that mux
+// is not skipped.  Written or skipped, the bus is left at mux[m]'s rate for the branch traffic that follows.
+//
+// Each skipped write saves a mux address + one data byte of bus time (about 0.3mS at 100kHz) and is counted in
+// mux_writes_saved (mux_control_cached()).  The disables of the other muxes are not counted; they are there for
+// the one-mux-at-a-time guarantee, not writes a scan asked for.
+//
+
+uint8_t SALT_ext_sensors::mux_control_write (uint8_t m, uint8_t control)
+	{
+	uint32_t	start_us;
+	uint8_t		ret_val;
+
+	if (mux_control_cached (m, control))							// mux already set this way
+		{
+		mux_bus (m).rate_apply (rate_stats[m].hz);					// what follows is mux[m] branch traffic
+		return SUCCESS;
+		}
+
+	if (PCA9548A_PORTS_DISABLE != control)								// enabling a port; other muxes must be disabled
+		{
+		for (uint8_t i = 0; (i < MAX_MUXES) && mux[i].exists; i++)
+			{
+			if ((i != m) && (&mux_bus (i) == &mux_bus (m)) && (!mux[i].control_known || (PCA9548A_PORTS_DISABLE != mux[i].control)))
+				mux_control_write (i, PCA9548A_PORTS_DISABLE);
+			}
+		}
+
+	mux_bus (m).rate_apply (rate_stats[m].hz);						// after the other muxes' disables
+	start_us = micros();
+	ret_val = mux[m].imux.control_write (control);
+	istats_record (&mux_istats[m], m, micros() - start_us, 1, mux_bus (m).wire.status ());
+	mux[m].control = control;
+	mux[m].control_known = (SUCCESS == ret_val);						// only trust what the mux acked
+	return ret_val;
+	}
+
+
+//---------------------------< M U X _ C O N T R O L _ C A C H E D >------------------------------------------
+//
+// Returns true when mux[m] has confirmed that its control register holds control, so a write of control can be
+// skipped, and counts the skipped write in mux_writes_saved.  For callers that skip the write, or queue it, on
+// their own: scan_step()'s SCAN_DISABLE and xq_scan_queue().
+//
+
+boolean SALT_ext_sensors::mux_control_cached (uint8_t m, uint8_t control)
+	{
+	if (!mux[m].control_known || (control != mux[m].control))
+		return false;
+
+	mux_writes_saved++;
+	return true;
+	}
+
+
+//---------------------------< M U X _ W R I T E S _ S A V E D _ G E T >--------------------------------------
+//
+// returns the number of mux control_write()s that were skipped because the mux was already set; see
+// mux_control_cached()
+//
+
+uint32_t SALT_ext_sensors::mux_writes_saved_get (void)
+	{
+	return mux_writes_saved;
+	}
+
+
+//---------------------------< H D C 1 0 8 0 _ T R I G G E R >------------------------------------------------
+//
+// Start a temperature and humidity conversion on the mux[m] HDC1080 by writing the temperature register address
+// to its pointer register.  mux[m].port[7] must be enabled (and all other muxes disabled) before calling this
+// function.  Results are available HDC1080_CONV_TIME_US later.
+//
+
+uint8_t SALT_ext_sensors::hdc1080_trigger (uint8_t m)
+	{
+	i2c_t3&		wire = mux_bus (m).wire;
+	uint32_t	start_us = micros();
+	uint8_t		ret_val;
+
+	wire.beginTransmission (MUX_HDC1080_ADDR);
+	wire.write (MUX_HDC1080_TRIG_PTR);
+	ret_val = wire.endTransmission();							// returns SUCCESS if the address and pointer were acked
+	mux[m].hdc1080_trigger_us = micros();						// conversion starts at the stop condition
+	mux[m].hdc1080_pending = (SUCCESS == ret_val);
+	istats_record (&istats[MEAS_MUX_HDC1080 + m], m, mux[m].hdc1080_trigger_us - start_us, 1, wire.status ());
+	return ret_val;
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ C M D >----------------------------------------------------------
+//
+// Write the one-byte command cmd to the mux[m] MS8607 part at addr (MUX_MS8607_PT_ADDR or MUX_MS8607_H_ADDR) and
+// count the transfer on the mux humidity channel.  mux[m].port[7] must be enabled.
+//
+
+uint8_t SALT_ext_sensors::ms8607_cmd (uint8_t m, uint8_t addr, uint8_t cmd)
+	{
+	return ms8607_write (m, addr, &cmd, 1);
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ W R I T E >------------------------------------------------------
+//
+// Write len bytes (a command and its data) to the mux[m] MS8607 part at addr and count the transfer on the mux
+// humidity channel.  mux[m].port[7] must be enabled.
+//
+
+uint8_t SALT_ext_sensors::ms8607_write (uint8_t m, uint8_t addr, const uint8_t* data, uint8_t len)
+	{
+	i2c_t3&		wire = mux_bus (m).wire;
+	uint32_t	start_us = micros();
+	uint8_t		ret_val;
+
+	wire.beginTransmission (addr);
+	wire.write (data, len);
+	ret_val = wire.endTransmission();							// returns SUCCESS if the address and every byte were acked
+	istats_record (&istats[MEAS_MUX_HDC1080 + m], m, micros() - start_us, len, wire.status ());
+	return ret_val;
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ I N I T >--------------------------------------------------------
+//
+// Reset both parts of the mux[m] MS8607, read and check the pressure and temperature calibration PROM, set the
+// humidity resolution that goes with ms8607_osr, and start the pipeline (a temperature conversion and a humidity
+// conversion).  Blocks for the 15mS humidity part reset.  mux[m].port[7] must be enabled.
+//
+
+uint8_t SALT_ext_sensors::ms8607_init (uint8_t m)
+	{
+	SALT_ext_ms8607*	ms8607_ptr = &mux[m].ims8607;
+	uint8_t				data[2];
+
+	memset (ms8607_ptr, 0, sizeof(SALT_ext_ms8607));
+	ms8607_ptr->osr = ms8607_osr;
+
+	if ((SUCCESS != ms8607_cmd (m, MUX_MS8607_PT_ADDR, MS8607_PT_RESET)) || (SUCCESS != ms8607_cmd (m, MUX_MS8607_H_ADDR, MS8607_H_RESET)))
+		return FAIL;
+	delay (15);													// humidity part reset time; pressure part: 2.8mS
+
+	for (uint8_t i = 0; i < 7; i++)
+		{
+		if ((SUCCESS != ms8607_cmd (m, MUX_MS8607_PT_ADDR, MS8607_PT_PROM + (2 * i))) ||
+				(SUCCESS != raw_read (m, MEAS_MUX_HDC1080 + m, MUX_MS8607_PT_ADDR, data, 2)))
+			return FAIL;
+		ms8607_ptr->prom[i] = (data[0] << 8) | data[1];
+		}
+	if (!ms8607_ptr->prom_check ())
+		return FAIL;
+
+	if ((SUCCESS != ms8607_cmd (m, MUX_MS8607_H_ADDR, MS8607_H_USER_READ)) ||
+			(SUCCESS != raw_read (m, MEAS_MUX_HDC1080 + m, MUX_MS8607_H_ADDR, data, 1)))
+		return FAIL;
+	data[1] = (data[0] & 0x7E) | ms8607_osrs[ms8607_ptr->osr].h_res;	// keep the other user register bits
+	data[0] = MS8607_H_USER_WRITE;
+	if (SUCCESS != ms8607_write (m, MUX_MS8607_H_ADDR, data, 2))
+		return FAIL;
+
+	mux[m].conv_us = ms8607_ptr->conv_us ();
+	return ms8607_trigger (m);
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ P T _ S T E P >--------------------------------------------------
+//
+// Read the result of the mux[m] MS8607 pressure or temperature conversion in progress (it must be complete) into
+// d1 or d2 and start a conversion of the other one; starts a temperature conversion when none is in progress.
+// mux[m].port[7] must be enabled.
+//
+
+uint8_t SALT_ext_sensors::ms8607_pt_step (uint8_t m)
+	{
+	SALT_ext_ms8607*	ms8607_ptr = &mux[m].ims8607;
+	uint8_t				data[3];
+	uint8_t				next = MS8607_PT_CONV_T;
+	uint32_t			adc;
+
+	if (ms8607_ptr->pending)
+		{
+		if ((SUCCESS != ms8607_cmd (m, MUX_MS8607_PT_ADDR, MS8607_PT_ADC)) ||
+				(SUCCESS != raw_read (m, MEAS_MUX_HDC1080 + m, MUX_MS8607_PT_ADDR, data, 3)))
 			{
-			Serial.printf ("\tmux[%d] not detected\n", m);
-			break;
+			ms8607_ptr->pending = 0;							// start over with a temperature conversion
+			return FAIL;
 			}
 
-		mux[m].imux.setup (mux_addr, Wire1, (char*)"Wire1");		// initialize this instance
-		mux[m].imux.begin (I2C_PINS_29_30, I2C_RATE_100);
-		mux[m].imux.init ();
-
-		mux[m].exists = true;										// so we can use mux-mounted sensors even when nothing attached to mux[m] ports
-		Serial.printf ("\tmux[%d] detected\n", m);
-		for (p = 0; p < MAX_PORTS; p++)								// here only when we were able to initialize a mux
+		adc = ((uint32_t)data[0] << 16) | (data[1] << 8) | data[2];
+		if (adc)												// 0 when read before the conversion completed
 			{
-			if (SUCCESS != mux[m].imux.control_write (mux[m].imux.port[p]))		// enable access to mux[m].port[p]
-				Serial.printf ("mux[%d].imux.control_write (mux[%d].imux.port[%d]) fail (0x%.02X)", m, m, p, mux[m].imux.port[p]);
-
-			for (s = 0; s < MAX_SENSORS; s++)
-				{
-				eep_addr = EEP_BASE_MIN | (s & 7);					// make eeprom slave address from lowest base addr and sensor array index
-				if (SUCCESS != pingex (eep_addr, Wire1))
-					{
-					Serial.printf ("\tmux[%d].port[%d].sensor[%d] eeprom not detected\n", m, p, s);
-//					continue;												// continue to next sensor or break to next port?
-					}
-				else
-					{
-					mux[m].port[p].sensor[s].ieep.setup (eep_addr, Wire1, (char*)"Wire1");
-					mux[m].port[p].sensor[s].ieep.begin (I2C_PINS_29_30, I2C_RATE_100);
-					mux[m].port[p].sensor[s].ieep.init ();
-					Serial.printf ("\tmux[%d].port[%d].sensor[%d] eeprom detected\n", m, p, s);
-					// here we read eeprom to discover sensor type; switch on that value and attempt to instantiate
-					}
-
-				switch (sensor_type)
-					{
-					case TMP275:
-						sensor_addr = TMP275_BASE_MIN + (s & 7);			// make sensor slave address from lowest base addr and sensor array index
-
-						if (SUCCESS != pingex (sensor_addr, Wire1))
-							{
-							Serial.printf ("\tmux[%d].port[%d].sensor[%d] tmp275 not detected\n", m, p, s);
-							break_flag=true;			// flag to break out of switch and then break out of sensor for loop
-							break;
-							}
-
-						mux[m].port[p].sensor[s].itmp275.setup (sensor_addr, Wire1, (char*)"Wire1");	// initialize this sensor instance
-						mux[m].port[p].sensor[s].itmp275.begin (I2C_PINS_29_30, I2C_RATE_100);
-						mux[m].port[p].sensor[s].itmp275.init (TMP275_CFG_RES12);
-
-						// set temp sensor pointer register to point at temperature register here or elsewhere?
-						mux[m].has_sensors = true;							// flag to indicate that there is a mux[m] that has sensors
-						mux[m].port[p].has_sensors = true;					// flag to indicate that port[p] has sensors
-						mux[m].port[p].sensor[s].addr = sensor_addr;		// if not 0, then sensor[s] exists
-						mux[m].port[p].sensor[s].type = TMP275;				// if not 0, then sensor[s] exists
-						Serial.printf ("\tmux[%d].port[%d].sensor[%d] tmp275 detected\n", m, p, s);
-
-						// fill sensor struct parameters (whatever they are) here
-//						sensor_type = 0; //undo spoof
-						break;
-
-					case 0:		//
-						break;
-					default:
-						Serial.printf ("sensor type not recognized\n");
-					}
-				if ((break_flag) || (0 == sensor_type))
-					{
-					break_flag=false;	// used when breaking out of switch should cause break out of sensor for loop
-					break;
-					}
-				}
-			if (false == mux[m].port[p].has_sensors)
-				break;
+			if (MS8607_PT_CONV_P == ms8607_ptr->pending)
+				ms8607_ptr->d1 = adc;
+			else
+				ms8607_ptr->d2 = adc;
 			}
-		mux[m].imux.control_write (PCA9548A_PORTS_DISABLE);			// disable access to mux[m] ports
+		next = (MS8607_PT_CONV_T == ms8607_ptr->pending) ? MS8607_PT_CONV_P : MS8607_PT_CONV_T;
 		}
 
-	Serial.printf ("discovering mux-mounted sensors...\n");
-
-	for (m = 0; m < MAX_MUXES; m++)												// here we discover mux-mounted sensors
-		{
-		if (mux[m].exists)														// on muxes that exist
-			{
-			if (SUCCESS != mux[m].imux.control_write (mux[m].imux.port[7]))		// enable access to mux[m].port[7]
-				{
-				Serial.printf ("mux[%d].imux.control_write (mux[%d].imux.port[7]) fail (0x%.02X)", m, m, mux[m].imux.port[7]);
-				break;															// serious problem if we can't switch the multiplexer  TODO: what to do?
-				}
+	ms8607_ptr->pending = 0;
+	if (SUCCESS != ms8607_cmd (m, MUX_MS8607_PT_ADDR, next + (2 * ms8607_ptr->osr)))
+		return FAIL;
+	ms8607_ptr->pending = next;
+	ms8607_ptr->pending_us = micros();
+	return SUCCESS;
+	}
 
-			if (SUCCESS != pingex (MUX_EEP_ADDR, Wire1))
-				{
-				Serial.printf ("\tmux[%d] eeprom not detected\n", m);
-				continue;														// no eeprom so no sensors here; try next mux
-				}
-			else
-				{
-				mux[m].ieep.setup (MUX_EEP_ADDR, Wire1, (char*)"Wire1");		// initialize eeprom instance
-				mux[m].ieep.begin (I2C_PINS_29_30, I2C_RATE_100);
-				mux[m].ieep.init ();
-				Serial.printf ("\tmux[%d] eeprom detected\n", m);
-				}
 
-// PROBLEM: Because NAP have put muxes in the field without properly loaded eeproms and because there are also
-// previous versions out there that write 0x05 to address 0 in the eeprom (that was done to get this code working),
-// we somehow have to support those.  There have never been muxes with MS8607 so we only need to worry about
-// systems that have 0xFF or 0x05 in eeprom address 0
-			mux[m].ieep.set_addr16 (0);										// point to page 0, address 0
-			mux[m].ieep.byte_read();										// read it ('M' is 0x4D
-			if ((0x05 == mux[m].ieep.control.rd_byte) || (0xFF == mux[m].ieep.control.rd_byte))		// if address 0 is 'erased' or 0x05, write a value there
-				{
-				e7n.exception_add (E7N_UNINIT_MUX_IDX);
-				Serial.printf ("uninitialized MUX eeprom\n");
-				// TODO: change this to an exception
-				}
+//---------------------------< M S 8 6 0 7 _ T R I G G E R >--------------------------------------------------
+//
+// The mux[m] MS8607 counterpart of hdc1080_trigger(): step the pressure and temperature pipeline and start a
+// humidity conversion.  Both are done mux[m].conv_us later.  mux[m].port[7] must be enabled.
+//
 
-			// here we read eeprom to discover what to do next
-
-			mux[m].installed_sensors = 0;									// init to be safe
-
-			mux[m].ieep.set_addr16 (ASSY_PAGE_ADDR);						// point to page 0, address 0; this is [assembly] page
-			mux[m].ieep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			mux[m].ieep.control.rd_buf_ptr = assy_page.as_array;			// point to destination buffer
-			mux[m].ieep.page_read ();										// read the page
-
-			mux[m].ieep.set_addr16 (SENSOR1_PAGE_ADDR);						// point to page 1, address 0; this is [sensor 1] page
-			mux[m].ieep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			mux[m].ieep.control.rd_buf_ptr = sensor1_page.as_array;			// point to destination buffer
-			mux[m].ieep.page_read ();										// read the page
-
-			if (strcmp (sensor1_page.as_struct.sensor_type, "TMP275"))
-				mux[m].installed_sensors = TMP275;
-			else if (strcmp (sensor1_page.as_struct.sensor_type, "HDC1080"))
-				mux[m].installed_sensors = HDC1080;
-			else if (strcmp (sensor1_page.as_struct.sensor_type, "MS8607PT"))
-				mux[m].installed_sensors = MS8607;
-			else if (strcmp (sensor1_page.as_struct.sensor_type, "MS8607H"))
-				mux[m].installed_sensors = MS8607;
-			else if (0xFF != *sensor1_page.as_struct.sensor_type)
-				Serial.printf ("unknown [sensor 1] type: %s\n", sensor1_page.as_struct.sensor_type);
-			else
-				Serial.printf ("[sensor 1] type not specified\n");
+uint8_t SALT_ext_sensors::ms8607_trigger (uint8_t m)
+	{
+	uint8_t		ret_val = ms8607_pt_step (m);
 
-			if (mux[m].installed_sensors)									// no sensor 2 without sensor 1
-				{
-				mux[m].ieep.set_addr16 (SENSOR2_PAGE_ADDR);						// point to page 2, address 0; this is [sensor 2] page
-				mux[m].ieep.control.rd_wr_len = PAGE_SIZE;						// set page size
-				mux[m].ieep.control.rd_buf_ptr = sensor2_page.as_array;			// point to destination buffer
-				mux[m].ieep.page_read ();										// read the page
-
-				if (strcmp (sensor2_page.as_struct.sensor_type, "TMP275"))
-					mux[m].installed_sensors |= TMP275;
-				else if (strcmp (sensor2_page.as_struct.sensor_type, "HDC1080"))
-					mux[m].installed_sensors |= HDC1080;
-				else if (strcmp (sensor2_page.as_struct.sensor_type, "MS8607PT"))
-					mux[m].installed_sensors = MS8607;
-				else if (strcmp (sensor2_page.as_struct.sensor_type, "MS8607H"))
-					mux[m].installed_sensors = MS8607;
-				else if (0xFF != *sensor2_page.as_struct.sensor_type)
-					Serial.printf ("unknown [sensor 2] type: %s\n", sensor1_page.as_struct.sensor_type);
-				else
-					Serial.printf ("[sensor 2] type not specified\n");
-				}
-// TODO: support for third 'sensor' because MS8607 is really two sensors
+	mux[m].hdc1080_pending = (SUCCESS == ms8607_cmd (m, MUX_MS8607_H_ADDR, MS8607_H_MEASURE));	// the humidity part is what the scans collect
+	if (!mux[m].hdc1080_pending)
+		ret_val = FAIL;
+	mux[m].hdc1080_trigger_us = micros();						// conversions start at the stop conditions
+	return ret_val;
+	}
 
-			// TODO: if tests on some value(s) stored in eeprom to determine which of the three sensors to use?
-			// If we do that just what is it that gets stored in eeprom?
-			// that same value will be used by the scanner to fetch sensor data
 
+//---------------------------< M U X _ F A U L T _ L O G >----------------------------------------------------
+//
+// Add exception idx and record it in the event log with the mux index.  Once an exception is queued, subsequent
+// faults with the same index are not logged.
+//
 
-//			Serial.printf ("installed_sensors: 0x%.2X\n", mux[m].installed_sensors);
+void SALT_ext_sensors::mux_fault_log (uint8_t idx, uint8_t m)
+	{
+	if (!e7n.e7n_msg[idx].queued)										// if not yet queued
+		{
+		e7n.exception_add (idx);
+		XLOG (XLOG_FAULT, XLOG_E7N, m, XLOG_NA, XLOG_NA, idx);			// log_drain() logs it
+		}
+	}
 
-			if (TMP275 & mux[m].installed_sensors)										// should we expect a 275?
-				{
-				if (SUCCESS != pingex (TMP275_SLAVE_ADDR_7, Wire1))						// can we ping it?
-					Serial.printf ("\tmux[%d] TMP275 specified but not detected\n", m);
-				else
-					{
-					mux[m].itmp275.setup (TMP275_SLAVE_ADDR_7, Wire1, (char*)"Wire1");	// initialize this sensor instance
-					mux[m].itmp275.begin (I2C_PINS_29_30, I2C_RATE_100);
-					if (SUCCESS != mux[m].itmp275.init (TMP275_CFG_RES12))
-						{
-						mux[m].itmp275.~Systronix_TMP275();								// destructor this instance
-						Serial.printf ("\tmux[%d] tmp275 init fail\n", m);
-						mux[m].installed_sensors &= ~TMP275;							// remove TMP275 from installed sensors
-						}
-					else
-						{
-						Serial.printf ("\tmux[%d] TMP275 initialized\n", m);
-						}
-					}
-				}
 
-			if (HDC1080 & mux[m].installed_sensors)											// should we expect a 1080?
-				{
-				if ((SUCCESS == pingex (0x40, Wire1)) && (SUCCESS == pingex (0x76, Wire1)))		// make sure we aren't accidentally talking to MS8607 TODO: use #defines for slave addresses
-					Serial.printf ("\tmux[%d] MS8607 detected; expected HDC1080\n", m);
-				else if (SUCCESS != pingex (0x40, Wire1))
-					Serial.printf ("\tmux[%d] HDC1080 specified but not detected\n", m);
-				else
-					{
-					mux[m].ihdc1080.setup (Wire1, (char*)"Wire1");							// initialize this sensor instance
-					mux[m].ihdc1080.begin (I2C_PINS_29_30, I2C_RATE_100);
-					if (SUCCESS != mux[m].ihdc1080.init (MODE_T_AND_H))						// temperature and humidity mode
-//					if (SUCCESS != mux[m].ihdc1080.init (0, TRIGGER_H))						// individual mode; humidity only
-						{
-						mux[m].ihdc1080.~Systronix_HDC1080();								// destructor this instance
-						Serial.printf ("\tmux[%d] HDC1080 init fail\n", m);
-						mux[m].installed_sensors &= ~HDC1080;								// remove HDC1080 from installed sensors
-						}
-					else
-						{
-						Serial.printf ("\tmux[%d] HDC1080 initialized\n", m);
-						}
-					}
-				}
+//---------------------------< X L O G >----------------------------------------------------------------------
+//
+// Record an event in the event log ring; when the ring is full the event is dropped and counted.  Use the XLOG()
+// macro so that events above the compile-time XLOG_LEVEL are compiled out.
+//
 
-			if (MS8607 & mux[m].installed_sensors)											// should we expect an MS8607?
-				{
-				if ((SUCCESS != pingex (0x40, Wire1)) || (SUCCESS != pingex (0x76, Wire1)))		//  TODO: use a #define for slave addresses
-					Serial.printf ("\tmux[%d] MS8607 specified but not detected\n", m);
-				else		// TODO: write enough library support to fill this in
-					{
-//					 MS8607 initialization code here
-//					 mux[m].ims8607.setup (Wire1, (char*)"Wire1");							// initialize this sensor instance
-//					 mux[m].ims8607.begin (I2C_PINS_29_30, I2C_RATE_100);
-//					 if (SUCCESS != mux[m].ims8607.init ())
-//						{
-//						mux[m].ims8607.~Systronix_MS8607();									// destructor this instance
-						Serial.printf ("\tmux[%d] MS8607 init fail\n", m);
-						mux[m].installed_sensors &= ~MS8607;								// remove MS8607 from installed sensors
-//						}
-//					else
-//						{
-//						mux[m].installed_sensors |= MS8607;									// note that we found and initialized MS8607
-//						Serial.printf ("\tmux[%d] MS8607 initialized\n", m);
-//						}
-					}
-				}
-			}
-		else
-			break;
+void SALT_ext_sensors::xlog (uint8_t code, uint8_t m, uint8_t p, uint8_t s, uint16_t status)
+	{
+	xlog_t*	event;
 
-		mux[m].imux.control_write (PCA9548A_PORTS_DISABLE);									// disable access to mux[m] ports so that multiple muxes aren't accessed in parallel
+	if (XLOG_SIZE == (uint8_t)(xlog_head - xlog_tail))				// full
+		{
+		xlog_dropped++;
+		return;
 		}
 
-	Serial.printf ("discovery done (%ldmS)\n", millis() - start);
-	return SUCCESS;
+	event = &xlog_ring[xlog_head & (XLOG_SIZE - 1)];
+	event->code = code;
+	event->m = m;
+	event->p = p;
+	event->s = s;
+	event->status = status;
+	xlog_head++;
 	}
 
 
-//---------------------------< S E N S O R _ S C A N >--------------------------------------------------------
+//---------------------------< L O G _ D R A I N >------------------------------------------------------------
 //
-// This function scans the sensors and calls each sensor's get_temperature_data() function to fill that sensor's
-// data struct.  Scanning begins at mux[0].port[0].sensor[0] and continues until all external sensors have been
-// queried.
-// TODO: what about the mux-mounted sensors on port[7]?  Because these are 'different', handle them elsewhere?
-// TODO: How to map physical sensor location to the electrical sensor location?
+// Format up to max events from the event log: exceptions go to logs.log_event(), everything else to Serial.
+// Call from loop() (or after sensor_discover()) when there is time to spare.  Returns the number of events
+// still queued.
 //
 
-uint8_t SALT_ext_sensors::sensor_scan (void)
+uint8_t SALT_ext_sensors::log_drain (uint8_t max)
 	{
-	uint8_t	m;				// indexer into mux
-	uint8_t	p;				// indexer into port
-	uint8_t	s;				// indexer into sensor
-
-	char log_msg[64];
+	xlog_t*	event;
+	char	log_msg[64];
 
-	for (m = 0; m < MAX_MUXES; m++)
+	for (; max && (xlog_tail != xlog_head); max--)
 		{
-//		Serial.printf ("mux[%d]", m);
-		if (!mux[m].has_sensors)										// does at least one port have sensors?
+		event = &xlog_ring[xlog_tail & (XLOG_SIZE - 1)];
+		xlog_tail++;
+
+		if (XLOG_E7N == event->code)
 			{
-//			Serial.printf ("\n");
-			break;														// this mux has no sensors, done
+			if (XLOG_NA == event->p)
+				sprintf (log_msg, "%s @ mux[%d]", (char*)e7n.e7n_msg [event->status].l, event->m);
+			else
+				sprintf (log_msg, "%s @ mux[%d].port[%d].sensor[%d]", (char*)e7n.e7n_msg [event->status].l, event->m, event->p, event->s);
+			logs.log_event (log_msg);									// log it
+			continue;
 			}
-		else															// there are sensors attached to this mux
-			{
-			for (p = 0; p < MAX_PORTS; p++)
-				{
-//				Serial.printf (".port[%d]", p);
-				if (!mux[m].port[p].has_sensors)						// does port[p] have at least one sensor?
-					{
-//					Serial.printf ("\n");
-					break;												// no sensors on this port, do next mux
-					}
-				else													// there are sensors on this port
-					{
-					mux[m].imux.control_write (mux[m].imux.port[p]);	// enable access to mux[m].port[p]
 
-					for (s = 0; s < MAX_SENSORS; s++)
-						{
-//						Serial.printf (".sensor[%d]\n", s);
-						if (0 == mux[m].port[p].sensor[s].addr)			// addr is non-zero when there is a sensor
-							{
-//							Serial.printf ("\n");
-							break;										// no more sensors on this port, next port
-							}
-						else											// there are (more) sensors
-							{
-							if (TMP275 == mux[m].port[p].sensor[s].type)
-								if (SUCCESS != mux[m].port[p].sensor[s].itmp275.get_data())	// attempt to get the sensor's data
-									{
-									if (!e7n.e7n_msg[E7N_EXT_TEMP_FAULT_IDX].queued)	// if not yet queued
-										{												// once any single sensor is queued other sensor faults not logged
-										e7n.exception_add (E7N_EXT_TEMP_FAULT_IDX);		// unable to read this sensor
-										sprintf (log_msg, "%s @ mux[%d].port[%d].sensor[%d]", (char*)e7n.e7n_msg [E7N_EXT_TEMP_FAULT_IDX].l, m, p, s);
-										logs.log_event (log_msg);						// log it
-										}
-									}
-							}
-						}
-					}
-				}
-			}
-		mux[m].imux.control_write (PCA9548A_PORTS_DISABLE);				// disable access to mux[m] ports so that multiple muxes aren't accessed in parallel
+		if (XLOG_NA != event->m)
+			Serial.printf ("\tmux[%d]", event->m);
+		if (XLOG_NA != event->p)
+			Serial.printf (".port[%d]", event->p);
+		if (XLOG_NA != event->s)
+			Serial.printf (".sensor[%d]", event->s);
+
+		if ((XLOG_MMS_NOT_DETECTED <= event->code) && (XLOG_MMS_INITIALIZED >= event->code))
+			Serial.printf (xlog_text[event->code], (TMP275 == event->status) ? "TMP275" : (HDC1080 == event->status) ? "HDC1080" : "MS8607");
+		else
+			Serial.printf (xlog_text[event->code], event->status);
+		Serial.printf ("\n");
 		}
 
-	for (m = 0; m < MAX_MUXES; m++)										// here we scan mux-mounted sensors
+	if (xlog_dropped && (xlog_tail == xlog_head))
 		{
-		if (mux[m].exists)												// on muxes that exist
-			{
-			if (SUCCESS != mux[m].imux.control_write (mux[m].imux.port[7]))		// enable access to mux[m].port[7]
-				{
-				if (!e7n.e7n_msg[E7N_MUX_FAULT_IDX].queued)				// if not yet queued
-					{
-					e7n.exception_add (E7N_MUX_FAULT_IDX);				// unable to set the multiplexer
-					sprintf (log_msg, "%s @ mux[%d]", (char*)e7n.e7n_msg [E7N_MUX_FAULT_IDX].l, m);
-					logs.log_event (log_msg);							// log it
-					}
-				break;													// serious problem if we can't switch the multiplexer  TODO: what to do?
-				}
-			if (mux[m].installed_sensors & TMP275)
-				if (SUCCESS != mux[m].itmp275.get_data())				// attempt to get the sensor's data
-					if (!e7n.e7n_msg[E7N_MUX_TSNSR_FAULT_IDX].queued)	// if not yet queued
-						{
-						e7n.exception_add (E7N_MUX_TSNSR_FAULT_IDX);	// unable to read this sensor
-						sprintf (log_msg, "%s @ mux[%d]", (char*)e7n.e7n_msg [E7N_MUX_TSNSR_FAULT_IDX].l, m);
-						logs.log_event (log_msg);						// log it
-						}
-
-			if (mux[m].installed_sensors & HDC1080)						// only one of these
-				if (SUCCESS != mux[m].ihdc1080.get_data())				// attempt to get the sensor's data
-					{
-					if (!e7n.e7n_msg[E7N_MUX_HSNSR_FAULT_IDX].queued)	// if not yet queued
-						{
-						e7n.exception_add (E7N_MUX_HSNSR_FAULT_IDX);	// unable to read this sensor
-						sprintf (log_msg, "%s @ mux[%d]", (char*)e7n.e7n_msg [E7N_MUX_HSNSR_FAULT_IDX].l, m);
-						logs.log_event (log_msg);						// log it
-						}
-					}
-// MS8607 NOT SUPPORTED; EXCEPTION HANDLING NOT SUPPORTED
-//			else if (mux[m].installed_sensors & MS8607)
-//				if (SUCCESS != mux[m].ims8607.get_data())				// attempt to get the sensor's data
-//					{
-//					if (!e7n.e7n_msg[E7N_MUX_THSNSR_FAULT_IDX].queued)	// if not yet queued
-//						{
-//						e7n.exception_add (E7N_MUX_THSNSR_FAULT_IDX);	// unable to read this sensor
-//						sprintf (log_msg, "%s @ mux[%d]", (char*)e7n.e7n_msg [E7N_MUX_THSNSR_FAULT_IDX].l, m);
-//						logs.log_event (log_msg);						// log it
-//						}
-//					}
-			mux[m].imux.control_write (PCA9548A_PORTS_DISABLE);			// disable access to mux[m] ports so that multiple muxes aren't accessed in parallel
-			}
+		Serial.printf ("%d events dropped\n", xlog_dropped);
+		xlog_dropped = 0;
 		}
 
-	return SUCCESS;
+	return (uint8_t)(xlog_head - xlog_tail);
 	}
 
 
@@ -489,9 +4029,11 @@ uint8_t SALT_ext_sensors::sensor_scan (void)
 uint8_t SALT_ext_sensors::show_sensor_temps (void)
 	{
 	static uint8_t	m=0;				// indexer into mux
-	static uint8_t	p=0;				// indexer into port
-	static uint8_t	s=0;				// indexer into sensor
+	static uint8_t	i=0;				// indexer into mux[m]'s sensor registry entries
 	static uint8_t	state = 0;
+	sensor_t*		sensor_ptr;
+	char			t_text[8];
+	char			rh_text[8];
 
 	if (!mux[0].exists)											// if no mux[0] we're done
 		{
@@ -503,7 +4045,7 @@ uint8_t SALT_ext_sensors::show_sensor_temps (void)
 	switch (state)
 		{
 		case 0:													// mux[m] sensors
-			if (!(mux[m].installed_sensors & (TMP275|HDC1080)))	// no supported sensors installed
+			if (!(mux[m].installed_sensors & (TMP275|RH_SENSORS)))	// no supported sensors installed
 				{
 				sprintf (utils.display_text, "m[%d] none", m);
 				utils.ui_display_update (HABITAT_A);
@@ -512,67 +4054,42 @@ uint8_t SALT_ext_sensors::show_sensor_temps (void)
 				}
 			else if (mux[m].installed_sensors & TMP275)			// TMP275; if not 275 fall through to state 1
 				{												// here when there is a 275 so display
-				sprintf (utils.display_text, "m[%d].s[0]       % 3.1f\xDF", m, mux[m].itmp275.data.deg_f);
+				centi_text (t_text, meas.centi_f[MEAS_MUX_TMP275 + m]);
+				sprintf (utils.display_text, "m[%d].s[0]       %s\xDF", m, t_text);
 				utils.ui_display_update (HABITAT_A);
-				if (mux[m].installed_sensors & HDC1080)			// when there is also an HDC1080
+				if (mux[m].installed_sensors & RH_SENSORS)		// when there is also an HDC1080 or MS8607
 					state = 1;									// next time state 1 to display temp & rh
 				else
 					state = 2;									// no HDC1080 so next time port sensors if any
 				break;
 				}
 
-		case 1:													// HDC1080 temperature and humidity
-				sprintf (utils.display_text, "m[%d].s[1]       % 3.1f\xDF  % 3.1f%%rh", m, mux[m].ihdc1080.data.deg_f, mux[m].ihdc1080.data.rh);
+		case 1:													// HDC1080 (or MS8607) temperature and humidity
+				centi_text (t_text, meas.centi_f[MEAS_MUX_HDC1080 + m]);
+				centi_text (rh_text, meas.centi_rh[m]);
+				sprintf (utils.display_text, "m[%d].s[1]       %s\xDF  %s%%rh", m, t_text, rh_text);
 				utils.ui_display_update (HABITAT_A);
 				state = 2;										// next time start on port sensors if any
 				break;
 
 		case 2:		// mux[m].port[p].sensor[s]
-			if (mux[m].port[p].has_sensors)						// does port[p] have at least one sensor?
+			if (i < mux[m].sensor_count)						// does mux[m] have (more) port sensors?
 				{
-				if (0 != mux[m].port[p].sensor[s].addr)			// this sensor present?
-					{
-					sprintf (utils.display_text, "m[%d].p[%d].s[%d]  % 3.1f\xDF", m, p, s, mux[m].port[p].sensor[s].itmp275.data.deg_f);
-					utils.ui_display_update (HABITAT_A);		// display sensor temp
-					s++;										// next sensor
-					if (0 == mux[m].port[p].sensor[s].addr)		// does it exist?
-						{
-						s = 0;									// no, reset
-						p++;									// next port
-						if (mux[m].port[p].has_sensors)			// does it have sensors?
-							break;								// yes
-						else
-							{
-							p = 0;								// no, reset
-							m++;								// next mux
-							if (!mux[m].exists)					// is there a next mux?
-								m=0;							// no, reset
-							state = 0;							// start over
-							break;
-							}
-						}
-					}
-				else											// should never get here; port[p] has sensors but no sensor[0] address
-					{
-					sprintf (utils.display_text, "m[%d].p[%d].s[%d]  no sensor err", m, p, s);
-					utils.ui_display_update (HABITAT_A);		// display error message
-					m=0;										// reset and restart
-					p=0;
-					s=0;
-					state=0;
+				sensor_ptr = &sensor[mux[m].sensor_first + i];
+				centi_text (t_text, meas.centi_f[mux[m].sensor_first + i]);
+				sprintf (utils.display_text, "m[%d].p[%d].s[%d]  %s\xDF", m, sensor_ptr->p, sensor_ptr->s, t_text);
+				utils.ui_display_update (HABITAT_A);			// display sensor temp
+				i++;											// next sensor
+				if (i < mux[m].sensor_count)
 					break;
-					}
-				}
-			else												// port[p] has no sensors
-				{
-				s = 0;											// reset
-				p = 0;
-				m++;											// next mux
-				if (!mux[m].exists)
-					m = 0;										// no next mux, reset
-				state = 0;
-				break;
 				}
+
+			i = 0;												// no more sensors on mux[m]; reset
+			m++;												// next mux
+			if ((MAX_MUXES <= m) || !mux[m].exists)				// is there a next mux?
+				m = 0;											// no, reset
+			state = 0;											// start over
+			break;
 		}
 
 	return SUCCESS;
@@ -586,8 +4103,11 @@ uint8_t SALT_ext_sensors::show_sensor_temps (void)
 
 Systronix_TMP275::data_t* SALT_ext_sensors::tmp275_data_ptr_get (uint8_t m, uint8_t p, uint8_t s)
 	{
-	if (mux[m].port[p].sensor[s].addr)								// if there is a sensor at this location
-		return &mux[m].port[p].sensor[s].itmp275.data;				// return a pointer to the data struct
+	for (uint8_t i = 0; i < sensor_count; i++)
+		{
+		if ((m == sensor[i].m) && (p == sensor[i].p) && (s == sensor[i].s))	// if there is a sensor at this location
+			return &sensor[i].itmp275.data;							// return a pointer to the data struct
+		}
 	return NULL;													// NULL pointer else
 	}
 
@@ -617,3 +4137,234 @@ Systronix_HDC1080::data_t* SALT_ext_sensors::mux_hdc1080_data_ptr_get (uint8_t m
 	return NULL;													// NULL pointer else
 	}
 
+
+//---------------------------< M U X _ M S 8 6 0 7 _ D A T A _ P T R _ G E T >--------------------------------
+//
+// returns the address of the mux-mounted MS8607 sensor's data struct (pressure, temperature and rh) or NULL
+//
+
+SALT_ext_ms8607::data_t* SALT_ext_sensors::mux_ms8607_data_ptr_get (uint8_t m)
+	{
+	if ((MAX_MUXES > m) && (mux[m].installed_sensors & MS8607))		// if there is a sensor at this location
+		return &mux[m].ims8607.data;								// return a pointer to the data struct
+	return NULL;													// NULL pointer else
+	}
+
+
+//---------------------------< M E A S _ C H A N N E L _ G E T >----------------------------------------------
+//
+// returns the meas channel of mux[m].port[p].sensor[s]; port 7 is the mux-mounted sensors: sensor 0 the TMP275
+// and sensor 1 the HDC1080 (or MS8607).  Returns MEAS_NONE when there is no such sensor.
+//
+
+uint8_t SALT_ext_sensors::meas_channel_get (uint8_t m, uint8_t p, uint8_t s)
+	{
+	if (MAX_MUXES <= m)
+		return MEAS_NONE;
+
+	if (7 == p)
+		{
+		if ((0 == s) && (mux[m].installed_sensors & TMP275))
+			return MEAS_MUX_TMP275 + m;
+		if ((1 == s) && (mux[m].installed_sensors & RH_SENSORS))
+			return MEAS_MUX_HDC1080 + m;
+		return MEAS_NONE;
+		}
+
+	for (uint8_t i = 0; i < sensor_count; i++)
+		{
+		if ((m == sensor[i].m) && (p == sensor[i].p) && (s == sensor[i].s))	// if there is a sensor at this location
+			return i;
+		}
+	return MEAS_NONE;
+	}
+
+
+//---------------------------< H I S T O R Y _ W I N D O W _ S E T >------------------------------------------
+//
+// set window w of every sensor channel's history to cover the most recent len samples
+//
+
+void SALT_ext_sensors::history_window_set (uint8_t w, uint8_t len)
+	{
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		{
+		mux[m].tmp275_history.window_set (w, len);
+		mux[m].hdc1080_t_history.window_set (w, len);
+		mux[m].hdc1080_rh_history.window_set (w, len);
+		}
+	for (uint8_t i = 0; i < MAX_REG_SENSORS; i++)
+		sensor[i].history.window_set (w, len);
+	}
+
+
+//---------------------------< T M P 2 7 5 _ H I S T O R Y _ P T R _ G E T >----------------------------------
+//
+// returns the address of a TMP275 sensor's temperature history or NULL
+//
+
+SALT_ext_history* SALT_ext_sensors::tmp275_history_ptr_get (uint8_t m, uint8_t p, uint8_t s)
+	{
+	for (uint8_t i = 0; i < sensor_count; i++)
+		{
+		if ((m == sensor[i].m) && (p == sensor[i].p) && (s == sensor[i].s))	// if there is a sensor at this location
+			return &sensor[i].history;
+		}
+	return NULL;
+	}
+
+
+//---------------------------< M U X _ T M P 2 7 5 _ H I S T O R Y _ P T R _ G E T >--------------------------
+//
+// returns the address of the mux-mounted TMP275 sensor's temperature history or NULL
+//
+
+SALT_ext_history* SALT_ext_sensors::mux_tmp275_history_ptr_get (uint8_t m)
+	{
+	if ((MAX_MUXES > m) && (mux[m].installed_sensors & TMP275))
+		return &mux[m].tmp275_history;
+	return NULL;
+	}
+
+
+//---------------------------< M U X _ H D C 1 0 8 0 _ T _ H I S T O R Y _ P T R _ G E T >--------------------
+//
+// returns the address of the mux-mounted HDC1080 (or MS8607) sensor's temperature history or NULL
+//
+
+SALT_ext_history* SALT_ext_sensors::mux_hdc1080_t_history_ptr_get (uint8_t m)
+	{
+	if ((MAX_MUXES > m) && (mux[m].installed_sensors & RH_SENSORS))
+		return &mux[m].hdc1080_t_history;
+	return NULL;
+	}
+
+
+//---------------------------< M U X _ H D C 1 0 8 0 _ R H _ H I S T O R Y _ P T R _ G E T >------------------
+//
+// returns the address of the mux-mounted HDC1080 (or MS8607) sensor's humidity history or NULL
+//
+
+SALT_ext_history* SALT_ext_sensors::mux_hdc1080_rh_history_ptr_get (uint8_t m)
+	{
+	if ((MAX_MUXES > m) && (mux[m].installed_sensors & RH_SENSORS))
+		return &mux[m].hdc1080_rh_history;
+	return NULL;
+	}
+
+
+//---------------------------< I S T A T S _ P T R _ G E T >--------------------------------------------------
+//
+// returns a pointer to the transfer counters of mux[m].port[p].sensor[s] (see meas_channel_get()); NULL when there
+// is no such sensor
+//
+
+SALT_ext_istats* SALT_ext_sensors::istats_ptr_get (uint8_t m, uint8_t p, uint8_t s)
+	{
+	uint8_t	n = meas_channel_get (m, p, s);
+
+	return (MEAS_NONE == n) ? NULL : &istats[n];
+	}
+
+
+//---------------------------< M U X _ I S T A T S _ P T R _ G E T >------------------------------------------
+//
+// returns a pointer to the transfer counters of the mux[m] control register; NULL when m is out of range
+//
+
+SALT_ext_istats* SALT_ext_sensors::mux_istats_ptr_get (uint8_t m)
+	{
+	return (MAX_MUXES > m) ? &mux_istats[m] : NULL;
+	}
+
+
+//---------------------------< E E P _ I S T A T S _ P T R _ G E T >------------------------------------------
+//
+// returns a pointer to the transfer counters of the mux[m] eeprom; NULL when m is out of range
+//
+
+SALT_ext_istats* SALT_ext_sensors::eep_istats_ptr_get (uint8_t m)
+	{
+	return (MAX_MUXES > m) ? &eep_istats[m] : NULL;
+	}
+
+
+//---------------------------< I S T A T S _ C L E A R >------------------------------------------------------
+
+void SALT_ext_sensors::istats_clear (void)
+	{
+	for (uint8_t n = 0; n < MEAS_CHANNELS; n++)
+		istats[n].clear ();
+	for (uint8_t m = 0; m < MAX_MUXES; m++)
+		{
+		mux_istats[m].clear ();
+		eep_istats[m].clear ();
+		memset (rate_stats[m].transfers, 0, sizeof(rate_stats[m].transfers));
+		memset (rate_stats[m].errors, 0, sizeof(rate_stats[m].errors));
+		}
+	memset (&scan_time, 0, sizeof(scan_time));
+	}
+
+
+//---------------------------< I S T A T S _ L I N E >--------------------------------------------------------
+//
+// istats_dump() line for one location: transfers, bytes, nacks, timeouts, max and the latency histogram.  Here
+// and in istats_dump() uint32_t values print as (unsigned long) with %lu: uint32_t is unsigned long on the Teensy
+// and unsigned int on the host.
+//
+
+static void istats_line (const char* where, SALT_ext_istats* istats_ptr)
+	{
+	if (!istats_ptr->transfers)
+		return;
+
+	Serial.printf ("%-16s n %lu b %lu nak %u to %u max %luuS |", where, (unsigned long)istats_ptr->transfers,
+		(unsigned long)istats_ptr->bytes, istats_ptr->naks, istats_ptr->timeouts, (unsigned long)istats_ptr->max_us);
+	for (uint8_t b = 0; b < ISTATS_BUCKETS; b++)
+		Serial.printf (" %u", istats_ptr->hist[b]);
+	Serial.printf ("\n");
+	}
+
+
+//---------------------------< I S T A T S _ D U M P >--------------------------------------------------------
+//
+// Print scan_time, one line per location that has had transfers, and each mux branch's rate and its scan pass
+// transfers and errors at each auto rate step:
+//	m[0]             n 48 b 48 nak 0 to 0 max 203uS | 0 48 0 0 0 0 0 0
+//	m[0] rate         400kHz up 1 down 0 | 100kHz n 256 err 0 400kHz n 912 err 1 1000kHz n 0 err 0
+// hist bucket b counts transfers shorter than ISTATS_BUCKET0_US << b; the last bucket, the rest.  Mux-mounted
+// sensors are port 7: sensor 0 the TMP275, sensor 1 the HDC1080.
+//
+
+void SALT_ext_sensors::istats_dump (void)
+	{
+	char	where[24];
+
+	Serial.printf ("scans %lu last %luuS max %luuS mean %luuS; hist buckets from %duS\n", (unsigned long)scan_time.passes,
+		(unsigned long)scan_time.last_us, (unsigned long)scan_time.max_us,
+		scan_time.passes ? (unsigned long)(scan_time.total_us / scan_time.passes) : 0UL, ISTATS_BUCKET0_US);
+
+	for (uint8_t m = 0; (m < MAX_MUXES) && mux[m].exists; m++)
+		{
+		sprintf (where, "m[%d]", m);
+		istats_line (where, &mux_istats[m]);
+		Serial.printf ("m[%d] rate         %lukHz up %d down %d |", m, (unsigned long)rate_stats[m].hz / 1000,
+			rate_stats[m].ups, rate_stats[m].downs);
+		for (uint8_t r = 0; r < RATE_STEPS; r++)
+			Serial.printf (" %lukHz n %lu err %lu", (unsigned long)rate_steps[r] / 1000,
+				(unsigned long)rate_stats[m].transfers[r], (unsigned long)rate_stats[m].errors[r]);
+		Serial.printf ("\n");
+		sprintf (where, "m[%d] eep", m);
+		istats_line (where, &eep_istats[m]);
+		sprintf (where, "m[%d].p[7].s[0]", m);
+		istats_line (where, &istats[MEAS_MUX_TMP275 + m]);
+		sprintf (where, "m[%d].p[7].s[1]", m);
+		istats_line (where, &istats[MEAS_MUX_HDC1080 + m]);
+		for (uint8_t i = mux[m].sensor_first; i < (mux[m].sensor_first + mux[m].sensor_count); i++)
+			{
+			sprintf (where, "m[%d].p[%d].s[%d]", m, sensor[i].p, sensor[i].s);
+			istats_line (where, &istats[i]);
+			}
+		}
+	}
+
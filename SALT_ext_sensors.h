@@ -15,6 +15,7 @@
 #include <SALT_exceptions.h>
 #include <SALT_utilities.h>
 #include <SALT_logging.h>
+#include <EEPROM.h>
 
 
 //---------------------------< D E F I N E S >----------------------------------------------------------------
@@ -42,12 +43,169 @@
 #define	MAX_MUXES		2		// habitat A (with EC if attached) and habitat B
 #define	MAX_PORTS		6		// per habitat: B2B (3), SBS & SS (4), B2BWEC (5), SSWEC (6); port[7] mux mounted sensors not handled here
 #define	MAX_SENSORS		3		// per port one sensor per compartment
+#ifndef	MAX_REG_SENSORS
+#define	MAX_REG_SENSORS	16		// port sensor registry entries; all muxes together
+#endif
 
 #define	MUX_EEP_ADDR	0x57	// mux-mounted sensor eeprom has fixed address
 
+#define	TOPOLOGY_VERSION		2		// change when topology_t or its meaning changes
+#ifndef	TOPOLOGY_EEP_ADDR
+#define	TOPOLOGY_EEP_ADDR		(E2END + 1 - sizeof (SALT_ext_sensors::topology_t))	// top of Teensy EEPROM
+#endif
+
+#define	SCAN_BUSY				0xFE	// scan_poll() return value: scan pass is in progress; call again
+#define	SCAN_WAIT				0xFD	// scan_step() return value: waiting on a sensor conversion; no bus work done
+#define	SCAN_SLICE_DEFAULT_US	2000	// default max time (µs) that one scan_poll() call may spend on bus work
+#define	SCAN_NO_PORT			0xFF	// scan.p value: no port sensor port enabled
+#define	MMS_HDC1080_NONE		0		// scan_mms_plan() return values: mux humidity part not read this pass
+#define	MMS_HDC1080_TRIGGER		1		// no conversion pending: start one on the port[7] visit
+#define	MMS_HDC1080_READ		2		// conversion complete: read it and start the next on the port[7] visit
+#define	MMS_HDC1080_LATER		3		// conversion in progress: collect it at the end of the pass
+#define	HOTPLUG_SLICE_DEFAULT_US	1000	// default max time (µs) that hot-plug probing may add to the end of a scan pass
+#define	HOTPLUG_SLOTS			(MAX_MUXES * MAX_PORTS * MAX_SENSORS)	// port sensor slots that hot-plug probing goes round
+
+#define	MUX_HDC1080_ADDR		0x40	// mux-mounted HDC1080 has fixed address
+#define	MUX_HDC1080_TRIG_PTR	0x00	// writing the temperature register address to the pointer register triggers a conversion
+#define	MUX_MS8607_PT_ADDR		0x76	// mux-mounted MS8607 pressure and temperature part has fixed address
+#define	MUX_MS8607_H_ADDR		0x40	// mux-mounted MS8607 humidity part shares the HDC1080 address
+
+#define	MS8607_PT_RESET			0x1E	// MS8607 pressure and temperature part commands
+#define	MS8607_PT_PROM			0xA0	// read PROM word n at 0xA0 + 2n: word 0 holds the CRC, words 1 .. 6 C1 .. C6
+#define	MS8607_PT_CONV_P		0x40	// start a pressure (D1) conversion at oversampling ratio osr: + (2 * osr)
+#define	MS8607_PT_CONV_T		0x50	// start a temperature (D2) conversion: + (2 * osr)
+#define	MS8607_PT_ADC			0x00	// read the 24-bit result of the last conversion; 0 while converting
+#define	MS8607_H_RESET			0xFE	// MS8607 humidity part commands
+#define	MS8607_H_USER_READ		0xE7	// user register: resolution in bits 7 and 0
+#define	MS8607_H_USER_WRITE		0xE6
+#define	MS8607_H_MEASURE		0xF5	// start a humidity conversion, no hold master; the part nacks its read address until done
+
+#define	MS8607_OSR_256			0		// ms8607_osr_set() values: pressure and temperature oversampling ratio; the
+#define	MS8607_OSR_512			1		// humidity resolution follows it (see ms8607_osrs[] in SALT_ext_sensors.cpp)
+#define	MS8607_OSR_1024			2
+#define	MS8607_OSR_2048			3
+#define	MS8607_OSR_4096			4
+#define	MS8607_OSR_8192			5
+#define	MS8607_OSRS				6
+#ifndef	MS8607_OSR_DEFAULT
+#define	MS8607_OSR_DEFAULT		MS8607_OSR_4096	// 8.61mS pressure, 9mS 11-bit humidity: inside an HDC1080 conversion time
+#endif
+
+#define	MMS_EEP					1		// mux-mounted presence bitmap bits; order matches mms_addrs[] in SALT_ext_sensors.cpp
+#define	MMS_TMP275				(1<<1)
+#define	MMS_HDC1080				(1<<2)
+#define	MMS_MS8607_H			MMS_HDC1080		// same address; MS8607 is distinguished by MMS_MS8607_PT
+#define	MMS_MS8607_PT			(1<<3)
+#define	MMS_ADDRS				4		// number of addresses in mms_addrs[]
+
+#ifndef	XLOG_LEVEL
+#define	XLOG_LEVEL				XLOG_DETAIL	// compile-time verbosity: events above this level are compiled out; production builds use XLOG_FAULT
+#endif
+#define	XLOG_FAULT				0		// exceptions; always recorded and always drained to logs.log_event()
+#define	XLOG_INFO				1		// discovery summary and configuration problems
+#define	XLOG_DETAIL				2		// per-device detected / not detected / initialized
+#ifndef	XLOG_SIZE
+#define	XLOG_SIZE				64		// event ring entries; must be a power of 2 no larger than 128
+#endif
+#define	XLOG_NA					0xFF	// xlog m, p or s value when the event doesn't apply to a mux, port or sensor
+
+// record an event at compile-time verbosity level; compiles to nothing when level is above XLOG_LEVEL
+#define	XLOG(level, code, m, p, s, status)	do {if ((level) <= XLOG_LEVEL) xlog ((code), (m), (p), (s), (status));} while (0)
+
+#define	HDC1080_CONV_TIME_US	15000	// MODE_T_AND_H: 6.35mS temp + 6.5mS rh conversions plus margin; HDC1080 nacks reads before this
+
+#define	MEAS_MUX_TMP275			MAX_REG_SENSORS					// meas channel of the mux[m] TMP275 is MEAS_MUX_TMP275 + m; port sensors are 0 ..
+#define	MEAS_MUX_HDC1080		(MAX_REG_SENSORS + MAX_MUXES)	// meas channel of the mux[m] HDC1080 (or MS8607) is MEAS_MUX_HDC1080 + m
+#define	MEAS_CHANNELS			(MAX_REG_SENSORS + (2 * MAX_MUXES))
+#define	MEAS_NONE				0xFF	// meas_channel_get() return value: no sensor at that location
+
+#if 32 < MEAS_CHANNELS
+#error	MEAS_CHANNELS too large for the 32-bit meas.valid and raw_fresh bitmaps
+#endif
+
+#ifndef	POLL_INTERVAL_MAX
+#define	POLL_INTERVAL_MAX		8		// adaptive polling: most scan passes between reads of a steady sensor; 1 .. 128
+#endif
+#define	POLL_DEADBAND_C_DEFAULT		10	// adaptive polling: change in hundredths of a °C that puts a sensor back on every pass
+#define	POLL_DEADBAND_RH_DEFAULT	50	// .. in hundredths of a %RH
+#define	POLL_BITS(bytes)		(2 + (9 * ((bytes) + 1)))	// bus bit times of one transfer: start, address, bytes, stop
+
+#ifndef	HEALTH_FAILS_MAX
+#define	HEALTH_FAILS_MAX		3		// consecutive failures before a sensor or mux is backed off
+#endif
+#ifndef	HEALTH_BACKOFF_MAX
+#define	HEALTH_BACKOFF_MAX		64		// most scan passes between recovery probes of a failing sensor or mux; 2 .. 128
+#endif
+
+#ifndef	THRESH_MAX
+#define	THRESH_MAX				16		// threshold subscriptions (thresh_add()); 1 .. 254
+#endif
+#define	THRESH_NONE				0xFF	// thresh_add() return value: no subscription made
+#define	THRESH_C				0		// thresh_add() quantities: temperature in hundredths of a °C
+#define	THRESH_RH				1		// .. humidity in hundredths of a %RH; mux HDC1080 (or MS8607) only (p = 7, s = 1)
+#define	THRESH_PA				2		// .. pressure in Pa; mux MS8607 only (p = 7, s = 1)
+#define	THRESH_NO_HIGH			INT32_MAX	// thresh_add() high and low values that never cross
+#define	THRESH_NO_LOW			INT32_MIN
+#define	THRESH_IN				0		// thresh_t state values: between the limits
+#define	THRESH_ABOVE			1		// .. above high, until back below high - hyst
+#define	THRESH_BELOW			2		// .. below low, until back above low + hyst
+
+#define	RATE_STEPS				3		// auto rate ladder (rate_steps[]): I2C_RATE_100, I2C_RATE_400, I2C_RATE_1000
+#ifndef	RATE_AUTO_MAX
+#define	RATE_AUTO_MAX			1		// highest step a mux branch may climb to; the PCA9548A, HDC1080 and MS8607 are 400kHz
+#endif									// parts so 2 (1MHz) only for branches of faster parts
+#ifndef	RATE_WINDOW
+#define	RATE_WINDOW				256		// auto rate: scan pass transfers per error window
+#endif
+#ifndef	RATE_ERRORS_MAX
+#define	RATE_ERRORS_MAX			4		// auto rate: errors in one window that step the branch down; fewer is a clean window
+#endif
+#ifndef	RATE_HOLD_MAX
+#define	RATE_HOLD_MAX			64		// auto rate: most clean windows before retrying the step a branch fell from; 1 .. 128
+#endif
+
 #define	TMP275			1		// bit fields used in installed_sensors
 #define	MS8607			(1<<1)	// these two mutually exclusive because they share an i2c slave address
 #define	HDC1080			(1<<2)
+#define	RH_SENSORS		(HDC1080 | MS8607)	// the mux humidity part: MEAS_MUX_HDC1080 channel, triggered and collected by the scans
+
+
+//---------------------------< T E L E M E T R Y   R E C O R D >----------------------------------------------
+//
+// With a sink set (telemetry_sink_set()) each scan pass is written as one binary record.  Multi-byte fixed fields
+// are little-endian; varint fields are 7 bits per byte, low bits first, msb set on every byte but the last; signed
+// values are zigzag coded (0, -1, 1, -2 .. as 0, 1, 2, 3 ..) before the varint.
+//	magic		1 byte		TELEMETRY_MAGIC
+//	flags		1 byte		TELEMETRY_VERSION in bits 7..4; TELEMETRY_KEY in bit 0
+//	length		2 bytes		of the whole record, magic to check
+//	ms			4 bytes		millis() at the end of the pass
+//	present		varint		bit n set for each meas channel that has a sensor; one entry each, by channel
+//	valid		varint		status bitmaps, by channel: holds a reading ..
+//	fresh		varint		.. read this pass ..
+//	failed		varint		.. read failed this pass
+//	key records only:
+//		reg		1 byte		MAX_REG_SENSORS and MAX_MUXES: the meas channel layout (see MEAS_xxx)
+//		muxes	1 byte
+//		where	2 bytes		per port sensor channel: m, then (p << 4) | s
+//	entries:
+//		centi_c	varint		signed: change in hundredths of a °C since the previous record; key records: the value
+//		centi_rh varint		mux humidity channels only: the same for hundredths of a %RH ..
+//		pa		varint		.. and for Pa (0: no MS8607)
+//	check		1 byte		ones complement of the sum of all preceding bytes
+// A record is a key record every TELEMETRY_KEY_INTERVAL records, when present changes (discovery, hot-plug),
+// and after telemetry_sink_set() or telemetry_key().  A decoder starts at a key record and can resynchronize at
+// the next one; extras/host_sim/telemetry_decode.cpp converts a stream to CSV.
+//
+
+#define	TELEMETRY_MAGIC			0xB5
+#define	TELEMETRY_VERSION		1
+#define	TELEMETRY_KEY			1		// flags bit: absolute values; channel locations follow the status bitmaps
+#ifndef	TELEMETRY_KEY_INTERVAL
+#define	TELEMETRY_KEY_INTERVAL	64		// most records from one key record to the next
+#endif
+#define	TELEMETRY_RECORD_MAX	(8 + (4 * 5) + 2 + (2 * MAX_REG_SENSORS) + (3 * MEAS_CHANNELS) + (8 * MAX_MUXES) + 1)	// longest record
+
+typedef void (*telemetry_sink_t) (const uint8_t* record, uint16_t len, void* ctx);	// append one record; runs inside the scan pass
 
 
 //---------------------------< E E P R O M   M E M O R Y   M A P S >------------------------------------------
@@ -69,25 +227,27 @@
 // These defines are common to all sensor and mux assemblies
 //
 
-//#define ASSEMBLY_TYPE			0x0000	// 16 bytes ascii text (A-Z,0-9, and '_') '\0' filled
+#define ASSEMBLY_TYPE			0x0000	// 16 bytes ascii text (A-Z,0-9, and '_') '\0' filled
 
-//#define	ASSEMBLY_REV			0x0010	// uint16 size board revision; upper byte is major (M), lower is minor (m) so: M.m
+#define	ASSEMBLY_REV			0x0010	// uint16 size board revision; upper byte is major (M), lower is minor (m) so: M.m
 //#define	ASSEMBLY_REV_MINOR		0x0010	// minor part (mm) of MM.mm board revision where mm can be 0 to 99 (uint16_t 0xMMmm)
 //#define	ASSEMBLY_REV_MAJOR		0x0011	// major part (MM) of MM.mm board revision where MM can be 0 to 99 (uint16_t 0xMMmm)
 
-//#define	ASSEMBLY_MANUF_DATE		0x0012	// uint32_t date of manufacture; a time_t value
+#define	ASSEMBLY_MANUF_DATE		0x0012	// uint32_t date of manufacture; a time_t value
 //#define	ASSEMBLY_MANUF_DATE_LO	0x0012	// low byte
 //#define	ASSEMBLY_MANUF_DATE_ML	0x0013	//
 //#define	ASSEMBLY_MANUF_DATE_MH	0x0014	//
 //#define	ASSEMBLY_MANUF_DATE_HI	0x0015	// date of manufacture high byte
 
-//#define	ASSEMBLY_SERV_DATE		0x0016	// uint32_t date of last service; a time_t value
+#define	ASSEMBLY_SERV_DATE		0x0016	// uint32_t date of last service; a time_t value
 //#define	ASSEMBLY_SERV_DATE_LO	0x0016	// low byte
 //#define	ASSEMBLY_SERV_DATE_ML	0x0017	//
 //#define	ASSEMBLY_SERV_DATE_MH	0x0018	//
 //#define	ASSEMBLY_SERV_DATE_HI	0x0019	// date of last service high byte
 
-// 0x001A-0x001F (six bytes) not defined
+#define	ASSEMBLY_PORTS			0x001A	// uint8_t number of ports installed (mux assemblies)
+
+// 0x001B-0x001F (five bytes) not defined
 
 // mux-mounted eeprom page size
 
@@ -98,6 +258,10 @@
 #define		SENSOR1_PAGE_ADDR	ASSY_PAGE_ADDR+PAGE_SIZE
 #define		SENSOR2_PAGE_ADDR	SENSOR1_PAGE_ADDR+PAGE_SIZE
 
+// mux-mounted eeprom descriptor: the [assembly] page and the [sensor n] pages that follow it, read at discovery
+#define		EEP_DESC_PAGES		4		// [assembly] + up to three [sensor n] pages; an MS8607 takes two
+#define		EEP_DESC_BULK		3		// pages fetched by the first read; later pages only while they hold a type
+
 
 //----------< S E N S O R >----------
 
@@ -116,6 +280,260 @@
 
 // 0x0011-0x001F (15 bytes) not defined
 
+// port sensor nodes: the [sensor 1] page at SENSOR1_BASE of the node eeprom selects the driver
+#define	PORT_DRIVERS			1		// entries in port_drivers[] in SALT_ext_sensors.cpp
+#define	PORT_DRIVER_TMP275		0		// port_drivers[] index; also used for nodes without a readable [sensor 1] page
+
+
+//---------------------------< T R A N S A C T I O N   Q U E U E >--------------------------------------------
+//
+// Non-blocking i2c transaction engine for one bus; each SALT_ext_bus has one.  Work is queued as groups of up to
+// XQ_OPS transfers (typically mux select, sensor reads, mux disable) that run back-to-back with no other traffic
+// in between.  Each transfer is started with the i2c_t3 non-blocking calls (sendTransmission(), sendRequest()) so
+// the transfer itself runs from the i2c_t3 ISR or DMA; poll() checks for completion, starts the next transfer,
+// and calls a group's done() callback when its last transfer completes.  poll() and the callbacks run in the
+// caller's context (loop()), not in the ISR.
+//
+// While groups are queued the engine owns the bus: blocking driver calls on the same bus must wait until
+// pending() returns 0 (or call flush()).  Queues on different buses run independently of each other.
+//
+
+#define	XQ_SIZE					32		// group ring entries; must be a power of 2 no larger than 128
+#define	XQ_OPS					5		// max transfers per group
+#define	XQ_DATA					4		// max bytes written or read per transfer
+
+#define	XQ_REQUIRED				1		// op flag: when this transfer fails, skip the rest of the group ...
+#define	XQ_ALWAYS				2		// op flag: ... except transfers flagged XQ_ALWAYS (mux disable)
+
+#define	XQ_TAG_DISABLE			0xFF	// scan_async() group tag port for mux disable groups; port 7 is mux-mounted sensors
+
+#if (MAX_MUXES * (MAX_PORTS + 3)) > XQ_SIZE			// per mux: disable, mux-mounted sensors, ms8607 pressure and temperature, ports
+#error	XQ_SIZE too small for one scan_async() pass
+#endif
+
+class SALT_ext_bus;
+
+class SALT_ext_xq
+	{
+	public:
+		struct group_t;
+		typedef void (*done_t) (group_t* group);			// completion callback
+
+		struct op_t
+			{
+			uint8_t		addr;								// slave address
+			uint8_t		len;								// bytes to write or read
+			boolean		read;								// true: read len bytes into data; false: write len bytes from data
+			uint8_t		flags;								// XQ_REQUIRED, XQ_ALWAYS
+			uint8_t		status;								// SUCCESS or FAIL (failed or skipped) when done() is called
+			uint8_t		data[XQ_DATA];
+			boolean		started;							// false when skipped
+			uint8_t		bus_status;							// i2c_t3 status() at completion
+			uint32_t	us;									// micros() from start to when poll() saw it complete
+			};
+
+		struct group_t
+			{
+			op_t		op[XQ_OPS];
+			uint8_t		ops;								// number of ops queued
+			uint8_t		status;								// SUCCESS when every op succeeded
+			done_t		done;								// called from poll() when the group is complete; may be NULL
+			void*		ctx;								// caller's context for done()
+			uint16_t	tag;								// caller's identifier for done()
+			const uint32_t*	rate;							// bus rate for the group's transfers, read when it starts; NULL: as is
+			};
+
+		struct stats_t
+			{
+			uint32_t	groups;								// groups completed
+			uint32_t	failed;								// groups completed with at least one failed op
+			uint32_t	transfers;							// transfers started
+			uint32_t	full;								// group_new() calls refused because the ring was full
+			} stats;
+
+		SALT_ext_xq (SALT_ext_bus& bus) : bus (bus) {}
+
+		group_t*	group_new (done_t done, void* ctx, uint16_t tag, const uint32_t* rate = NULL);	// returns NULL when the ring is full
+		uint8_t		write (group_t* group, uint8_t addr, const uint8_t* data, uint8_t len, uint8_t flags = 0);
+		uint8_t		read (group_t* group, uint8_t addr, uint8_t len, uint8_t flags = 0);
+		void		submit (group_t* group);				// queue the group that group_new() returned
+		uint8_t		poll (void);							// advance the engine; returns pending()
+		uint8_t		pending (void) {return (uint8_t)(tail - head);}	// groups submitted and not yet done
+		void		flush (void);							// poll() until nothing is pending
+
+	private:
+		SALT_ext_bus&	bus;
+		group_t		ring[XQ_SIZE];
+		uint8_t		head = 0;								// group in progress
+		uint8_t		tail = 0;								// next free entry
+		uint8_t		op = 0;									// op of ring[head] in progress or next to start
+		boolean		active = false;							// op has been started and is on the bus
+		uint32_t	start_us;								// micros() when op was started
+	};
+
+
+//---------------------------< B U S   H A N D L E >----------------------------------------------------------
+//
+// Lightweight handle to one of the i2c_t3 buses.  It holds a reference to the bus driver so that it (and the
+// driver) can be passed by reference instead of copying the whole i2c_t3 object on every call, the pins and rate
+// that the sensor drivers' begin() is given, and the bus's transaction queue.  rate_apply() changes the bus
+// rate only when it differs from the one last set, so each mux branch can run at its own rate.  SALT_ext_sensors puts every mux on
+// its own Wire1 handle unless mux_bus_set() assigns the mux to another one:
+//
+//	SALT_ext_bus	habitat_b_bus {Wire2, "Wire2", I2C_PINS_3_4};
+//	setup():	ext_sensors.mux_bus_set (1, habitat_b_bus);		// before sensor_discover()
+//
+
+class SALT_ext_bus
+	{
+	public:
+		SALT_ext_bus (i2c_t3& wire, const char* name, i2c_pins pins) : wire (wire), name ((char*)name), pins (pins) {}
+
+		i2c_t3&		wire;									// the bus driver
+		char*		name;									// bus name passed to the sensor drivers' setup(); "Wire1" etc
+		i2c_pins	pins;									// passed to the sensor drivers' begin()
+		i2c_rate	rate = I2C_RATE_100;					// base rate: discovery, and every branch until auto rate moves it
+		uint32_t	rate_now = 0;							// rate last set with rate_apply(); 0 when unknown
+		SALT_ext_xq	xq {*this};								// non-blocking transactions on this bus
+
+		void		rate_apply (uint32_t hz);				// set the bus rate unless it is already hz
+
+		uint8_t		ping (uint8_t addr);					// pings one address; returns SUCCESS if acked
+		uint8_t		probe_mask (uint8_t base, uint8_t want);	// pings base + n for each bit n in want; returns presence bitmap
+		uint8_t		probe_list (const uint8_t* addrs, uint8_t count);	// pings addrs[n]; returns presence bitmap
+	};
+
+
+//---------------------------< H I S T O R Y >----------------------------------------------------------------
+//
+// Fixed-size history of one sensor channel (a temperature or a humidity), filled by the scans.  Samples are
+// int16_t hundredths (centi-°C or centi-%RH).  Each of HIST_WINDOWS windows covers the most recent len samples
+// (1 .. HIST_SIZE; set with window_set()) and keeps its running sum and monotonic min and max queues up to date
+// as samples are pushed, so min_get(), max_get() and mean_get() are constant time.  push() is amortized constant
+// time.  Failed reads are not pushed so a window counts samples, not scan passes.
+//
+
+#ifndef	HIST_SIZE
+#define	HIST_SIZE				32		// samples kept per channel; must be a power of 2 no larger than 128
+#endif
+#define	HIST_WINDOWS			2		// windows per channel
+#define	HIST_SHORT				0		// window indexes
+#define	HIST_LONG				1
+#ifndef	HIST_SHORT_DEFAULT
+#define	HIST_SHORT_DEFAULT		8		// default window lengths in samples
+#endif
+#ifndef	HIST_LONG_DEFAULT
+#define	HIST_LONG_DEFAULT		HIST_SIZE
+#endif
+
+#if (HIST_SIZE & (HIST_SIZE - 1)) || (128 < HIST_SIZE)
+#error	HIST_SIZE must be a power of 2 no larger than 128
+#endif
+
+class SALT_ext_history
+	{
+	public:
+		void		clear (void);							// forget all samples; window lengths are kept
+		void		window_set (uint8_t w, uint8_t len);	// window w covers the most recent len samples
+		void		push (int16_t value);					// add the newest sample
+
+		uint8_t		count_get (uint8_t w);					// samples in window w; the queries below return 0 when this is 0
+		int16_t		min_get (uint8_t w);
+		int16_t		max_get (uint8_t w);
+		int16_t		mean_get (uint8_t w);					// rounded
+		int16_t		last_get (void);						// newest sample
+
+	private:
+		struct window_t
+			{
+			uint8_t		len;								// samples covered when full
+			uint8_t		count;								// samples covered now
+			int32_t		sum;
+			uint8_t		min_q[HIST_SIZE];					// sequence numbers of samples that can still be the min; values ascending
+			uint8_t		max_q[HIST_SIZE];					// .. the max; values descending
+			uint8_t		min_head;							// oldest entry
+			uint8_t		min_tail;							// next free entry
+			uint8_t		max_head;
+			uint8_t		max_tail;
+			} window[HIST_WINDOWS] = {{HIST_SHORT_DEFAULT, 0, 0, {}, {}, 0, 0, 0, 0},	// every member: -Wextra checks
+						{HIST_LONG_DEFAULT, 0, 0, {}, {}, 0, 0, 0, 0}};
+
+		int16_t		ring[HIST_SIZE];						// sample with sequence number n is ring[n & (HIST_SIZE - 1)]
+		uint8_t		seq = 0;								// sequence number of the next sample
+		uint8_t		fill = 0;								// samples in ring
+
+		void		window_add (window_t* w, uint8_t at, int16_t value);	// add sample at to window w
+	};
+
+
+//---------------------------< I 2 C   S T A T S >------------------------------------------------------------
+//
+// Always-on counters for the transfers to one location (a mux control register, a sensor, or a mux eeprom): a
+// latency histogram, nacks, timeouts, and bytes moved.  Latency is micros() from the start of the transfer to its
+// completion, as seen by the caller; for scan_async() transfers that is when poll() saw it complete.  Counters
+// saturate rather than wrap.
+//
+
+#define	ISTATS_BUCKETS			8		// latency histogram buckets
+#ifndef	ISTATS_BUCKET0_US
+#define	ISTATS_BUCKET0_US		128		// bucket b counts transfers shorter than ISTATS_BUCKET0_US << b; the last bucket, the rest
+#endif
+
+class SALT_ext_istats
+	{
+	public:
+		void		clear (void);
+		void		record (uint32_t us, uint8_t bytes, uint8_t status);	// status is the i2c_t3 status() after the transfer
+
+		uint16_t	hist[ISTATS_BUCKETS];					// transfers by latency
+		uint32_t	transfers;
+		uint32_t	bytes;									// data bytes moved by good transfers
+		uint16_t	naks;									// address or data nacks
+		uint16_t	timeouts;								// timeouts and other bus errors
+		uint32_t	max_us;									// longest transfer
+	};
+
+
+//---------------------------< M S 8 6 0 7 >------------------------------------------------------------------
+//
+// State and integer math of one mux-mounted MS8607.  SALT_ext_sensors does the bus work: the humidity part is
+// triggered and collected where an HDC1080 would be; the pressure and temperature part converts one of pressure
+// (D1) or temperature (D2) at a time, so each visit reads the conversion in progress and starts the other one.
+// data holds the results of the last scan pass, like the Systronix drivers' data structs; the float fields are
+// filled only when data_float is set.
+//
+
+class SALT_ext_ms8607
+	{
+	public:
+		struct data_t
+			{
+			uint32_t	raw_pressure;						// D1
+			uint32_t	raw_temp;							// D2
+			uint16_t	raw_rh;								// humidity register; status bits cleared
+			int16_t		centi_c;							// second order compensated temperature in hundredths of a °C
+			int32_t		pa;									// second order compensated pressure in Pa (hundredths of a mbar)
+			int16_t		centi_rh;							// temperature compensated humidity in hundredths of a %RH
+			float		deg_c;
+			float		deg_f;
+			float		rh;
+			float		mbar;
+			} data;
+
+		uint16_t	prom[7];								// CRC and C1 .. C6
+		uint8_t		osr;									// MS8607_OSR_xxx
+		uint8_t		pending;								// conversion in progress: MS8607_PT_CONV_P, MS8607_PT_CONV_T, or 0
+		uint32_t	pending_us;								// micros() when it was started
+		uint32_t	d1;										// last pressure and temperature results; 0 until read
+		uint32_t	d2;
+
+		boolean		prom_check (void);						// CRC-4 of prom[] matches the CRC in word 0
+		void		compensate (void);						// d1, d2 to data.centi_c and data.pa
+		int16_t		centi_rh_get (uint16_t raw_rh);			// humidity register to temperature compensated hundredths of a %RH
+		uint32_t	pt_us (void);							// conversion time of one pressure or temperature conversion at osr
+		uint32_t	conv_us (void);							// time for both parts to complete the conversions a trigger starts
+	};
+
 
 //---------------------------< C L A S S >--------------------------------------------------------------------
 
@@ -124,73 +542,579 @@ class SALT_ext_sensors
 	private:
 	protected:
 
-//----------< M U X - M O U N T E D   E E P R O M   S E T T I N G S >----------
+//----------< T O P O L O G Y   S N A P S H O T >----------
 //
-// these unions apply to the eeprom mounted on the mux board at port 7.  For now, there is only one of these
-// because I don't know how to apply the information that the eeprom contains
+// Compact record of what discovery found, kept in Teensy EEPROM so that the next boot can verify it with a few
+// targeted probes instead of a full discovery.  The record lives at the top of EEPROM (TOPOLOGY_EEP_ADDR) where
+// it is out of the way of application settings that are allocated from address 0.
 //
 
-		union
+		struct topology_t
 			{
-			struct mux_settings
+			uint8_t		version;							// TOPOLOGY_VERSION; records from other library versions are ignored
+			uint8_t		muxes;								// number of muxes found
+			struct
 				{
-				char		assembly_type[16];		// string 'MUX7'; perhaps in future MUX if we add an eep to mux on 8548A common net
-				uint16_t	assembly_revision;		// 2.0 as a uint16_t = 0x0200
-				time_t		manufacture_date;		// not used in this code
-				time_t		service_date;			// not used in this code; not part of ini file; how set? when set?
-				uint8_t		ports;					// number of ports installed
-				uint8_t		unused[5];				// so that the struct totals 32 bytes
-				} as_struct;
-			uint8_t			as_array[32];
-			} assy_page;
-
-		union
-			{
-			struct sensor_settings
+				uint8_t		installed_sensors;				// as decoded from the mux eeprom, before sensor init
+				uint8_t		mms_mask;						// port[7] presence bitmap from probe_list()
+				boolean		uninit_eep;						// mux eeprom was uninitialized (E7N_UNINIT_MUX_IDX)
+				uint8_t		port[MAX_PORTS];				// bits 3..0: tmp275 presence bitmap; bits 7..4: eeprom presence bitmap
+				} mux[MAX_MUXES];
+			struct
 				{
-				char		sensor_type[16];		// string one of: 'TMP275', 'HDC1080', 'MS8607PT', 'MS8607H'
-				uint8_t		sensor_addr;			// sensor i2c address; if msb set, clear it do not OR with mux index [m]
-				uint8_t		unused[15];				// so that the struct totals 32 bytes
-				} as_struct;
-			uint8_t			as_array[32];
-			} sensor1_page, sensor2_page;
+				uint8_t		driver;							// port_drivers[] index, as read from the sensor node eeprom
+				uint8_t		addr;							// i2c address
+				} sensor[MAX_REG_SENSORS];					// in registry order
+			uint8_t		check;								// ones complement of the sum of all preceding bytes
+			} topology;
+		boolean		topology_partial = false;				// a mux eeprom couldn't be read; topology_save() keeps the last record
+
+		void		topology_clear (void);					// forget everything discovery or restore set up
+		uint8_t		topology_load (void);					// read the topology record from EEPROM
+		void		topology_save (void);					// write the topology record to EEPROM unless topology_partial
+		uint8_t		topology_restore (void);				// verify the topology record against the hardware and set it up
+		uint8_t		topology_check (void);					// checksum of the topology record
+
+		void		discover_full (void);					// probe everything; fill topology
+		uint8_t		eep_desc_read (uint8_t m, uint8_t* byte0_ptr);	// read and parse the mux[m] eeprom into mux[m].desc; SUCCESS or FAIL
+		void		mux_setup (uint8_t m);
+		void		port_sensor_setup (uint8_t m, uint8_t p, uint8_t s, boolean eep, uint8_t driver, uint8_t addr);
+		uint8_t		registry_find (uint8_t m, uint8_t p, uint8_t s);	// registry index of mux[m].port[p].sensor[s]; MEAS_NONE when there is none
+		void		registry_insert (uint8_t i, uint8_t m);	// open registry entry i for a mux[m] sensor: shift the later entries and their channels up
+		void		registry_delete (uint8_t i);			// remove registry entry i: shift the later entries and their channels down
+		void		mux_sensors_setup (uint8_t m, uint8_t mms_mask);
+
+//----------< P O R T   S E N S O R   D R I V E R S >----------
+//
+// Port sensor types by [sensor n] page type string.  Discovery reads each sensor node's eeprom, finds its type in
+// port_drivers[] and initializes only that driver; the registry entry keeps the port_drivers[] index and the scans
+// and meas_convert() use the entry's operations without testing the type.  A new port sensor type is a new driver
+// instance in sensor_t, an init and a data_float function, and a port_drivers[] entry.
+//
+
+		struct sensor_t;
+		struct port_driver_t
+			{
+			const char*	type;								// [sensor n] page type string
+			uint8_t		base;								// i2c address of sensor[0]; relative addresses are base + s
+			uint8_t		len;								// register bytes read per scan; big-endian temperature first
+			void		(SALT_ext_sensors::*init) (sensor_t* sensor_ptr, SALT_ext_bus& bus);	// set up the driver instance at sensor_ptr->addr
+			int16_t		(*centi_c) (uint16_t raw);			// raw temperature register to hundredths of a °C ..
+			int16_t		(*centi_f) (uint16_t raw);			// .. and of a °F
+			void		(SALT_ext_sensors::*data_float) (sensor_t* sensor_ptr, uint16_t raw);	// fill the driver's float data struct
+			};
+		static const port_driver_t	port_drivers[PORT_DRIVERS];
+
+		uint8_t		port_driver_read (uint8_t m, uint8_t p, uint8_t s, uint8_t* addr);	// read the mux[m].port[p].sensor[s] eeprom; returns the port_drivers[] index
+		void		port_tmp275_init (sensor_t* sensor_ptr, SALT_ext_bus& bus);
+		void		port_tmp275_float (sensor_t* sensor_ptr, uint16_t raw);
+
+//----------< S C A N   S T A T E >----------
+//
+// scan_poll() and sensor_scan() walk the sensors one bus step at a time; this struct remembers where the walk
+// left off so that the next call can resume there.
+//
+
+		enum
+			{
+			SCAN_IDLE,										// no scan pass in progress; next step starts a new one
+			SCAN_MUX_SELECT,								// enable mux[m].port[7] (mux-mounted sensors)
+			SCAN_MMS_HDC1080,								// read or trigger mux[m] HDC1080 as scan.hdc1080 says
+			SCAN_MMS_TMP275,								// read mux[m] TMP275
+			SCAN_PORT_SENSOR,								// enable the port of mux[m]'s next registry entry or read the sensor
+			SCAN_HDC_SELECT,								// enable mux[m].port[7] when its HDC1080 is in scan.collect and its conversion is complete
+			SCAN_HDC_HDC1080,								// read mux[m] HDC1080
+			SCAN_DISABLE,									// disable the ports of every mux not known to be disabled
+			};
+
+		struct scan_state_t
+			{
+			uint8_t		state;								// one of the SCAN_xxx enumerators above
+			uint8_t		m;									// mux of the next step
+			uint8_t		p;									// port enabled for port sensor reads; SCAN_NO_PORT when none
+			uint8_t		s;									// next of mux[m]'s registry entries (0 .. mux[m].sensor_count - 1)
+			uint8_t		hdc1080;							// MMS_HDC1080_xxx: what the visit to mux[m].port[7] does with its HDC1080
+			uint8_t		collect;							// bit m set: collect the mux[m] HDC1080 at the end of the pass; see scan_mms_plan()
+			} scan;
+
+//----------< E V E N T   L O G >----------
+//
+// Discovery and scan diagnostics are recorded as compact binary events in a fixed-size ring and formatted later,
+// by log_drain(), so that a slow or blocked USB serial port doesn't stall discovery or the scan.  The ring is not
+// interrupt safe; xlog() and log_drain() must be called from the same context (loop()).
+//
+
+		enum
+			{
+			XLOG_E7N,										// exception; status is the e7n index
+			XLOG_DISCOVER_START,
+			XLOG_DISCOVER_DONE,								// status is elapsed mS
+			XLOG_DISCOVER_MMS,								// start of mux-mounted sensor discovery
+			XLOG_TOPOLOGY_RESTORED,							// status is number of muxes
+			XLOG_TOPOLOGY_FIXED,							// status is the SALT_ext_topology id that the hardware matched
+			XLOG_TOPOLOGY_MISMATCH,							// status is the SALT_ext_topology id that the hardware didn't match
+			XLOG_DETECTED,									// mux
+			XLOG_NOT_DETECTED,
+			XLOG_TMP275_DETECTED,							// sensor
+			XLOG_TMP275_NOT_DETECTED,
+			XLOG_SELECT_FAIL,								// mux port select; status is the control value that wasn't written
+			XLOG_EEP_DETECTED,								// mux or sensor eeprom
+			XLOG_EEP_NOT_DETECTED,
+			XLOG_EEP_UNINIT,								// mux or sensor eeprom not initialized
+			XLOG_EEP_TYPE_UNKNOWN,							// mux or sensor eeprom; status is the [sensor n] page
+			XLOG_EEP_TYPE_NONE,								// mux eeprom; status is the [sensor n] page
+			XLOG_EEP_READ_FAIL,								// mux eeprom answered its probe but not the descriptor read
+			XLOG_MMS_NOT_DETECTED,							// mux-mounted sensor; status is its installed_sensors bit
+			XLOG_MMS_INIT_FAIL,
+			XLOG_MMS_INITIALIZED,
+			XLOG_MMS_MS8607_NOT_HDC1080,
+			XLOG_REGISTRY_FULL,								// sensor not added; MAX_REG_SENSORS too small
+			XLOG_BACKOFF,									// sensor or mux backed off; status is its fault count
+			XLOG_RECOVERED,									// backed off sensor or mux answered a recovery probe; status is its fault count
+			XLOG_RATE_UP,									// mux branch auto rate; status is the new rate in kHz
+			XLOG_RATE_DOWN,
+			XLOG_HOTPLUG_ADDED,								// port sensor plugged in; status is its registry index
+			XLOG_HOTPLUG_REMOVED,							// backed off port sensor no longer answers; status is the registry index it had
+			XLOG_HOTPLUG_REPLACED,							// backed off port sensor answers as a different type or address; status is its registry index
+			XLOG_CODES										// number of event codes
+			};
+
+		struct xlog_t
+			{
+			uint8_t		code;								// one of the XLOG_xxx enumerators above
+			uint8_t		m;									// mux, port, and sensor where the event happened, or XLOG_NA
+			uint8_t		p;
+			uint8_t		s;
+			uint16_t	status;								// code-specific value
+			} xlog_ring[XLOG_SIZE];
+
+		uint8_t		xlog_head;								// next entry written
+		uint8_t		xlog_tail;								// next entry drained
+		uint16_t	xlog_dropped;							// events not recorded because the ring was full
+
+		static const char* const	xlog_text[XLOG_CODES];	// log_drain() text for each event code
+
+		void		xlog (uint8_t code, uint8_t m, uint8_t p, uint8_t s, uint16_t status);	// use the XLOG() macro
+
+//----------< B U S E S >----------
+//
+// Each mux, and everything behind it, is on the bus that mux_bus() returns: bus unless mux_bus_set() assigned
+// another handle.  mux[m] is at 9548A base address + m whichever bus it is on.  Only muxes that share a bus are
+// kept from being enabled at the same time; scan_async() (and sensor_scan() when the muxes are on more than one
+// bus) queues each mux's groups on its own bus so that the buses run concurrently.
+//
+
+		SALT_ext_bus	bus {Wire1, "Wire1", I2C_PINS_29_30};	// the external sensor net
+		SALT_ext_bus*	mux_bus_ptr[MAX_MUXES] = {};			// mux_bus_set() handles; NULL: bus
+		boolean			xq_scan_active;							// scan_async() pass is queued
+
+		SALT_ext_bus&	mux_bus (uint8_t m) {return mux_bus_ptr[m] ? *mux_bus_ptr[m] : bus;}
+		boolean		bus_first (uint8_t m);					// true when no lower-numbered mux shares mux[m]'s bus
+		boolean		bus_multi (void);						// true when the muxes that exist are on more than one bus
+		uint8_t		mux_probe (void);						// presence bitmap of mux[0] .. mux[MAX_MUXES - 1], each pinged on its bus
+		uint8_t		xq_poll (void);							// poll() the queue of every mux's bus; returns groups pending on all of them
+		void		xq_flush (void);						// xq_poll() until nothing is pending
+
+		void		xq_scan_queue (void);					// queue one scan_async() pass
+		void		xq_result (SALT_ext_xq::group_t* group);	// store the results of a scan_async() group
+		static void	xq_done (SALT_ext_xq::group_t* group);		// SALT_ext_xq done() callback; calls xq_result()
+//----------< R A W   M E A S U R E M E N T S >----------
+//
+// The scans store raw register values here, not in the drivers' data structs.  meas_convert() turns the values
+// read during a pass into meas (and the drivers' data structs when data_float is set) in one integer pass at the
+// end of the pass.
+//
+
+		uint16_t	raw[MEAS_CHANNELS];						// temperature register values; same channel layout as meas
+		uint16_t	raw_rh[MAX_MUXES];						// mux HDC1080 (or MS8607) humidity register values
+		uint32_t	raw_fresh;								// bit n set when raw[n] was read since the last meas_convert()
+		boolean		data_float = true;						// meas_convert() also fills the drivers' float data struct fields
+
+		uint8_t		raw_read (uint8_t m, uint8_t n, uint8_t addr, uint8_t* data, uint8_t len);	// read len register bytes of channel n from addr behind mux[m]
+		uint32_t	raw_failed;								// bit n set when a read of channel n failed since the last meas_convert()
+		void		raw_store (uint8_t n, uint8_t* data);	// store channel n's temperature (and humidity) bytes; mark it fresh
+		void		meas_convert (void);					// convert the fresh raw values; called at the end of each scan pass
+
+//----------< A D A P T I V E   P O L L I N G >----------
+//
+// With poll_adaptive set, each scan pass reads only the channels in poll_due, which poll_plan() sets at the start
+// of the pass.  A channel whose readings stay within the deadband of its reference reading doubles its interval,
+// up to POLL_INTERVAL_MAX passes; a change beyond the deadband, a failed read, or poll_snap() puts it back on every
+// pass.  Ports and muxes with nothing due are not selected.
+//
+
+		struct poll_t
+			{
+			uint8_t		interval;							// scan passes between reads; 0 until the channel has a reference reading
+			uint8_t		wait;								// passes to skip before the next read
+			int16_t		ref_c;								// reference reading in hundredths of a °C
+			int16_t		ref_rh;								// reference humidity in hundredths of a %RH; HDC1080 channels only
+			} poll[MEAS_CHANNELS];
+
+		boolean		poll_adaptive = false;
+		uint32_t	poll_due = 0xFFFFFFFF;					// bit n set when channel n is read this pass
+		int16_t		poll_deadband_c = POLL_DEADBAND_C_DEFAULT;
+		int16_t		poll_deadband_rh = POLL_DEADBAND_RH_DEFAULT;
+		uint64_t	poll_saved_ns;							// estimated bus time skipped since poll_adaptive_set (true)
+		uint32_t	poll_start_ms;							// millis() at poll_adaptive_set (true)
+
+		void		poll_plan (void);						// set poll_due for the scan pass that is starting
+		boolean		poll_tick (uint8_t n);					// true when channel n is due this pass; else count down its wait
+		void		poll_update (uint32_t fresh);			// adjust the intervals of the channels that were due this pass
+		boolean		poll_is_due (uint8_t n) {return (poll_due >> n) & 1;}
+
+//----------< H E A L T H >----------
+//
+// Each channel and each mux counts its consecutive failures.  After HEALTH_FAILS_MAX of them it is backed off:
+// poll_plan() leaves it out of the pass (and the whole mux, for a mux) except for a recovery probe every backoff
+// passes; backoff doubles with each failed probe up to HEALTH_BACKOFF_MAX.  The first good read or select ends
+// the backoff.  Entering and leaving backoff are logged for each location.
+//
+
+		struct health_t
+			{
+			uint8_t		fails;								// consecutive failed reads (selects, for a mux)
+			uint8_t		backoff;							// scan passes between recovery probes; 0 when not backed off
+			uint8_t		wait;								// passes to skip before the next probe
+			uint16_t	faults;								// failed reads (selects) since discovery
+			} health[MEAS_CHANNELS], mux_health[MAX_MUXES];
+
+		uint32_t	health_out;								// bit n set while channel n is backed off
+		uint8_t		health_mux_out;							// bit m set while mux[m] is backed off
+
+		boolean		health_tick (health_t* health_ptr);		// true unless backed off and waiting; else count down its wait
+		boolean		health_fail (health_t* health_ptr);		// count a failure; true when that started a backoff
+		void		health_update (uint32_t fresh, uint32_t failed);	// count this pass's good and failed reads
+		void		mux_health_update (uint8_t m, boolean ok);	// count a mux select
+
+//----------< I 2 C   S T A T S >----------
+//
+// Per-location transfer counters (SALT_ext_istats) and scan pass durations.  pass_begin() and pass_end() bracket
+// every scan pass: scan_step(), scan_async() and sensor_scan_fixed().
+//
+
+		SALT_ext_istats	istats[MEAS_CHANNELS];				// sensor reads and HDC1080 triggers, by meas channel
+		SALT_ext_istats	mux_istats[MAX_MUXES];				// mux control register writes
+		SALT_ext_istats	eep_istats[MAX_MUXES];				// mux and sensor node eeprom reads
+		uint32_t	pass_start_us;							// micros() at pass_begin()
+
+		boolean		pass_active;							// between pass_begin() and pass_end()
+
+		void		pass_begin (void);						// start of a scan pass: stamp it and plan it (poll_plan())
+		void		pass_end (void);						// end of a scan pass: record its duration and convert (meas_convert())
+		uint8_t		eep_seek (uint8_t m, uint8_t addr, uint16_t mem_addr);	// set the address counter of the eeprom at addr behind mux[m]
+		uint8_t		eep_read (uint8_t m, uint8_t addr, uint8_t* buf, uint8_t len);	// current address read of len bytes from that eeprom
+		void		istats_record (SALT_ext_istats* istats_ptr, uint8_t m, uint32_t us, uint8_t bytes, uint8_t status);	// record a transfer behind mux[m]; count it for auto rate
+
+//----------< A U T O   R A T E >----------
+//
+// With rate_auto set each mux branch (the mux and everything behind it) climbs rate_steps[] one step for each
+// RATE_WINDOW scan pass transfers with fewer than RATE_ERRORS_MAX errors, up to RATE_AUTO_MAX.  RATE_ERRORS_MAX
+// errors in a window step it down at once; the step it fell from is retried after hold clean windows, and hold
+// doubles with each fall up to RATE_HOLD_MAX.  A clean window at the retried step clears hold.  The bus is set to
+// the branch's rate at each mux_control_write() and at the start of each scan_async() group for that mux.
+//
+
+		struct rate_t
+			{
+			uint8_t		step;								// rate_steps[] index in use
+			uint8_t		hold;								// clean windows to wait before retrying the step above; 0 once it has been clean
+			uint8_t		wait;								// clean windows left to wait
+			boolean		climbed;							// step was reached by climbing and hasn't had a clean window yet
+			uint16_t	window;								// transfers in the current window
+			uint8_t		errors;								// errors in the current window
+			} rate[MAX_MUXES];
+
+		boolean		rate_auto = false;
+
+		void		rate_reset (uint8_t m);					// back to the bus base rate; counters cleared
+		void		rate_step (uint8_t m, uint8_t step);	// move mux[m] to step and log it
+
+		uint32_t	mux_writes_saved = 0;					// count of mux control_write()s skipped because the mux was already set
+
+		uint32_t	scan_slice_us = SCAN_SLICE_DEFAULT_US;	// max time one scan_poll() call may spend on bus work
+
+		uint8_t		scan_step (void);						// do one bus step of a scan pass
+		uint8_t		mux_control_write (uint8_t m, uint8_t control);	// cached, one-mux-at-a-time mux[m].imux.control_write()
+		boolean		mux_control_cached (uint8_t m, uint8_t control);	// mux[m] has confirmed control; the write it saves is counted
+		uint8_t		hdc1080_trigger (uint8_t m);			// start a conversion on the mux[m] HDC1080
+		uint8_t		ms8607_init (uint8_t m);				// reset mux[m] MS8607, read its PROM and set its resolution
+		uint8_t		ms8607_trigger (uint8_t m);				// step the pressure and temperature pipeline; start a humidity conversion
+		uint8_t		ms8607_pt_step (uint8_t m);				// read the mux[m] MS8607 conversion in progress and start the other one
+		uint8_t		ms8607_cmd (uint8_t m, uint8_t addr, uint8_t cmd);	// one-byte command; counted on the humidity part's channel
+		uint8_t		ms8607_write (uint8_t m, uint8_t addr, const uint8_t* data, uint8_t len);	// command and data bytes; counted as ms8607_cmd()
+		void		ms8607_convert (uint8_t m);				// meas_convert() for the mux[m] MS8607
+		uint8_t		ms8607_osr = MS8607_OSR_DEFAULT;
+		void		mux_fault_log (uint8_t idx, uint8_t m);	// add exception idx and log it for mux[m]
+
+		uint8_t		scan_mms_plan (uint8_t m);				// MMS_HDC1080_xxx for this pass's visit to mux[m].port[7]; marks scan.collect
+		boolean		scan_mms_ready (uint8_t m);				// the mux[m] HDC1080 conversion is complete
+		boolean		scan_mms_collecting (uint8_t m);		// the mux[m] HDC1080 is collected at the end of this pass
+		boolean		scan_mms_humidity (uint8_t m, uint8_t plan);	// port[7] visit step for plan; returns true when it used the bus
+		uint8_t		scan_port_select (uint8_t m, uint8_t p);	// enable mux[m].port[p]; a failure is a mux fault
+		uint8_t		scan_mms_select (uint8_t m);			// scan steps shared by scan_step() and sensor_scan_fixed()
+		void		scan_mms_trigger (uint8_t m);
+		void		scan_mms_tmp275 (uint8_t m);
+		void		scan_mms_hdc1080 (uint8_t m);
+		void		scan_port_sensor (uint8_t i);			// i is the registry index
+
+//----------< P U B L I S H E D   S N A P S H O T >----------
+//
+// pass_end() copies meas into the snapshot[] entry that readers are not pointed at, then points them at it, so a
+// reader never sees a pass half written.  The entry's seq is odd while it is being written; a reader that is
+// still using an entry two publishes later finds seq changed (snapshot_check()) and reads again.
+//
+
+		volatile uint8_t	snapshot_pub;					// snapshot[] index that snapshot_get() returns
+		uint32_t	snapshot_seq;							// seq of the most recent publish
+
+		void		snapshot_publish (void);				// publish meas; called by pass_end() and discovery
+
+//----------< T H R E S H O L D S >----------
+//
+// meas_convert() checks each subscribed channel that was read this pass against its thresh[] entries as it
+// converts the pass and calls an entry's callback when the reading crosses a limit.  thresh_channels keeps
+// channels without subscriptions off the check.  Discovery and hot-plug changes re-bind each entry to the meas
+// channel now at its location.
+//
+
+		uint32_t	thresh_channels;						// bit n set when a bound thresh[] entry is on channel n
+
+		uint8_t		thresh_channel (uint8_t i);				// meas channel of thresh[i]'s location and quantity; MEAS_NONE when there is none
+		void		thresh_bind (boolean restart);			// re-bind every thresh[] entry after discovery (restart) or a hot-plug change
+		void		thresh_map (void);						// rebuild thresh_channels
+		void		thresh_eval (uint32_t fresh);			// check the fresh subscribed channels; called by meas_convert()
+
+//----------< H O T - P L U G >----------
+//
+// With hotplug set, pass_end() goes on round the port sensor slots of every mux, hotplug_slot being the next, for
+// up to hotplug_slice_us.  Slots with a healthy sensor cost nothing.  An empty slot is probed for a newly plugged
+// sensor node and a slot whose sensor is backed off (health_out) for its removal or replacement.  A change is
+// made in place: the registry entries, their per-channel state and the topology record are shifted, between
+// passes, so the scans never stop.
+//
+
+		boolean		hotplug = false;
+		uint32_t	hotplug_slice_us = HOTPLUG_SLICE_DEFAULT_US;
+		uint8_t		hotplug_slot;							// (((m * MAX_PORTS) + p) * MAX_SENSORS) + s of the next slot
+
+		void		hotplug_run (void);						// probe slots until hotplug_slice_us has gone or every slot was looked at; called by pass_end()
+		boolean		hotplug_probe (uint8_t m, uint8_t p, uint8_t s);	// probe one slot if it is empty or backed off; true when that used the bus
+		void		hotplug_changed (uint8_t m);			// after a change behind mux[m]: rebind, save the topology record, publish
+
+//----------< T E L E M E T R Y >----------
+//
+// pass_end() encodes the pass into telemetry_buf (see T E L E M E T R Y   R E C O R D) and hands it to the sink.
+// telemetry_prev holds the values the next record's entries are coded against; all 0 for a key record.
+//
+
+		telemetry_sink_t	telemetry_sink = NULL;			// none: no records
+		void*		telemetry_ctx;
+		uint8_t		telemetry_buf[TELEMETRY_RECORD_MAX];
+		uint16_t	telemetry_since_key = TELEMETRY_KEY_INTERVAL;	// records since the last key record; the next is a key record at TELEMETRY_KEY_INTERVAL
+
+		struct
+			{
+			uint32_t	present;
+			int16_t		centi_c[MEAS_CHANNELS];
+			int16_t		centi_rh[MAX_MUXES];
+			int32_t		pa[MAX_MUXES];
+			} telemetry_prev;
+
+		uint16_t	telemetry_encode (uint32_t fresh, uint32_t failed);	// encode this pass into telemetry_buf; returns its length
+		void		telemetry_write (uint32_t fresh, uint32_t failed);	// encode and send to the sink; called by pass_end()
+
+//----------< C O M P I L E - T I M E   T O P O L O G Y >----------
+//
+// sensor_discover_fixed() and sensor_scan_fixed() specialize discovery and the scan for one SALT_ext_topology
+// (see SALT_ext_topology.h).  The unrolled scan is built from these step types; each one's step<N>() is called
+// once for each N by SALT_ext_unroll.
+//
+
+		uint16_t	topology_fixed;							// id of the SALT_ext_topology that the hardware matched; 0 when the runtime path is in use
+
+		template <class T> struct fixed_mux_step;			// visit mux[M]: port[7] then the port sensors
+		template <class T, uint8_t M> struct fixed_port_step;	// enable mux[M].port[P] and read its sensors
+		template <class T> struct fixed_hdc1080_step;		// collect mux[M] HDC1080, last visited mux first
+		template <class T> struct fixed_disable_step;		// disable mux[M] ports
 
 
 	public:
+		struct eep_desc_t									// mux eeprom descriptor; see E E P R O M   M E M O R Y   M A P S
+			{
+			char		assembly_type[16];					// [assembly] page; '\0' terminated: "MUX7"
+			uint16_t	revision;							// 0xMMmm
+			uint32_t	manufacture_date;					// time_t values
+			uint32_t	service_date;
+			uint8_t		ports;								// number of ports installed
+			uint8_t		sensors;							// number of [sensor n] pages in sensor[]
+			struct
+				{
+				char		type[16];						// '\0' terminated: "TMP275", "HDC1080", "MS8607PT", "MS8607H"
+				uint8_t		addr;							// i2c address; msb set when absolute
+				} sensor[EEP_DESC_PAGES - 1];
+			};
+
+		struct rate_stats_t									// auto rate of one mux branch; see rate_stats_ptr_get()
+			{
+			uint32_t	hz;									// rate mux[m] and everything behind it runs at
+			uint32_t	transfers[RATE_STEPS];				// scan pass transfers at each rate_steps[] step
+			uint32_t	errors[RATE_STEPS];					// .. that nacked, timed out or otherwise failed
+			uint16_t	ups;								// steps up and down since discovery
+			uint16_t	downs;
+			} rate_stats[MAX_MUXES];
+
 		struct mux_t										// array of multiplexer boards
 			{
 			boolean							exists;			// set true during discovery
-			boolean							has_sensors;	// set true during discovery when sensors are discovered
 			uint8_t							installed_sensors;	// bitfield filled by decoding sensor type from eeprom
 			Systronix_PCA9548A				imux;			// instance the mux board; we call the destructor for unneeded instances
 			Systronix_M24C32				ieep;			// instance the eeprom (this is a place-holder for now)
+			eep_desc_t						desc;			// what the eeprom says; full discovery only (a warm boot doesn't read it)
 			Systronix_TMP275				itmp275;		// instance the tmp275 temp sensor
 			Systronix_HDC1080				ihdc1080;		// instance the hdc1080 temp and rh sensor
-			struct port_t									// array of multiplexer ports
-				{
-				boolean						has_sensors;	// set true during discovery when sensors are discovered
-				struct sensor_t								// array of port sensors; ports are limited in this design to 3 sensors per port
-					{
-					Systronix_TMP275		itmp275;		// instance the temp sensor board 275; What to do when we have different kinds of sensors?
-					Systronix_M24C32		ieep;			// instance the temp sensor board eeprom (this is a place-holder for now)
-					uint8_t					type;
-					uint8_t					addr;			// read from eep; this value is device min addr + [s] in sensor[s] (the index s)
-															// usually not required when low order eep address matches low order sensor address
-															// required when the low order addresses do not match (a sensor has only 1, 2, or 4 addresses) TODO: is this correct?
-					} sensor[MAX_SENSORS];
-				} port[MAX_PORTS];
+			uint8_t							control;		// last control register value confirmed (acked) by the mux
+			boolean							control_known;	// control is valid; cleared when a write fails or a read behind the mux fails
+			uint32_t						hdc1080_trigger_us;	// micros() at the most recent hdc1080 (or ms8607) trigger; init() and every read trigger a conversion
+			boolean							hdc1080_pending;	// that trigger was acked and its result is not yet read
+			uint32_t						conv_us;		// .. and the time its conversion takes: HDC1080_CONV_TIME_US or SALT_ext_ms8607::conv_us()
+			SALT_ext_ms8607					ims8607;		// ms8607 pressure, temperature and rh sensor
+			uint8_t							sensor_first;	// this mux's port sensors are sensor[sensor_first] ..
+			uint8_t							sensor_count;	// .. sensor[sensor_first + sensor_count - 1]
+			SALT_ext_history				tmp275_history;	// mux-mounted TMP275 temperature
+			SALT_ext_history				hdc1080_t_history;	// mux-mounted HDC1080 temperature
+			SALT_ext_history				hdc1080_rh_history;	// mux-mounted HDC1080 humidity
 			} mux[MAX_MUXES];
 
+		struct sensor_t										// registry of the port sensors that discovery found (and hot-plug added), in scan order:
+			{												// by mux, then port, then sensor
+			Systronix_TMP275				itmp275;		// instance the temp sensor board 275; only the port_drivers[driver] instance is set up
+			Systronix_M24C32				ieep;			// instance the temp sensor board eeprom (this is a place-holder for now)
+			uint8_t							driver;			// port_drivers[] index
+			uint8_t							addr;			// read from eep; absolute, or the type's base address + [s] in sensor[s] (the index s)
+			uint8_t							m;				// routing: the sensor is mux[m].port[p].sensor[s]
+			uint8_t							p;
+			uint8_t							s;
+			SALT_ext_history				history;		// temperature
+			} sensor[MAX_REG_SENSORS];
+		uint8_t		sensor_count;							// number of registry entries in use
+
+		struct meas_t										// integer results of the last scan pass, by meas channel (see MEAS_xxx)
+			{
+			int16_t		centi_c[MEAS_CHANNELS];				// temperature in hundredths of a °C
+			int16_t		centi_f[MEAS_CHANNELS];				// temperature in hundredths of a °F
+			int16_t		centi_rh[MAX_MUXES];				// mux[m] HDC1080 (or MS8607) humidity in hundredths of a %RH
+			int32_t		pa[MAX_MUXES];						// mux[m] MS8607 pressure in Pa; valid when its MEAS_MUX_HDC1080 channel is and pa is not 0
+			uint32_t	valid;								// bit n set when channel n holds a reading
+			} meas;
+
+		struct snapshot_t									// meas as published at the end of one scan pass; see snapshot_get()
+			{
+			uint32_t	seq;								// 2 x passes published; odd while the entry is being rewritten
+			uint32_t	pass_ms;							// millis() at the end of the pass
+			meas_t		meas;
+			} snapshot[2];									// read through snapshot_get(); the other entry is the next publish
+
+		struct thresh_t;
+		typedef void (*thresh_cb_t) (const thresh_t* thresh);	// threshold crossing callback; runs inside the scan pass
+
+		struct thresh_t										// threshold subscription; see thresh_add()
+			{
+			thresh_cb_t	cb;									// NULL when the entry is free
+			void*		ctx;								// for cb
+			int32_t		high;								// crossing above high (into THRESH_ABOVE) is reported ..
+			int32_t		low;								// .. and below low (into THRESH_BELOW)
+			int32_t		hyst;								// back to THRESH_IN needs the reading hyst inside the limit
+			int32_t		value;								// the reading that changed state
+			uint8_t		m;									// location, as for meas_channel_get()
+			uint8_t		p;
+			uint8_t		s;
+			uint8_t		quantity;							// THRESH_C, THRESH_RH or THRESH_PA
+			uint8_t		n;									// meas channel; MEAS_NONE while nothing is at the location
+			uint8_t		state;								// THRESH_IN, THRESH_ABOVE or THRESH_BELOW
+			} thresh[THRESH_MAX];
+
+		struct hotplug_stats_t								// hot-plug probing since discovery; see hotplug_set()
+			{
+			uint32_t	probes;								// slots probed
+			uint32_t	us;									// time spent probing and setting up, added to the ends of scan passes
+			uint16_t	added;								// sensors plugged in ..
+			uint16_t	removed;							// .. unplugged ..
+			uint16_t	replaced;							// .. and replaced by another type or address
+			} hotplug_stats;
+
+		struct telemetry_stats_t							// records sent to the telemetry sink since telemetry_sink_set()
+			{
+			uint32_t	records;
+			uint32_t	keys;								// .. of which key records
+			uint32_t	bytes;
+			} telemetry_stats;
+
+		struct scan_time_t									// scan pass durations, start to finish including waits and time between scan_poll() or scan_async() calls
+			{
+			uint32_t	passes;
+			uint32_t	last_us;
+			uint32_t	max_us;
+			uint64_t	total_us;
+			} scan_time;
+
 //	public:
+		void		mux_bus_set (uint8_t m, SALT_ext_bus& bus);	// put mux[m] on bus; call before sensor_discover()
 		uint8_t		sensor_discover (void);
+		void		topology_forget (void);					// make the next sensor_discover() a full discovery
 		uint8_t		sensor_scan (void);
+		uint8_t		scan_poll (void);						// non-blocking, time-sliced sensor_scan()
+		uint8_t		scan_async (void);						// non-blocking sensor_scan() on the transaction queue
+		template <class T> uint8_t	sensor_discover_fixed (void);	// verify that the hardware is topology T; else sensor_discover()
+		template <class T> uint8_t	sensor_scan_fixed (void);		// sensor_scan() unrolled for topology T
+		void		scan_slice_set (uint32_t slice_us);		// set max bus time per scan_poll() call
+		uint32_t	mux_writes_saved_get (void);			// number of redundant mux control_write()s skipped
+		uint8_t		log_drain (uint8_t max = 0xFF);			// format up to max logged events; returns number still queued
+		const snapshot_t*	snapshot_get (uint32_t* seq);	// the latest published pass, in place; *seq for snapshot_check()
+		boolean		snapshot_check (const snapshot_t* snap, uint32_t seq);	// true when snap still holds what snapshot_get() returned
+		void		data_float_set (boolean enable);		// also fill the drivers' float data struct fields; default true
+		void		ms8607_osr_set (uint8_t osr);			// MS8607_OSR_xxx; call before sensor_discover()
+		void		poll_adaptive_set (boolean enable);		// read steady sensors less often; default false
+		void		poll_deadband_set (int16_t centi_c, int16_t centi_rh);	// change that puts a sensor back on every pass
+		void		poll_snap (uint8_t m, uint8_t p, uint8_t s);	// read this sensor (see meas_channel_get()) every pass until it is steady again
+		void		poll_snap_all (void);
+		uint32_t	poll_saved_get (void);					// estimated bus time saved by adaptive polling, µS per hour
+		uint16_t	faults_get (uint8_t m, uint8_t p, uint8_t s);	// failed reads of this sensor (see meas_channel_get()) since discovery
+		uint8_t		backoff_get (uint8_t m, uint8_t p, uint8_t s);	// passes between its recovery probes; 0 when not backed off
+		uint16_t	mux_faults_get (uint8_t m);				// failed selects of mux[m] since discovery
+		uint8_t		mux_backoff_get (uint8_t m);
+		uint8_t		thresh_add (uint8_t m, uint8_t p, uint8_t s, uint8_t quantity, int32_t low, int32_t high, int32_t hyst,
+						thresh_cb_t cb, void* ctx = NULL);	// report crossings of that sensor's readings; returns a thresh[] index or THRESH_NONE
+		void		thresh_remove (uint8_t i);				// end subscription thresh[i]
+		void		hotplug_set (boolean enable);			// pick up port sensors plugged in, unplugged or replaced; default false
+		void		hotplug_slice_set (uint32_t slice_us);	// set max time hot-plug probing may add to a scan pass
+		void		telemetry_sink_set (telemetry_sink_t sink, void* ctx = NULL);	// write a binary record of each scan pass to sink; NULL stops
+		void		telemetry_key (void);					// make the next record a key record; e.g. at the start of a new log file
+		void		rate_auto_set (boolean enable);			// find each mux branch's highest reliable rate; default false
+		uint32_t	rate_get (uint8_t m);					// rate of mux[m] and everything behind it, Hz
+		rate_stats_t*	rate_stats_ptr_get (uint8_t m);		// .. with its per-rate transfer and error counters
+
+		SALT_ext_istats*	istats_ptr_get (uint8_t m, uint8_t p, uint8_t s);	// transfer counters of a sensor (see meas_channel_get())
+		SALT_ext_istats*	mux_istats_ptr_get (uint8_t m);	// .. of mux[m] control register writes
+		SALT_ext_istats*	eep_istats_ptr_get (uint8_t m);	// .. of mux[m] eeprom reads
+		void		istats_clear (void);					// clear the transfer counters and scan_time
+		void		istats_dump (void);						// one compact line per location with transfers
 		
-		uint8_t		pingex (uint8_t addr, i2c_t3 wire = Wire);	// pings an i2c address; Wire is default
+		uint8_t		pingex (uint8_t addr, uint8_t m = 0);	// pings an i2c address on mux[m]'s bus; SUCCESS if acked
 		uint8_t		show_sensor_temps (void);
 		
 		Systronix_TMP275::data_t*	tmp275_data_ptr_get (uint8_t m, uint8_t p, uint8_t s);
 		Systronix_TMP275::data_t*	mux_tmp275_data_ptr_get (uint8_t m);
 		Systronix_HDC1080::data_t*	mux_hdc1080_data_ptr_get (uint8_t m);
+		SALT_ext_ms8607::data_t*	mux_ms8607_data_ptr_get (uint8_t m);
+
+		uint8_t		meas_channel_get (uint8_t m, uint8_t p, uint8_t s);	// meas channel of a port sensor, or of mux[m] TMP275 (p = 7, s = 0) or HDC1080 (p = 7, s = 1); MEAS_NONE else
+
+		void		history_window_set (uint8_t w, uint8_t len);	// set window w length on every channel
+		SALT_ext_history*	tmp275_history_ptr_get (uint8_t m, uint8_t p, uint8_t s);
+		SALT_ext_history*	mux_tmp275_history_ptr_get (uint8_t m);
+		SALT_ext_history*	mux_hdc1080_t_history_ptr_get (uint8_t m);
+		SALT_ext_history*	mux_hdc1080_rh_history_ptr_get (uint8_t m);
 	};
 
 // We shall constrain the i2c slave address of each mux to be the 9548A base address + the mux[m] array index m
@@ -200,19 +1124,22 @@ class SALT_ext_sensors
 // off of an individual port.  In this design, there are three compartments per drawer so three is the max number
 // of sensors.
 //
-// Further, there shall be no empty locations between occupied locations.  All mux[m], port[p], sensor[s] indexes
-// begin at [0] and shall be increment by 1 to the next occupied index.  An unoccupied index terminates any
-// sequential operation (discovery, scanning) even when that index + 1 is occupied.
+// sensor_discover() assumes there are no empty locations between occupied locations: mux[m], port[p] and sensor[s]
+// indexes begin at [0] and increment by 1 to the next occupied index, and an unoccupied index ends the discovery
+// walk even when that index + 1 is occupied.  After discovery there can be gaps.  Hot-plug (hotplug_run()) probes
+// every port and sensor slot and adds what it finds past an empty one, and topology_restore() accepts the empty
+// ports and slots a saved topology records.  So the scans walk the registry entries, not the indexes, and nothing
+// after discovery may take an unoccupied index as the end of a mux or port.
 //
 // Because the eeprom slave address is fixed at 0x50–0x57, and because we don't necessarily know what is out
 // there, we don't need to store the eeprom address in this struct but, the fixed portion of the sensor's
 // address (usually upper four bits) must be stored in the eeprom so that we can fetch it, modify it (if possible)
-// with the three low order eeprom address bits, and store it in our struct at mux[m].port[p].sensor[s].addr for
+// with the three low order eeprom address bits, and store it in the sensor's registry entry (sensor[].addr) for
 // later use.  This is perhaps the only nod to future sensor development.
 //
 // A discovery process takes place during or following system startup where we discover how many muxes are
 // attached; then for each of those muxes, we query port-by-port, searching eeprom addresses 0x50–0x57, and
-// filling in mux[m].port[p].sensor[s] for those ports that have sensors attached.
+// adding a registry entry, routed to mux[m].port[p].sensor[s], for each sensor found.
 //
 // The discovery process initializes an instance of the eeprom library for each of the addresses.  Successful
 // return from the library init() function indicates the presence of an eeprom.  At this writing, we only support
@@ -222,4 +1149,6 @@ class SALT_ext_sensors
 
 
 extern	SALT_ext_sensors ext_sensors;
+
+#include <SALT_ext_topology.h>							// compile-time topology templates
 #endif	// SALT_EXT_SENSORS_H_
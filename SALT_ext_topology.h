@@ -0,0 +1,264 @@
+#ifndef SALT_EXT_TOPOLOGY_H_
+#define SALT_EXT_TOPOLOGY_H_
+
+// SALT_ext_topology
+//
+// Compile-time topology specialization of discovery and the scan.  A sketch that is built for one known
+// configuration describes it with SALT_ext_topology and calls the _fixed forms of sensor_discover() and
+// sensor_scan():
+//
+//	setup():	ext_sensors.sensor_discover_fixed<SALT_TOPOLOGY_SBS> ();
+//	loop():		ext_sensors.sensor_scan_fixed<SALT_TOPOLOGY_SBS> ();
+//
+// sensor_discover_fixed() doesn't discover; it verifies that the hardware is exactly the described topology with
+// the warm boot probes (topology_restore()) and sets it up.  sensor_scan_fixed() is then a straight-line sequence
+// of bus steps generated at build time: no mux, port, or registry walk and no per-step installed-sensor tests.
+// When the hardware doesn't match (a sensor missing, added, or failed init), sensor_discover_fixed() falls back to
+// sensor_discover() and sensor_scan_fixed() to sensor_scan(), so the runtime-discovered path still handles
+// whatever is actually attached.
+//
+
+#include <SALT_ext_sensors.h>
+
+
+//---------------------------< S A L T _ E X T _ T O P O L O G Y >--------------------------------------------
+//
+// Describes one configuration: MUXES mux boards (mux[0] .. mux[MUXES - 1]), each with PORTS ports (port[0] ..
+// port[PORTS - 1]) that each carry SENSORS TMP275 sensor nodes with eeproms, and the mux-mounted sensors in
+// INSTALLED (installed_sensors bits) plus the mux eeprom on port[7].
+//
+
+template <uint8_t MUXES, uint8_t PORTS, uint8_t SENSORS = 1, uint8_t INSTALLED = (TMP275 | HDC1080)>
+struct SALT_ext_topology
+	{
+	static const uint8_t	muxes = MUXES;
+	static const uint8_t	ports = PORTS;						// per mux
+	static const uint8_t	sensors = SENSORS;					// per port
+	static const uint8_t	reg_sensors = MUXES * PORTS * SENSORS;	// registry entries
+	static const uint8_t	installed_sensors = INSTALLED;
+	static const uint8_t	port_mask = (1 << SENSORS) - 1;		// tmp275 and eeprom presence bitmaps on each port
+	static const uint8_t	mms_mask = MMS_EEP | ((INSTALLED & TMP275) ? MMS_TMP275 : 0) | ((INSTALLED & HDC1080) ? MMS_HDC1080 : 0);
+	static const uint16_t	id = (MUXES << 12) | (PORTS << 8) | (SENSORS << 4) | INSTALLED;	// topology_fixed value; never 0
+
+	static_assert ((0 < MUXES) && (MAX_MUXES >= MUXES), "SALT_ext_topology: MUXES out of range");
+	static_assert ((0 < PORTS) && (MAX_PORTS >= PORTS), "SALT_ext_topology: PORTS out of range");
+	static_assert ((0 < SENSORS) && (MAX_SENSORS >= SENSORS), "SALT_ext_topology: SENSORS out of range");
+	static_assert (MAX_REG_SENSORS >= MUXES * PORTS * SENSORS, "SALT_ext_topology: MAX_REG_SENSORS too small");
+	static_assert (!(INSTALLED & MS8607), "SALT_ext_topology: MS8607 not supported");
+	};
+
+typedef	SALT_ext_topology<1, 3>	SALT_TOPOLOGY_B2B;			// the habitat configurations
+typedef	SALT_ext_topology<2, 4>	SALT_TOPOLOGY_SBS;			// SBS: one mux per habitat
+typedef	SALT_ext_topology<1, 4>	SALT_TOPOLOGY_SS;
+typedef	SALT_ext_topology<1, 5>	SALT_TOPOLOGY_B2BWEC;
+typedef	SALT_ext_topology<1, 6>	SALT_TOPOLOGY_SSWEC;
+
+
+//---------------------------< S A L T _ E X T _ U N R O L L >------------------------------------------------
+//
+// Compile-time loop: run() calls f.step<I>() for I = FIRST .. LAST - 1 as straight-line code and stops at the
+// first step that doesn't return SUCCESS.  Returns SUCCESS when every step did.
+//
+
+template <uint8_t FIRST, uint8_t LAST, boolean MORE = (FIRST < LAST)>
+struct SALT_ext_unroll
+	{
+	template <class F> static inline uint8_t run (F& f)
+		{
+		if (SUCCESS != f.template step<FIRST> ())
+			return FAIL;
+		return SALT_ext_unroll<FIRST + 1, LAST>::run (f);
+		}
+	};
+
+template <uint8_t FIRST, uint8_t LAST>
+struct SALT_ext_unroll<FIRST, LAST, false>
+	{
+	template <class F> static inline uint8_t run (F&) {return SUCCESS;}
+	};
+
+
+//---------------------------< F I X E D _ M U X _ S T E P >--------------------------------------------------
+//
+// Visit mux[M]: enable port[7], read or trigger the HDC1080 as scan_mms_plan() says, read the TMP275, then the
+// port sensors.  Same bus steps as scan_step()'s SCAN_MUX_SELECT .. SCAN_PORT_SENSOR.
+//
+
+template <class T>
+struct SALT_ext_sensors::fixed_mux_step
+	{
+	SALT_ext_sensors&	ext;
+
+	template <uint8_t M> uint8_t step (void)
+		{
+		fixed_port_step<T, M>	ports = {ext, false};
+		uint8_t		plan = (T::installed_sensors & HDC1080) ? ext.scan_mms_plan (M) : MMS_HDC1080_NONE;
+
+		if ((MMS_HDC1080_TRIGGER == plan) || (MMS_HDC1080_READ == plan) || (T::installed_sensors & TMP275))
+			{
+			if (SUCCESS != ext.scan_mms_select (M))				// enable access to mux[M].port[7]
+				return FAIL;									// abandon this pass
+			ext.scan_mms_humidity (M, plan);
+			if (T::installed_sensors & TMP275)
+				ext.scan_mms_tmp275 (M);
+			}
+
+		return SALT_ext_unroll<0, T::ports * T::sensors>::run (ports);
+		}
+	};
+
+
+//---------------------------< F I X E D _ P O R T _ S T E P >------------------------------------------------
+//
+// Step I reads mux[M].port[I / sensors].sensor[I % sensors]; the first sensor on each port enables the port, and
+// the port's sensors are skipped when that fails (scan_port_select()).  Registry index is fixed because
+// sensor_discover_fixed() verified that the registry holds exactly T.
+//
+
+template <class T, uint8_t M>
+struct SALT_ext_sensors::fixed_port_step
+	{
+	SALT_ext_sensors&	ext;
+	boolean				selected;								// this port's select succeeded
+
+	template <uint8_t I> uint8_t step (void)
+		{
+		if (0 == (I % T::sensors))								// first sensor on this port
+			selected = (SUCCESS == ext.scan_port_select (M, I / T::sensors));	// enable access to mux[M].port[p]
+		if (selected)
+			ext.scan_port_sensor ((M * T::ports * T::sensors) + I);
+		return SUCCESS;
+		}
+	};
+
+
+//---------------------------< F I X E D _ H D C 1 0 8 0 _ S T E P >------------------------------------------
+//
+// Step I collects the HDC1080 on mux[muxes - 1 - I] (last visited mux first, as scan_step() does) when the port[7]
+// visit left it for the end of the pass (scan_mms_collecting()), waiting for its conversion to complete.
+//
+
+template <class T>
+struct SALT_ext_sensors::fixed_hdc1080_step
+	{
+	SALT_ext_sensors&	ext;
+
+	template <uint8_t I> uint8_t step (void)
+		{
+		const uint8_t	m = T::muxes - 1 - I;
+
+		if (!(T::installed_sensors & HDC1080) || !ext.scan_mms_collecting (m))
+			return SUCCESS;
+
+		while (!ext.scan_mms_ready (m))							// conversion not yet complete; hdc1080 would nack
+			;
+		if (SUCCESS != ext.scan_mms_select (m))				// enable access to mux[m].port[7]
+			return FAIL;										// abandon this pass
+		ext.scan_mms_hdc1080 (m);
+		return SUCCESS;
+		}
+	};
+
+
+//---------------------------< F I X E D _ D I S A B L E _ S T E P >------------------------------------------
+//
+// leave mux[M] disabled between scan passes; one attempt only
+//
+
+template <class T>
+struct SALT_ext_sensors::fixed_disable_step
+	{
+	SALT_ext_sensors&	ext;
+
+	template <uint8_t M> uint8_t step (void)
+		{
+		ext.mux_control_write (M, PCA9548A_PORTS_DISABLE);			// skipped, and counted, when already disabled
+		return SUCCESS;
+		}
+	};
+
+
+//---------------------------< S E N S O R _ D I S C O V E R _ F I X E D >------------------------------------
+//
+// Fill the topology record from T and verify it against the hardware with topology_restore(), which also sets
+// up the muxes and sensors.  The mux and sensor node eeproms are not read; installed_sensors and the port sensor
+// drivers (TMP275) come from T.  Scans use the unrolled path when everything in T was found and initialized.
+// When restore fails the hardware is discovered at runtime with sensor_discover(); when a mux-mounted sensor in
+// T fails init, the set up is kept and the runtime scan is used.
+//
+
+template <class T>
+uint8_t SALT_ext_sensors::sensor_discover_fixed (void)
+	{
+	uint32_t	start = millis();
+	uint8_t		m;
+	uint8_t		i = 0;
+
+	topology_clear ();
+	topology.muxes = T::muxes;
+	for (m = 0; m < T::muxes; m++)
+		{
+		topology.mux[m].installed_sensors = T::installed_sensors;
+		topology.mux[m].mms_mask = T::mms_mask;
+		for (uint8_t p = 0; p < T::ports; p++)
+			{
+			topology.mux[m].port[p] = (T::port_mask << 4) | T::port_mask;	// every sensor node has an eeprom
+			for (uint8_t s = 0; s < T::sensors; s++, i++)
+				{
+				topology.sensor[i].driver = PORT_DRIVER_TMP275;
+				topology.sensor[i].addr = TMP275_BASE_MIN + s;
+				}
+			}
+		}
+
+	if (SUCCESS != topology_restore ())
+		{
+		XLOG (XLOG_INFO, XLOG_TOPOLOGY_MISMATCH, XLOG_NA, XLOG_NA, XLOG_NA, T::id);
+		topology_clear ();											// forget anything the failed restore set up
+		return sensor_discover ();
+		}
+
+	for (m = 0; (m < T::muxes) && (T::installed_sensors == mux[m].installed_sensors); m++)
+		;
+	if ((T::muxes == m) && (T::reg_sensors == sensor_count))
+		{
+		topology_fixed = T::id;
+		XLOG (XLOG_INFO, XLOG_TOPOLOGY_FIXED, XLOG_NA, XLOG_NA, XLOG_NA, T::id);
+		}
+	else
+		XLOG (XLOG_INFO, XLOG_TOPOLOGY_MISMATCH, XLOG_NA, XLOG_NA, XLOG_NA, T::id);
+
+	thresh_bind (true);
+	XLOG (XLOG_INFO, XLOG_DISCOVER_DONE, XLOG_NA, XLOG_NA, XLOG_NA, millis() - start);
+	return SUCCESS;
+	}
+
+
+//---------------------------< S E N S O R _ S C A N _ F I X E D >--------------------------------------------
+//
+// sensor_scan() for topology T: the same bus steps in the same order, generated at build time.  Runs sensor_scan()
+// instead when sensor_discover_fixed<T>() didn't verify T, when a scan_poll() pass is in progress, when adaptive
+// polling is on, while a sensor or mux is backed off, or when the muxes are on more than one bus (sensor_scan()
+// then runs the buses concurrently).
+//
+
+template <class T>
+uint8_t SALT_ext_sensors::sensor_scan_fixed (void)
+	{
+	fixed_mux_step<T>		muxes = {*this};
+	fixed_hdc1080_step<T>	hdc1080s = {*this};
+	fixed_disable_step<T>	disables = {*this};
+
+	if ((T::id != topology_fixed) || (SCAN_IDLE != scan.state) || poll_adaptive || health_out || health_mux_out || bus_multi ())
+		return sensor_scan ();
+
+	xq_flush ();													// finish queued scan_async() work; this pass needs the bus
+	pass_begin ();
+	if (SUCCESS == SALT_ext_unroll<0, T::muxes>::run (muxes))
+		SALT_ext_unroll<0, T::muxes>::run (hdc1080s);				// abandoned when a mux can't be set
+	SALT_ext_unroll<0, T::muxes>::run (disables);
+	pass_end ();
+	return SUCCESS;
+	}
+
+#endif	// SALT_EXT_TOPOLOGY_H_
@@ -20,6 +20,7 @@ void setup (void)
 	Serial.printf("Build %s - %s\r\n%s\r\n", __DATE__, __TIME__, __FILE__);
 
 	ext_sensors.sensor_discover ();
+	ext_sensors.log_drain ();			// print what discovery found
 
 	}
 	
@@ -33,5 +34,6 @@ void loop (void)
 	{
 //	Serial.printf (".");
 	ext_sensors.sensor_scan ();
+	ext_sensors.log_drain (4);			// a few logged events per pass so that a slow serial port doesn't stall loop()
 	delay (5000);
 	}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef SALT_HOST_ARDUINO_H_
+#define SALT_HOST_ARDUINO_H_
+
+// Arduino.h host stand-in
+//
+// Just enough of the Teensyduino core for SALT_ext_sensors and the Systronix sensor drivers to build and run on
+// a Linux host against the simulated i2c bus in SALT_sim_bus.  Time is simulated: millis() and micros() return
+// sim_now_ns which advances with bus traffic, delay(), and a small fixed cost for each time query so that code
+// which spins on micros() makes progress.
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+typedef bool		boolean;
+typedef uint8_t		byte;
+
+#define	SIM_CALL_NS		1000			// simulated cpu time charged to each millis()/micros() call
+
+extern uint64_t		sim_now_ns;			// simulated time since 'power up'
+
+uint32_t	millis (void);
+uint32_t	micros (void);
+void		delay (uint32_t ms);
+void		delayMicroseconds (uint32_t us);
+
+#define	__disable_irq()
+#define	__enable_irq()
+
+
+//---------------------------< S E R I A L >------------------------------------------------------------------
+//
+// Serial.printf() goes to stdout when echo is true; benchmarks turn it off so that output is machine-readable.
+//
+
+class SALT_host_serial
+	{
+	public:
+		boolean		echo = true;
+
+		void		begin (uint32_t baud) {}
+		operator	bool (void) {return true;}
+		int			printf (const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+	};
+
+extern SALT_host_serial Serial;
+
+#endif	// SALT_HOST_ARDUINO_H_
@@ -0,0 +1,30 @@
+#ifndef SALT_HOST_EEPROM_H_
+#define SALT_HOST_EEPROM_H_
+
+// EEPROM.h host stand-in
+//
+// Teensy EEPROM as a byte array that persists for the life of the process; host programs simulate a warm boot by
+// constructing a new SALT_ext_sensors without clearing EEPROM.  Reads and writes take no simulated time.
+//
+
+#include <Arduino.h>
+
+#define	E2END		0xFFF					// Teensy 3.6: 4096 bytes
+
+class SALT_host_eeprom
+	{
+	public:
+		uint8_t		mem[E2END + 1];
+
+		SALT_host_eeprom (void) {memset (mem, 0xFF, sizeof(mem));}		// erased
+
+		uint8_t		read (int idx) {return mem[idx];}
+		void		write (int idx, uint8_t val) {mem[idx] = val;}
+		void		update (int idx, uint8_t val) {mem[idx] = val;}
+		template <typename T> T&		get (int idx, T& t) {memcpy (&t, &mem[idx], sizeof(T)); return t;}
+		template <typename T> const T&	put (int idx, const T& t) {memcpy (&mem[idx], &t, sizeof(T)); return t;}
+	};
+
+extern SALT_host_eeprom EEPROM;
+
+#endif	// SALT_HOST_EEPROM_H_
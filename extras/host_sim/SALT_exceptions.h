@@ -0,0 +1,46 @@
+#ifndef SALT_HOST_EXCEPTIONS_H_
+#define SALT_HOST_EXCEPTIONS_H_
+
+// SALT_exceptions.h host stand-in
+//
+// Only the exception indexes and members that SALT_ext_sensors uses.  exception_add() queues the exception and
+// counts it so that host programs can report faults.
+//
+
+#include <Arduino.h>
+
+enum
+	{
+	E7N_UNINIT_MUX_IDX,
+	E7N_EXT_TEMP_FAULT_IDX,
+	E7N_MUX_FAULT_IDX,
+	E7N_MUX_TSNSR_FAULT_IDX,
+	E7N_MUX_HSNSR_FAULT_IDX,
+	E7N_MUX_THSNSR_FAULT_IDX,
+	E7N_MAX_IDX
+	};
+
+class SALT_exceptions
+	{
+	public:
+		struct e7n_msg_t
+			{
+			boolean		queued;
+			const char*	l;								// long message
+			uint32_t	count;							// host only: number of times exception_add() was called
+			} e7n_msg[E7N_MAX_IDX] =
+				{
+				{false, "UNINIT MUX EEP", 0},
+				{false, "EXT TEMP SENSOR", 0},
+				{false, "EXT MUX", 0},
+				{false, "EXT MUX T SENSOR", 0},
+				{false, "EXT MUX H SENSOR", 0},
+				{false, "EXT MUX TH SENSOR", 0},
+				};
+
+		void		exception_add (uint8_t idx) {e7n_msg[idx].queued = true; e7n_msg[idx].count++;}
+	};
+
+extern SALT_exceptions e7n;
+
+#endif	// SALT_HOST_EXCEPTIONS_H_
@@ -0,0 +1,18 @@
+#ifndef SALT_HOST_LOGGING_H_
+#define SALT_HOST_LOGGING_H_
+
+// SALT_logging.h host stand-in; log_event() writes to stdout through Serial
+
+#include <Arduino.h>
+
+class SALT_logging
+	{
+	public:
+		uint32_t	events;								// host only: number of events logged
+
+		void		log_event (char* msg) {events++; Serial.printf ("log: %s\n", msg);}
+	};
+
+extern SALT_logging logs;
+
+#endif	// SALT_HOST_LOGGING_H_
@@ -0,0 +1,617 @@
+// SALT_sim_bus.cpp
+//
+// device models and transfer engine for the host-side simulated i2c bus; see SALT_sim_bus.h
+//
+
+#include <math.h>
+#include <SALT_sim_bus.h>
+
+SALT_sim_bus	sim_bus[4];							// one per i2c_t3 bus: [0] is Wire, [1] is Wire1 ...
+
+
+//---------------------------< T M P 2 7 5 >------------------------------------------------------------------
+//
+// Pointer register selects temperature (0), config (1), tlow (2), thigh (3).  Temperature is 12 bits left-
+// justified in a 16-bit register; 0.0625C per lsb.
+//
+
+boolean SALT_sim_tmp275::addr_ack (boolean read)
+	{
+	if (!present)
+		return false;
+	rd_idx = 0;
+	reg[0] = (uint16_t)((int16_t)lroundf (deg_c * 16) << 4);	// sample now
+	return true;
+	}
+
+boolean SALT_sim_tmp275::write_byte (uint8_t index, uint8_t data)
+	{
+	if (0 == index)
+		pointer = data & 0x03;
+	else if (1 == index)
+		reg[pointer] = (reg[pointer] & 0x00FF) | (data << 8);
+	else if ((2 == index) && (1 != pointer))			// config register is one byte
+		reg[pointer] = (reg[pointer] & 0xFF00) | data;
+	return (0 != pointer) || (0 == index);				// temperature register is read-only
+	}
+
+uint8_t SALT_sim_tmp275::read_byte (void)
+	{
+	uint8_t	data = (0 == (rd_idx & 1)) ? (reg[pointer] >> 8) : (reg[pointer] & 0xFF);
+
+	if (1 == pointer)
+		data = reg[pointer] >> 8;						// config register is one byte; repeats
+	rd_idx++;
+	return data;
+	}
+
+
+//---------------------------< H D C 1 0 8 0 >----------------------------------------------------------------
+//
+// A pointer write to 0x00 (temperature) or 0x01 (humidity) triggers a conversion.  When config MODE is set,
+// temperature and humidity are converted in sequence and a read from 0x00 returns four bytes.  The device nacks
+// its read address until the conversion is complete.
+//
+
+boolean SALT_sim_hdc1080::addr_ack (boolean read)
+	{
+	if (!present)
+		return false;
+
+	if (read && (sim_now_ns < ready_ns))				// conversion in progress
+		{
+		early_reads++;
+		return false;
+		}
+	rd_idx = 0;
+	return true;
+	}
+
+boolean SALT_sim_hdc1080::write_byte (uint8_t index, uint8_t data)
+	{
+	if (0 == index)
+		{
+		pointer = data;
+		if (0x01 >= pointer)							// trigger
+			{
+			t_raw = (uint16_t)lroundf ((deg_c + 40.0f) * 65536.0f / 165.0f);
+			h_raw = (uint16_t)lroundf (rh * 65536.0f / 100.0f);
+			if (config & 0x1000)						// temperature and humidity
+				ready_ns = sim_now_ns + t_conv_ns + h_conv_ns;
+			else
+				ready_ns = sim_now_ns + (pointer ? h_conv_ns : t_conv_ns);
+			}
+		}
+	else if ((0x02 == pointer) && (1 == index))
+		config = (config & 0x00FF) | (data << 8);
+	else if ((0x02 == pointer) && (2 == index))
+		config = (config & 0xFF00) | data;
+	return true;
+	}
+
+uint8_t SALT_sim_hdc1080::read_byte (void)
+	{
+	uint16_t	reg;
+	uint8_t		idx = rd_idx++;
+
+	switch (pointer)
+		{
+		case 0x00:
+			if ((config & 0x1000) && (2 <= idx))		// sequential mode: humidity follows temperature
+				reg = h_raw;
+			else
+				reg = t_raw;
+			break;
+		case 0x01:
+			reg = h_raw;
+			break;
+		case 0x02:
+			reg = config;
+			break;
+		case 0xFE:
+			reg = 0x5449;								// manufacturer id
+			break;
+		case 0xFF:
+			reg = 0x1050;								// device id
+			break;
+		default:
+			reg = 0;
+		}
+
+	return (0 == (idx & 1)) ? (reg >> 8) : (reg & 0xFF);
+	}
+
+
+//---------------------------< M S 8 6 0 7 >------------------------------------------------------------------
+//
+// Pressure and temperature part: 0xA0 + 2n selects PROM word n for a two-byte read; 0x40 + 2 * osr (pressure) or
+// 0x50 + 2 * osr (temperature) starts a conversion; 0x00 selects the 24-bit ADC result, which reads 0 until the
+// conversion is complete and once it has been read.  D1 and D2 are the datasheet first order compensation run
+// backwards from deg_c and mbar with the PROM coefficients.  Conversion times are the datasheet maximums.
+//
+
+static const uint32_t	sim_ms8607_pt_ns[] = {560000, 1100000, 2170000, 4320000, 8610000, 17200000};	// by osr
+
+SALT_sim_ms8607_pt::SALT_sim_ms8607_pt (uint8_t mux, uint8_t port, float deg_c, float mbar) : SALT_sim_device (SIM_MS8607_PT_ADDR, mux, port), deg_c (deg_c), mbar (mbar)
+	{
+	uint16_t	rem = 0;
+	uint16_t	word;
+
+	for (uint8_t cnt = 0; cnt < 16; cnt++)				// datasheet CRC-4 into word 0's top nibble
+		{
+		word = (7 > (cnt >> 1)) ? prom[cnt >> 1] : 0;
+		rem ^= (cnt & 1) ? (word & 0x00FF) : (word >> 8);
+		for (uint8_t bit = 8; bit > 0; bit--)
+			rem = (rem & 0x8000) ? ((rem << 1) ^ 0x3000) : (rem << 1);
+		}
+	prom[0] = ((rem >> 12) & 0x000F) << 12;
+	}
+
+boolean SALT_sim_ms8607_pt::addr_ack (boolean read)
+	{
+	if (!present)
+		return false;
+	rd_idx = 0;
+	return true;
+	}
+
+boolean SALT_sim_ms8607_pt::write_byte (uint8_t index, uint8_t data)
+	{
+	int64_t		dt = (int64_t)llroundf ((deg_c * 100.0f) - 2000.0f) * (1 << 23) / prom[6];
+	int64_t		off = ((int64_t)prom[2] << 17) + ((prom[4] * dt) >> 6);
+	int64_t		sens = ((int64_t)prom[1] << 16) + ((prom[3] * dt) >> 7);
+
+	if (0 != index)
+		return false;
+
+	cmd = data;
+	if ((0x40 == (data & 0xF0)) && (0x0A >= (data & 0x0F)))		// pressure
+		{
+		adc = (uint32_t)((((int64_t)llroundf (mbar * 100.0f) << 15) + off) * (1 << 21) / sens);
+		adc_valid = false;
+		ready_ns = sim_now_ns + sim_ms8607_pt_ns[(data & 0x0F) >> 1];
+		conversions++;
+		}
+	else if ((0x50 == (data & 0xF0)) && (0x0A >= (data & 0x0F)))	// temperature
+		{
+		adc = (uint32_t)(((int64_t)prom[5] << 8) + dt);
+		adc_valid = false;
+		ready_ns = sim_now_ns + sim_ms8607_pt_ns[(data & 0x0F) >> 1];
+		conversions++;
+		}
+	else if ((0x00 == data) && (sim_now_ns >= ready_ns))
+		adc_valid = (0 != adc);
+	else if (0x00 == data)
+		early_reads++;
+	return true;
+	}
+
+uint8_t SALT_sim_ms8607_pt::read_byte (void)
+	{
+	uint8_t	idx = rd_idx++;
+	uint8_t	data = 0;
+
+	if ((0xA0 <= cmd) && (0xAE >= cmd))
+		data = (0 == idx) ? (prom[(cmd - 0xA0) >> 1] >> 8) : (prom[(cmd - 0xA0) >> 1] & 0xFF);
+	else if ((0x00 == cmd) && adc_valid)
+		{
+		data = adc >> (8 * (2 - (idx % 3)));
+		if (2 == idx)
+			{
+			adc = 0;									// read once
+			adc_valid = false;
+			}
+		}
+	return data;
+	}
+
+
+//---------------------------< M S 8 6 0 7   H >--------------------------------------------------------------
+//
+// Humidity part: 0xFE resets; 0xE7 selects the user register for a one-byte read; 0xE6 writes it (resolution in
+// bits 7 and 0); 0xF5 starts a conversion and the part nacks its read address until it is complete.  Reads return
+// the humidity MSB, LSB (status bits 0x02) and a CRC byte (not modelled: 0).  The raw value is the datasheet
+// -0.18 %RH/°C compensation run backwards from the pressure part's deg_c.
+//
+
+static uint32_t sim_ms8607_h_ns (uint8_t user)
+	{
+	switch (user & 0x81)
+		{
+		case 0x01:	return 3000000;						// 8-bit
+		case 0x80:	return 5000000;						// 10-bit
+		case 0x81:	return 9000000;						// 11-bit
+		default:	return 16000000;					// 12-bit
+		}
+	}
+
+boolean SALT_sim_ms8607_h::addr_ack (boolean read)
+	{
+	if (!present)
+		return false;
+
+	if (read && (0xF5 == cmd) && (sim_now_ns < ready_ns))	// conversion in progress
+		{
+		early_reads++;
+		return false;
+		}
+	rd_idx = 0;
+	return true;
+	}
+
+boolean SALT_sim_ms8607_h::write_byte (uint8_t index, uint8_t data)
+	{
+	float	raw_rh = rh + ((20.0f - pt->deg_c) * 0.18f);	// uncompensated
+
+	if (1 == index)
+		{
+		if (0xE6 == cmd)
+			user = data;
+		return true;
+		}
+
+	cmd = data;
+	if (0xFE == data)
+		user = 0x02;
+	else if (0xF5 == data)
+		{
+		h_raw = (uint16_t)lroundf ((raw_rh + 6.0f) * 65536.0f / 125.0f) & 0xFFFC;
+		ready_ns = sim_now_ns + sim_ms8607_h_ns (user);
+		}
+	return true;
+	}
+
+uint8_t SALT_sim_ms8607_h::read_byte (void)
+	{
+	uint8_t	idx = rd_idx++;
+
+	if (0xE7 == cmd)
+		return user;
+	if (0 == idx)
+		return h_raw >> 8;
+	if (1 == idx)
+		return (h_raw & 0xFC) | 0x02;					// status: humidity measurement
+	return 0;
+	}
+
+
+//---------------------------< M 2 4 C 3 2 >------------------------------------------------------------------
+//
+// Two address bytes then data.  Writes are buffered within a 32-byte page and committed at the stop condition;
+// the device then nacks its address for the 5mS write cycle.  Reads are sequential from the current address.
+//
+
+void SALT_sim_m24c32::page_type_set (uint8_t page, const char* type, uint8_t i2c_addr)
+	{
+	uint8_t*	ptr = &mem[page * 32];
+
+	memset (ptr, 0, 32);
+	strncpy ((char*)ptr, type, 15);
+	ptr[16] = i2c_addr;
+	}
+
+boolean SALT_sim_m24c32::addr_ack (boolean read)
+	{
+	page_len = 0;
+	if (read && read_faults)
+		{
+		read_faults--;
+		return false;
+		}
+	return present && (sim_now_ns >= busy_ns);
+	}
+
+boolean SALT_sim_m24c32::write_byte (uint8_t index, uint8_t data)
+	{
+	if (0 == index)
+		addr16 = (data & 0x0F) << 8;
+	else if (1 == index)
+		addr16 |= data;
+	else if (sizeof(page_buf) > page_len)
+		page_buf[page_len++] = data;
+	return true;
+	}
+
+uint8_t SALT_sim_m24c32::read_byte (void)
+	{
+	uint8_t	data = mem[addr16];
+
+	addr16 = (addr16 + 1) & 0x0FFF;
+	return data;
+	}
+
+void SALT_sim_m24c32::stop (boolean was_write)
+	{
+	if (!was_write || (0 == page_len))
+		return;
+
+	for (uint8_t i = 0; i < page_len; i++)				// writes roll over within the page
+		mem[(addr16 & 0x0FE0) | ((addr16 + i) & 0x1F)] = page_buf[i];
+	page_len = 0;
+	busy_ns = sim_now_ns + 5000000;
+	}
+
+
+//---------------------------< P C A 9 5 4 8 A >--------------------------------------------------------------
+
+boolean SALT_sim_pca9548a::write_byte (uint8_t index, uint8_t data)
+	{
+	if ((0 == index) && (data & stuck_ports))				// the mux keeps its last control value
+		return false;
+	if (0 == index)
+		control = data;
+	return true;
+	}
+
+
+//---------------------------< S I M   B U S >----------------------------------------------------------------
+
+//---------------------------< C L E A R >--------------------------------------------------------------------
+
+void SALT_sim_bus::clear (void)
+	{
+	for (size_t i = 0; i < devices.size(); i++)
+		delete devices[i];
+	devices.clear ();
+	memset (mux, 0, sizeof(mux));
+	noise = 1;
+	stats_clear ();
+	}
+
+
+//---------------------------< D E V I C E _ A D D >----------------------------------------------------------
+
+SALT_sim_device* SALT_sim_bus::device_add (SALT_sim_device* device)
+	{
+	devices.push_back (device);
+	return device;
+	}
+
+
+//---------------------------< M U X _ B O A R D _ A D D >----------------------------------------------------
+//
+// adds a mux board: PCA9548A at base address + m and, on port[7], the mux eeprom loaded the way SALT mux boards
+// are programmed, a TMP275 at 0x4F and an HDC1080 when requested.
+//
+
+SALT_sim_pca9548a* SALT_sim_bus::mux_board_add (uint8_t m, boolean tmp275, boolean hdc1080, float deg_c, float rh)
+	{
+	SALT_sim_m24c32*	eep = new SALT_sim_m24c32 (SIM_EEP_BASE | 7, m, 7);
+	uint8_t				page = 1;
+
+	mux[m] = new SALT_sim_pca9548a (m);
+	device_add (mux[m]);
+
+	eep->page_type_set (0, "MUX7", 0);
+	if (tmp275)
+		{
+		eep->page_type_set (page++, "TMP275", 0x80 | (SIM_TMP275_BASE | 7));
+		device_add (new SALT_sim_tmp275 (SIM_TMP275_BASE | 7, m, 7, deg_c));
+		}
+	if (hdc1080)
+		{
+		eep->page_type_set (page++, "HDC1080", 0x80 | SIM_HDC1080_ADDR);
+		device_add (new SALT_sim_hdc1080 (m, 7, deg_c, rh));
+		}
+	device_add (eep);
+	return mux[m];
+	}
+
+
+//---------------------------< P O R T _ S E N S O R _ A D D >------------------------------------------------
+//
+// adds a TMP275 sensor node at mux[m].port[p].sensor[s]: TMP275 at 0x48 + s and its eeprom at 0x50 + s
+//
+
+SALT_sim_tmp275* SALT_sim_bus::port_sensor_add (uint8_t m, uint8_t p, uint8_t s, float deg_c)
+	{
+	SALT_sim_m24c32*	eep = new SALT_sim_m24c32 (SIM_EEP_BASE | s, m, p);
+	SALT_sim_tmp275*	tmp275 = new SALT_sim_tmp275 (SIM_TMP275_BASE | s, m, p, deg_c);
+
+	eep->page_type_set (0, "TMP275", 0);
+	eep->page_type_set (1, "TMP275", SIM_TMP275_BASE);	// relative address: tracks the node's address jumpers
+	device_add (eep);
+	device_add (tmp275);
+	return tmp275;
+	}
+
+
+//---------------------------< M S 8 6 0 7 _ A D D >----------------------------------------------------------
+//
+// adds an MS8607 to the port[7] of mux board m (added with mux_board_add() and no HDC1080) and its two pages,
+// "MS8607PT" and "MS8607H", after the ones already in the mux eeprom
+//
+
+SALT_sim_ms8607_pt* SALT_sim_bus::ms8607_add (uint8_t m, float deg_c, float rh, float mbar)
+	{
+	SALT_sim_m24c32*	eep = (SALT_sim_m24c32*)find (SIM_EEP_BASE | 7, m, 7);
+	SALT_sim_ms8607_pt*	pt = new SALT_sim_ms8607_pt (m, 7, deg_c, mbar);
+	uint8_t				page = 1;
+
+	while ((4 > page) && (0xFF != eep->mem[page * 32]))
+		page++;
+	eep->page_type_set (page++, "MS8607PT", 0x80 | SIM_MS8607_PT_ADDR);
+	eep->page_type_set (page, "MS8607H", 0x80 | SIM_HDC1080_ADDR);
+	device_add (pt);
+	device_add (new SALT_sim_ms8607_h (m, 7, rh, pt));
+	return pt;
+	}
+
+
+//---------------------------< S B S _ B O A R D _ A D D >----------------------------------------------------
+//
+// adds mux board m the way the benches build an SBS system: mux-mounted TMP275 at 22 + m °C, an HDC1080 when
+// requested at 40 + m %RH, and a single-sensor TMP275 node at 20 + p °C on each of port[0 .. ports - 1]
+//
+
+SALT_sim_pca9548a* SALT_sim_bus::sbs_board_add (uint8_t m, uint8_t ports, boolean hdc1080)
+	{
+	mux_board_add (m, true, hdc1080, 22.0 + m, 40.0 + m);
+	for (uint8_t p = 0; p < ports; p++)
+		port_sensor_add (m, p, 0, 20.0 + p);
+	return mux[m];
+	}
+
+
+//---------------------------< S B S _ A D D >----------------------------------------------------------------
+//
+// adds mux boards 0 .. muxes - 1 with sbs_board_add()
+//
+
+void SALT_sim_bus::sbs_add (uint8_t muxes, uint8_t ports)
+	{
+	for (uint8_t m = 0; m < muxes; m++)
+		sbs_board_add (m, ports);
+	}
+
+
+//---------------------------< F I N D >----------------------------------------------------------------------
+
+SALT_sim_device* SALT_sim_bus::find (uint8_t addr, uint8_t mux, uint8_t port)
+	{
+	for (size_t i = 0; i < devices.size(); i++)
+		if ((addr == devices[i]->addr) && (mux == devices[i]->mux) && ((SIM_MAIN_NET == mux) || (port == devices[i]->port)))
+			return devices[i];
+	return NULL;
+	}
+
+
+//---------------------------< V I S I B L E >----------------------------------------------------------------
+//
+// a device is on the bus when it is on the mux common net or when its mux has its port enabled.  There is no
+// arbitration between muxes: every mux with the port enabled connects its devices to the bus.
+//
+
+boolean SALT_sim_bus::visible (SALT_sim_device* device)
+	{
+	if (SIM_MAIN_NET == device->mux)
+		return true;
+	return (NULL != mux[device->mux]) && (mux[device->mux]->control & (1 << device->port));
+	}
+
+
+//---------------------------< C A B L E _ E R R O R >--------------------------------------------------------
+//
+// true when the drawer cable to device garbles this transfer: never at or below its mux's cable_hz, else with
+// probability 1 - cable_hz / rate
+//
+
+boolean SALT_sim_bus::cable_error (SALT_sim_device* device)
+	{
+	uint32_t	hz = rate_get ();
+
+	if ((SIM_MAIN_NET == device->mux) || (7 == device->port) || !mux[device->mux]->cable_hz || (hz <= mux[device->mux]->cable_hz))
+		return false;
+
+	noise = (noise * 1103515245) + 12345;
+	return ((uint64_t)((noise >> 8) & 0xFFFF) * hz) >= ((uint64_t)mux[device->mux]->cable_hz << 16);
+	}
+
+
+//---------------------------< A D D R E S S >----------------------------------------------------------------
+//
+// address phase: every visible device at addr sees the address; those that ack are returned in responders.
+// The address is acked when any device acks (wired-AND).
+//
+
+uint8_t SALT_sim_bus::address (uint8_t addr, boolean read, SALT_sim_device** responders)
+	{
+	uint8_t	count = 0;
+
+	stats.transactions++;
+	for (size_t i = 0; i < devices.size(); i++)
+		{
+		if ((addr == devices[i]->addr) && visible (devices[i]) && !cable_error (devices[i]) && devices[i]->addr_ack (read) && (8 > count))
+			responders[count++] = devices[i];
+		}
+	return count;
+	}
+
+
+//---------------------------< A D V A N C E >----------------------------------------------------------------
+//
+// charge bus time for a transfer: start, nine bit times per byte (eight data bits and ack), and stop
+//
+
+void SALT_sim_bus::advance (size_t bytes, boolean stop)
+	{
+	uint64_t	bits = 1 + (9 * bytes) + (stop ? 1 : 0);
+	uint64_t	ns = (bits * 1000000000ULL) / rate_get ();
+
+	stats.bytes += bytes;
+	stats.bus_ns += ns;
+	sim_now_ns += ns;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+
+uint8_t SALT_sim_bus::write (uint8_t addr, const uint8_t* buf, size_t len, boolean stop)
+	{
+	SALT_sim_device*	responders[8];
+	uint8_t				count = address (addr, false, responders);
+	boolean				ack;
+
+	if (SIM_PCA9548A_BASE == (addr & 0xF8))
+		stats.mux_writes++;
+
+	if (0 == count)
+		{
+		stats.addr_naks++;
+		advance (1, true);									// master sends stop after nak
+		return SIM_ADDR_NAK;
+		}
+
+	for (size_t i = 0; i < len; i++)
+		{
+		ack = false;
+		for (uint8_t r = 0; r < count; r++)
+			ack |= responders[r]->write_byte (i, buf[i]);	// any ack wins
+		if (!ack)
+			{
+			stats.data_naks++;
+			for (uint8_t r = 0; r < count; r++)
+				responders[r]->stop (true);
+			advance (1 + i + 1, true);
+			return SIM_DATA_NAK;
+			}
+		}
+
+	if (stop)
+		for (uint8_t r = 0; r < count; r++)
+			responders[r]->stop (true);
+	advance (1 + len, stop);
+	return SIM_ACK;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// every responder drives each byte; the bus carries the AND of their bytes (zero always wins)
+//
+
+size_t SALT_sim_bus::read (uint8_t addr, uint8_t* buf, size_t len, boolean stop)
+	{
+	SALT_sim_device*	responders[8];
+	uint8_t				count = address (addr, true, responders);
+
+	if (0 == count)
+		{
+		stats.addr_naks++;
+		advance (1, true);
+		return 0;
+		}
+
+	for (size_t i = 0; i < len; i++)
+		{
+		buf[i] = 0xFF;
+		for (uint8_t r = 0; r < count; r++)
+			buf[i] &= responders[r]->read_byte ();
+		}
+
+	if (stop)
+		for (uint8_t r = 0; r < count; r++)
+			responders[r]->stop (false);
+	advance (1 + len, stop);
+	return len;
+	}
@@ -0,0 +1,253 @@
+#ifndef SALT_SIM_BUS_H_
+#define SALT_SIM_BUS_H_
+
+// SALT_sim_bus
+//
+// Host-side simulated i2c bus for SALT_ext_sensors.  A bus carries PCA9548A mux models on the mux common net and
+// TMP275, HDC1080, MS8607 and M24C32 models behind mux ports.  The models reproduce the behaviour described in the
+// README:
+//	paralleled muxes: every enabled mux passes traffic so same-address devices behind two enabled muxes both
+//		respond; acks and data are wired-AND (zero always wins)
+//	HDC1080: a pointer write to the temperature or humidity register triggers a conversion; the device nacks
+//		its read address until the conversion is complete
+//	drawer cables: above a mux's cable_hz, devices behind its ports 0 .. 6 miss their address ack at random, more
+//		often the further above it the bus runs
+//	MS8607: the pressure and temperature part returns 0 from its ADC read until its conversion is complete; the
+//		humidity part nacks its read address until its conversion is complete
+//
+// Each transfer advances simulated time (sim_now_ns in Arduino.h) by its byte time at the bus rate (100kHz,
+// 400kHz, ... as set by i2c_t3::begin() or setRate(), or forced with rate_force()) and is counted in stats.
+//
+
+#include <Arduino.h>
+#include <vector>
+
+#define	SIM_MAIN_NET		0xFF		// device 'mux' value for devices on the mux common net
+
+#define	SIM_ACK				0			// write() returns: same values as i2c_t3 endTransmission()
+#define	SIM_ADDR_NAK		2
+#define	SIM_DATA_NAK		3
+
+#define	SIM_PCA9548A_BASE	0x70
+#define	SIM_TMP275_BASE		0x48
+#define	SIM_EEP_BASE		0x50
+#define	SIM_HDC1080_ADDR	0x40
+#define	SIM_MS8607_PT_ADDR	0x76
+
+
+//---------------------------< S I M   D E V I C E >----------------------------------------------------------
+//
+// base class for device models.  A transfer addressed to a device calls addr_ack() once, then write_byte() or
+// read_byte() for each data byte, then stop() if the transfer ended with a stop condition.
+//
+
+class SALT_sim_device
+	{
+	public:
+		SALT_sim_device (uint8_t addr, uint8_t mux, uint8_t port) : addr (addr), mux (mux), port (port) {}
+		virtual ~SALT_sim_device (void) {}
+
+		uint8_t		addr;									// 7-bit slave address
+		uint8_t		mux;									// SIM_MAIN_NET or index of the mux this device is behind
+		uint8_t		port;									// mux port this device is behind
+		boolean		present = true;							// false simulates an unplugged or dead device
+
+		virtual boolean	addr_ack (boolean read) {return present;}
+		virtual boolean	write_byte (uint8_t index, uint8_t data) {return true;}	// index of data byte in this transfer; returns ack
+		virtual uint8_t	read_byte (void) {return 0xFF;}
+		virtual void	stop (boolean was_write) {}
+	};
+
+
+//---------------------------< P C A 9 5 4 8 A >--------------------------------------------------------------
+
+class SALT_sim_pca9548a : public SALT_sim_device
+	{
+	public:
+		SALT_sim_pca9548a (uint8_t m) : SALT_sim_device (SIM_PCA9548A_BASE | m, SIM_MAIN_NET, 0) {}
+
+		uint8_t		control = 0;							// power-up: all ports disabled
+		uint32_t	cable_hz = 0;							// port 0 .. 6 drawer cables: reliable up to this rate; 0: any rate
+		uint8_t		stuck_ports = 0;						// a control write that enables one of these ports is nacked and ignored
+
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void) {return control;}
+	};
+
+
+//---------------------------< T M P 2 7 5 >------------------------------------------------------------------
+
+class SALT_sim_tmp275 : public SALT_sim_device
+	{
+	public:
+		SALT_sim_tmp275 (uint8_t addr, uint8_t mux, uint8_t port, float deg_c) : SALT_sim_device (addr, mux, port), deg_c (deg_c) {}
+
+		float		deg_c;									// temperature the next read reports
+
+		boolean		addr_ack (boolean read);
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void);
+
+	private:
+		uint8_t		pointer = 0;
+		uint8_t		rd_idx = 0;
+		uint16_t	reg[4] = {0, 0, 0x4B00, 0x5000};		// temp, config (upper byte), tlow, thigh
+	};
+
+
+//---------------------------< H D C 1 0 8 0 >----------------------------------------------------------------
+
+class SALT_sim_hdc1080 : public SALT_sim_device
+	{
+	public:
+		SALT_sim_hdc1080 (uint8_t mux, uint8_t port, float deg_c, float rh) : SALT_sim_device (SIM_HDC1080_ADDR, mux, port), deg_c (deg_c), rh (rh) {}
+
+		float		deg_c;									// values captured by the next conversion
+		float		rh;
+		uint32_t	t_conv_ns = 6350000;					// 14-bit temperature conversion time
+		uint32_t	h_conv_ns = 6500000;					// 14-bit humidity conversion time
+		uint32_t	early_reads = 0;						// reads nacked because the conversion was not complete
+
+		boolean		addr_ack (boolean read);
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void);
+
+	private:
+		uint8_t		pointer = 0;
+		uint8_t		rd_idx = 0;
+		uint16_t	config = 0x1000;						// MODE: temperature and humidity in sequence
+		uint64_t	ready_ns = 0;							// conversion complete at this time
+		uint16_t	t_raw = 0;								// results of the last conversion
+		uint16_t	h_raw = 0;
+	};
+
+
+//---------------------------< M S 8 6 0 7 >------------------------------------------------------------------
+//
+// The MS8607 is two devices: pressure and temperature at 0x76 and humidity at 0x40 (the HDC1080 address)
+//
+
+class SALT_sim_ms8607_pt : public SALT_sim_device
+	{
+	public:
+		SALT_sim_ms8607_pt (uint8_t mux, uint8_t port, float deg_c, float mbar);
+
+		float		deg_c;									// values captured by the next conversion
+		float		mbar;
+		uint16_t	prom[7] = {0, 46372, 43981, 29059, 27842, 31553, 28165};	// CRC, C1 .. C6: the datasheet example
+		uint32_t	conversions = 0;
+		uint32_t	early_reads = 0;						// ADC reads that returned 0 because the conversion was not complete
+
+		boolean		addr_ack (boolean read);
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void);
+
+	private:
+		uint8_t		cmd = 0;
+		uint8_t		rd_idx = 0;
+		uint64_t	ready_ns = 0;							// conversion complete at this time
+		uint32_t	adc = 0;								// result of the last conversion; read once
+		boolean		adc_valid = false;
+	};
+
+class SALT_sim_ms8607_h : public SALT_sim_device
+	{
+	public:
+		SALT_sim_ms8607_h (uint8_t mux, uint8_t port, float rh, SALT_sim_ms8607_pt* pt) : SALT_sim_device (SIM_HDC1080_ADDR, mux, port), rh (rh), pt (pt) {}
+
+		float		rh;										// value captured by the next conversion
+		uint32_t	early_reads = 0;						// reads nacked because the conversion was not complete
+
+		boolean		addr_ack (boolean read);
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void);
+
+	private:
+		SALT_sim_ms8607_pt*	pt;								// for the temperature the humidity part's reading depends on
+		uint8_t		cmd = 0;
+		uint8_t		rd_idx = 0;
+		uint8_t		user = 0x02;							// reset value: 12-bit resolution
+		uint64_t	ready_ns = 0;
+		uint16_t	h_raw = 0;
+	};
+
+
+//---------------------------< M 2 4 C 3 2 >------------------------------------------------------------------
+
+class SALT_sim_m24c32 : public SALT_sim_device
+	{
+	public:
+		SALT_sim_m24c32 (uint8_t addr, uint8_t mux, uint8_t port) : SALT_sim_device (addr, mux, port) {memset (mem, 0xFF, sizeof(mem));}
+
+		uint8_t		mem[4096];
+		uint8_t		read_faults = 0;						// the next read_faults read transfers nack their address (bus glitches)
+
+		void		page_type_set (uint8_t page, const char* type, uint8_t i2c_addr);	// fill a page the way the eeprom memory map says
+
+		boolean		addr_ack (boolean read);
+		boolean		write_byte (uint8_t index, uint8_t data);
+		uint8_t		read_byte (void);
+		void		stop (boolean was_write);
+
+	private:
+		uint16_t	addr16 = 0;
+		uint8_t		page_buf[32];
+		uint8_t		page_len = 0;
+		uint64_t	busy_ns = 0;							// write cycle complete at this time; device nacks until then
+	};
+
+
+//---------------------------< S I M   B U S >----------------------------------------------------------------
+
+class SALT_sim_bus
+	{
+	public:
+		struct stats_t
+			{
+			uint64_t	bus_ns;								// time the bus was busy
+			uint32_t	transactions;						// start conditions (including repeated starts)
+			uint32_t	bytes;								// bytes on the bus including address bytes
+			uint32_t	addr_naks;
+			uint32_t	data_naks;
+			uint32_t	mux_writes;							// writes addressed to a PCA9548A
+			uint64_t	host_ns;							// host (real, not simulated) time spent in the transfer engine and models
+			} stats;
+
+		static uint64_t	host_now_ns (void) {struct timespec ts; clock_gettime (CLOCK_MONOTONIC, &ts); return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;}
+
+		~SALT_sim_bus (void) {clear ();}
+
+		void		clear (void);							// remove all devices and clear stats
+
+		void		rate_set (uint32_t hz) {rate_hz = hz;}	// i2c_t3 begin() and setRate() call this
+		void		rate_force (uint32_t hz) {forced_hz = hz;}	// 0 to use the rate set by the driver
+		uint32_t	rate_get (void) {return forced_hz ? forced_hz : rate_hz;}
+		void		stats_clear (void) {memset (&stats, 0, sizeof(stats));}
+
+		SALT_sim_device*	device_add (SALT_sim_device* device);	// bus takes ownership
+		SALT_sim_pca9548a*	mux_board_add (uint8_t m, boolean tmp275, boolean hdc1080, float deg_c = 25.0, float rh = 50.0);
+		SALT_sim_tmp275*	port_sensor_add (uint8_t m, uint8_t p, uint8_t s, float deg_c = 25.0);
+		SALT_sim_ms8607_pt*	ms8607_add (uint8_t m, float deg_c = 25.0, float rh = 50.0, float mbar = 1013.25);	// on a mux board with no HDC1080
+		SALT_sim_pca9548a*	sbs_board_add (uint8_t m, uint8_t ports = 4, boolean hdc1080 = true);	// one mux board of the bench fixture
+		void		sbs_add (uint8_t muxes = 2, uint8_t ports = 4);	// the bench fixture: an SBS system by default
+		SALT_sim_device*	find (uint8_t addr, uint8_t mux, uint8_t port);
+
+		uint8_t		write (uint8_t addr, const uint8_t* buf, size_t len, boolean stop);	// returns SIM_ACK, SIM_ADDR_NAK, or SIM_DATA_NAK
+		size_t		read (uint8_t addr, uint8_t* buf, size_t len, boolean stop);		// returns number of bytes read; 0 when address nacked
+
+	private:
+		std::vector<SALT_sim_device*>	devices;
+		SALT_sim_pca9548a*	mux[8] = {};
+		uint32_t	rate_hz = 100000;
+		uint32_t	forced_hz = 0;
+		uint32_t	noise = 1;								// cable error generator state
+
+		boolean		visible (SALT_sim_device* device);
+		boolean		cable_error (SALT_sim_device* device);
+		uint8_t		address (uint8_t addr, boolean read, SALT_sim_device** responders);
+		void		advance (size_t bytes, boolean stop);
+	};
+
+extern SALT_sim_bus	sim_bus[];						// one per i2c_t3 bus: [0] is Wire, [1] is Wire1 ...
+
+#endif	// SALT_SIM_BUS_H_
@@ -0,0 +1,21 @@
+#ifndef SALT_HOST_UTILITIES_H_
+#define SALT_HOST_UTILITIES_H_
+
+// SALT_utilities.h host stand-in; ui_display_update() writes display_text to stdout through Serial
+
+#include <Arduino.h>
+
+#define	HABITAT_A		0
+#define	HABITAT_B		1
+
+class SALT_utilities
+	{
+	public:
+		char		display_text[128];
+
+		void		ui_display_update (uint8_t habitat) {Serial.printf ("ui[%d]: %s\n", habitat, display_text);}
+	};
+
+extern SALT_utilities utils;
+
+#endif	// SALT_HOST_UTILITIES_H_
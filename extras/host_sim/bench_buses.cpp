@@ -0,0 +1,95 @@
+// bench_buses.cpp
+//
+// Host benchmark: scan time of a two-habitat system with both mux boards on one bus and with each habitat on its
+// own bus.  Each mux board carries mux-mounted TMP275 and HDC1080 and ports single-sensor ports.  Configurations:
+//	single		one habitat: mux[0] on Wire1
+//	shared		two habitats: mux[0] and mux[1] on Wire1 (the paralleled muxes)
+//	split		two habitats: mux[0] on Wire1, mux[1] on Wire2 (mux_bus_set())
+// For each, discovers the system and runs passes of sensor_scan() and of scan_async() at the example loop()
+// cadence.
+//
+// Output is CSV on stdout, one row per configuration and scan kind:
+//	config,kind,passes,elapsed_us,bus_us,transactions
+// elapsed_us is the mean time from the start of a pass to its end; bus_us and transactions are per pass, summed
+// over both buses.
+//
+//	bench_buses [passes [rate_khz [ports]]]		defaults: 100 passes, 100kHz, 4 ports
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+typedef void (*run_t) (SALT_ext_sensors* ext);
+
+static void scan (SALT_ext_sensors* ext) {ext->sensor_scan ();}
+static void async (SALT_ext_sensors* ext) {while (SCAN_BUSY == ext->scan_async ()) delayMicroseconds (20);}
+
+SALT_ext_bus	wire2_bus {Wire2, "Wire2", I2C_PINS_3_4};
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// build the configuration, discover it, and print the mean of passes passes of pass
+//
+
+static void run (const char* config, uint8_t muxes, boolean split, const char* kind, run_t pass, uint32_t passes, uint32_t rate_khz, uint8_t ports)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	uint64_t			elapsed_ns = 0;
+	uint64_t			bus_ns = 0;
+	uint32_t			transactions = 0;
+	uint64_t			start_ns;
+
+	for (uint8_t b = 1; b <= 2; b++)
+		{
+		sim_bus[b].clear ();
+		sim_bus[b].rate_force (rate_khz * 1000);
+		}
+	for (uint8_t m = 0; m < muxes; m++)
+		sim_bus[(split && m) ? 2 : 1].sbs_board_add (m, ports);
+
+	if (split)
+		ext->mux_bus_set (1, wire2_bus);
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->log_drain ();
+
+	for (uint32_t n = 0; n < passes; n++)
+		{
+		delay (5000);											// example loop() cadence
+		sim_bus[1].stats_clear ();
+		sim_bus[2].stats_clear ();
+		start_ns = sim_now_ns;
+		pass (ext);
+		elapsed_ns += sim_now_ns - start_ns;
+		bus_ns += sim_bus[1].stats.bus_ns + sim_bus[2].stats.bus_ns;
+		transactions += sim_bus[1].stats.transactions + sim_bus[2].stats.transactions;
+		ext->log_drain ();
+		}
+
+	if (passes)
+		printf ("%s,%s,%u,%.1f,%.1f,%u\n", config, kind, passes, elapsed_ns / 1e3 / passes, bus_ns / 1e3 / passes, transactions / passes);
+	delete ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	passes = (1 < argc) ? atoi (argv[1]) : 100;
+	uint32_t	rate_khz = (2 < argc) ? atoi (argv[2]) : 100;
+	uint8_t		ports = (3 < argc) ? atoi (argv[3]) : 4;
+	const char*	kinds[] = {"scan", "async"};
+	run_t		runs[] = {scan, async};
+
+	Serial.echo = false;
+	printf ("config,kind,passes,elapsed_us,bus_us,transactions\n");
+	for (uint8_t k = 0; k < 2; k++)
+		{
+		run ("single", 1, false, kinds[k], runs[k], passes, rate_khz, ports);
+		run ("shared", 2, false, kinds[k], runs[k], passes, rate_khz, ports);
+		run ("split", 2, true, kinds[k], runs[k], passes, rate_khz, ports);
+		}
+	return 0;
+	}
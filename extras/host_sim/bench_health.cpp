@@ -0,0 +1,55 @@
+// bench_health.cpp
+//
+// Host benchmark: scan cost of a dead sensor with health tracking.  Builds an SBS (two mux boards, each with
+// mux-mounted TMP275 and HDC1080, and four single-sensor ports), discovers it, and runs passes of sensor_scan() at
+// the example loop() cadence.  The mux[0].port[3] sensor stops responding at pass 10 and comes back at pass 150.
+//
+// Output is CSV on stdout, one row per pass:
+//	pass,elapsed_us,bus_us,transactions,naks,backoff,faults
+// backoff and faults are backoff_get() and faults_get() for mux[0].port[3].sensor[0] after the pass.
+//
+//	bench_health [passes]		default 300
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+SALT_ext_sensors	ext_sensors;
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t			passes = (1 < argc) ? atoi (argv[1]) : 300;
+	SALT_sim_tmp275*	dead;
+	uint8_t				addr;
+	uint64_t			start_ns;
+
+	sim_bus[1].sbs_add ();
+	dead = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 0, 3);
+	addr = dead->addr;
+
+	Serial.echo = false;
+	ext_sensors.sensor_discover ();
+	ext_sensors.log_drain ();
+
+	printf ("pass,elapsed_us,bus_us,transactions,naks,backoff,faults\n");
+	for (uint32_t n = 0; n < passes; n++)
+		{
+		if (10 == n)
+			dead->addr = 0x7F;									// stops responding
+		else if (150 == n)
+			dead->addr = addr;									// back
+
+		delay (5000);											// example loop() cadence
+		sim_bus[1].stats_clear ();
+		start_ns = sim_now_ns;
+		ext_sensors.sensor_scan ();
+		printf ("%u,%.1f,%.1f,%u,%u,%u,%u\n", n, (sim_now_ns - start_ns) / 1e3, sim_bus[1].stats.bus_ns / 1e3,
+			sim_bus[1].stats.transactions, sim_bus[1].stats.addr_naks + sim_bus[1].stats.data_naks,
+			ext_sensors.backoff_get (0, 3, 0), ext_sensors.faults_get (0, 3, 0));
+		ext_sensors.log_drain ();
+		}
+	return 0;
+	}
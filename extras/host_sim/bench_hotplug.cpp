@@ -0,0 +1,90 @@
+// bench_hotplug.cpp
+//
+// Host benchmark: hot-plug rediscovery.  Builds an SBS system (two mux boards, each with mux-mounted TMP275 and
+// HDC1080, and four single-sensor ports) on Wire1, discovers it, and runs passes of sensor_scan() at the example
+// loop() cadence with hot-plug off and then on at several slices.  The mux[0].port[3] sensor is unplugged at pass
+// 20, and a sensor is plugged into mux[1].port[5] (past the empty port[4], where sensor_discover() stops looking)
+// half way through.
+//
+// Output is CSV on stdout, one row per run:
+//	hotplug,slice_us,passes,bus_us,hotplug_us,max_hotplug_us,remove_passes,add_passes,sensors
+// bus_us is the per-pass mean, hotplug_us the mean time hot-plug probing added to a pass (hotplug_stats.us) and
+// max_hotplug_us the most it added to one pass.  remove_passes and add_passes are the passes from the unplug and
+// the plug until the registry changed (0: it didn't).  sensors is the registry size after the last pass.
+//
+//	bench_hotplug [passes]		default 400
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+
+static void run (boolean hotplug, uint32_t slice_us, uint32_t passes)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	SALT_sim_device*	unplug[2];							// mux[0].port[3] sensor node: tmp275 and eeprom
+	uint64_t			bus_ns = 0;
+	uint32_t			hotplug_us;
+	uint32_t			max_us = 0;
+	uint32_t			remove_passes = 0;
+	uint32_t			add_passes = 0;
+	uint8_t				sensors;
+
+	sim_bus[1].clear ();
+	sim_bus[1].sbs_add ();
+	unplug[0] = sim_bus[1].find (SIM_TMP275_BASE, 0, 3);
+	unplug[1] = sim_bus[1].find (SIM_EEP_BASE, 0, 3);
+
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->hotplug_set (hotplug);
+	ext->hotplug_slice_set (slice_us);
+	ext->log_drain ();
+
+	for (uint32_t n = 0; n < passes; n++)
+		{
+		if (20 == n)
+			{
+			unplug[0]->present = false;
+			unplug[1]->present = false;
+			}
+		if ((passes / 2) == n)
+			sim_bus[1].port_sensor_add (1, 5, 0, 30.0);
+
+		delay (5000);												// example loop() cadence
+		sim_bus[1].stats_clear ();
+		sensors = ext->sensor_count;
+		hotplug_us = ext->hotplug_stats.us;
+		ext->sensor_scan ();
+		bus_ns += sim_bus[1].stats.bus_ns;
+		if ((ext->hotplug_stats.us - hotplug_us) > max_us)
+			max_us = ext->hotplug_stats.us - hotplug_us;
+		if ((sensors > ext->sensor_count) && !remove_passes)
+			remove_passes = n + 1 - 20;
+		if ((sensors < ext->sensor_count) && !add_passes)
+			add_passes = n + 1 - (passes / 2);
+		ext->log_drain ();
+		}
+
+	printf ("%d,%u,%u,%.1f,%.1f,%u,%u,%u,%u\n", hotplug, slice_us, passes, bus_ns / 1e3 / passes,
+		(double)ext->hotplug_stats.us / passes, max_us, remove_passes, add_passes, ext->sensor_count);
+	delete ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	passes = (1 < argc) ? atoi (argv[1]) : 400;
+	uint32_t	slices[] = {250, 1000, 4000};
+
+	Serial.echo = false;
+	printf ("hotplug,slice_us,passes,bus_us,hotplug_us,max_hotplug_us,remove_passes,add_passes,sensors\n");
+	run (false, HOTPLUG_SLICE_DEFAULT_US, passes);
+	for (uint8_t i = 0; i < 3; i++)
+		run (true, slices[i], passes);
+	return 0;
+	}
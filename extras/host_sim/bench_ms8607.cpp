@@ -0,0 +1,106 @@
+// bench_ms8607.cpp
+//
+// Host benchmark: scan cost of a mux-mounted MS8607 at each oversampling ratio compared with an HDC1080.  Builds
+// one mux board with a mux-mounted TMP275 and either an HDC1080 or an MS8607 (22.5C, 45%RH, 1002.5mbar) and four
+// single-sensor ports, discovers it, and runs passes of sensor_scan() and of scan_async() at the example loop()
+// cadence.
+//
+// Output is CSV on stdout, one row per sensor, oversampling ratio and scan kind:
+//	sensor,osr,kind,passes,elapsed_us,bus_us,transactions,deg_c,rh,mbar
+// elapsed_us, bus_us and transactions are per pass; deg_c, rh and mbar are the mux humidity part's readings after
+// the last pass (mbar is 0 for the HDC1080).
+//
+//	bench_ms8607 [passes [rate_khz]]		defaults: 100 passes, 100kHz
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+typedef void (*run_t) (SALT_ext_sensors* ext);
+
+static void scan (SALT_ext_sensors* ext) {ext->sensor_scan ();}
+static void async (SALT_ext_sensors* ext) {while (SCAN_BUSY == ext->scan_async ()) delayMicroseconds (20);}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// build the board, discover it, and print the mean of passes passes of pass.  osr is MS8607_OSR_xxx or
+// MS8607_OSRS for the HDC1080 board.
+//
+
+static void run (uint8_t osr, const char* kind, run_t pass, uint32_t passes, uint32_t rate_khz)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	boolean				ms8607 = (MS8607_OSRS > osr);
+	uint64_t			elapsed_ns = 0;
+	uint64_t			bus_ns = 0;
+	uint32_t			transactions = 0;
+	uint64_t			start_ns;
+	float				deg_c;
+	float				rh;
+	float				mbar = 0;
+
+	sim_bus[1].clear ();
+	sim_bus[1].rate_force (rate_khz * 1000);
+	sim_bus[1].mux_board_add (0, true, !ms8607, 22.5, 45.0);
+	if (ms8607)
+		sim_bus[1].ms8607_add (0, 22.5, 45.0, 1002.5);
+	for (uint8_t p = 0; p < 4; p++)
+		sim_bus[1].port_sensor_add (0, p, 0, 20.0 + p);
+
+	if (ms8607)
+		ext->ms8607_osr_set (osr);
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->log_drain ();
+
+	for (uint32_t n = 0; n < passes; n++)
+		{
+		delay (5000);											// example loop() cadence
+		sim_bus[1].stats_clear ();
+		start_ns = sim_now_ns;
+		pass (ext);
+		elapsed_ns += sim_now_ns - start_ns;
+		bus_ns += sim_bus[1].stats.bus_ns;
+		transactions += sim_bus[1].stats.transactions;
+		ext->log_drain ();
+		}
+
+	if (ms8607)
+		{
+		deg_c = ext->mux_ms8607_data_ptr_get (0)->deg_c;
+		rh = ext->mux_ms8607_data_ptr_get (0)->rh;
+		mbar = ext->mux_ms8607_data_ptr_get (0)->mbar;
+		}
+	else
+		{
+		deg_c = ext->mux_hdc1080_data_ptr_get (0)->deg_c;
+		rh = ext->mux_hdc1080_data_ptr_get (0)->rh;
+		}
+
+	if (passes)
+		printf ("%s,%u,%s,%u,%.1f,%.1f,%u,%.2f,%.2f,%.2f\n", ms8607 ? "ms8607" : "hdc1080", ms8607 ? (256 << osr) : 0, kind,
+			passes, elapsed_ns / 1e3 / passes, bus_ns / 1e3 / passes, transactions / passes, deg_c, rh, mbar);
+	delete ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	passes = (1 < argc) ? atoi (argv[1]) : 100;
+	uint32_t	rate_khz = (2 < argc) ? atoi (argv[2]) : 100;
+	const char*	kinds[] = {"scan", "async"};
+	run_t		runs[] = {scan, async};
+
+	Serial.echo = false;
+	printf ("sensor,osr,kind,passes,elapsed_us,bus_us,transactions,deg_c,rh,mbar\n");
+	for (uint8_t k = 0; k < 2; k++)
+		{
+		run (MS8607_OSRS, kinds[k], runs[k], passes, rate_khz);
+		for (uint8_t osr = MS8607_OSR_256; osr < MS8607_OSRS; osr++)
+			run (osr, kinds[k], runs[k], passes, rate_khz);
+		}
+	return 0;
+	}
@@ -0,0 +1,118 @@
+// bench_pipeline.cpp
+//
+// Host benchmark: cost of the measurement pipeline with and without the drivers' float data struct fields.  Builds
+// an SBS (two mux boards, each with mux-mounted TMP275 and HDC1080, and four single-sensor ports), discovers it,
+// then for data_float_set (true) and data_float_set (false):
+//	scan		passes of scan_async() at the example loop() cadence; cpu_ns is host (real) time spent inside the
+//				scan_async() calls, excluding the bus models
+//	convert		meas_convert() alone with every channel fresh; cpu_ns is per call
+//	publish		snapshot_publish() alone, the end-of-pass copy into the published snapshot; cpu_ns is per call
+//	thresh		convert again with a threshold subscription (thresh_add()) on every sensor's temperature and both
+//				humidities, none crossing
+//
+// Output is CSV on stdout:
+//	kind,data_float,iterations,cpu_ns
+// compare rows of the same run only.
+//
+//	bench_pipeline [scans [converts]]		defaults: 1000 scans, 1000000 converts
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+class bench_sensors : public SALT_ext_sensors					// reaches the protected pipeline
+	{
+	public:
+		uint64_t	convert_run (uint32_t converts)
+			{
+			uint64_t	start_ns = SALT_sim_bus::host_now_ns ();
+
+			for (uint32_t n = 0; n < converts; n++)
+				{
+				raw_fresh = (1UL << MEAS_CHANNELS) - 1;				// as if every channel were read this pass
+				meas_convert ();
+				}
+			return SALT_sim_bus::host_now_ns () - start_ns;
+			}
+
+		uint64_t	publish_run (uint32_t publishes)
+			{
+			uint64_t	start_ns = SALT_sim_bus::host_now_ns ();
+
+			for (uint32_t n = 0; n < publishes; n++)
+				snapshot_publish ();
+			return SALT_sim_bus::host_now_ns () - start_ns;
+			}
+	};
+
+bench_sensors	bench;
+
+static void thresh_cb (const SALT_ext_sensors::thresh_t* thresh) {}
+
+
+//---------------------------< S C A N _ R U N >--------------------------------------------------------------
+//
+// scans passes of scan_async(); returns host time spent inside the calls less the bus models' time
+//
+
+static uint64_t scan_run (uint32_t scans)
+	{
+	uint64_t	cpu_ns = 0;
+	uint64_t	host_ns;
+	uint8_t		ret_val;
+
+	for (uint32_t n = 0; n < scans; n++)
+		{
+		delay (5000);											// example loop() cadence
+		sim_bus[1].stats_clear ();
+		do
+			{
+			host_ns = SALT_sim_bus::host_now_ns ();
+			ret_val = bench.scan_async ();
+			cpu_ns += SALT_sim_bus::host_now_ns () - host_ns;
+			delayMicroseconds (20);								// other loop() work between calls
+			}
+		while (SCAN_BUSY == ret_val);
+		cpu_ns -= sim_bus[1].stats.host_ns;
+		bench.log_drain ();
+		}
+	return cpu_ns;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	scans = (1 < argc) ? atoi (argv[1]) : 1000;
+	uint32_t	converts = (2 < argc) ? atoi (argv[2]) : 1000000;
+
+	sim_bus[1].sbs_add ();
+
+	Serial.echo = false;
+	bench.sensor_discover ();
+	bench.log_drain ();
+
+	printf ("kind,data_float,iterations,cpu_ns\n");
+	for (uint8_t data_float = 2; data_float--; )				// float path first
+		{
+		bench.data_float_set (data_float);
+		scan_run (1);											// warm up
+		printf ("scan,%d,%u,%llu\n", data_float, scans, (unsigned long long)(scans ? scan_run (scans) / scans : 0));
+		printf ("convert,%d,%u,%.1f\n", data_float, converts, converts ? (double)bench.convert_run (converts) / converts : 0.0);
+		printf ("publish,%d,%u,%.1f\n", data_float, converts, converts ? (double)bench.publish_run (converts) / converts : 0.0);
+
+		for (uint8_t m = 0; m < 2; m++)
+			{
+			for (uint8_t p = 0; p < 4; p++)
+				bench.thresh_add (m, p, 0, THRESH_C, 1000, 4000, 50, thresh_cb);
+			bench.thresh_add (m, 7, 0, THRESH_C, 1000, 4000, 50, thresh_cb);
+			bench.thresh_add (m, 7, 1, THRESH_C, 1000, 4000, 50, thresh_cb);
+			bench.thresh_add (m, 7, 1, THRESH_RH, 2000, 8000, 100, thresh_cb);
+			}
+		printf ("thresh,%d,%u,%.1f\n", data_float, converts, converts ? (double)bench.convert_run (converts) / converts : 0.0);
+		for (uint8_t i = 0; i < THRESH_MAX; i++)
+			bench.thresh_remove (i);
+		}
+	return 0;
+	}
@@ -0,0 +1,125 @@
+// bench_polling.cpp
+//
+// Host benchmark: bus time saved by adaptive polling.  Builds an SBS (two mux boards, each with mux-mounted TMP275
+// and HDC1080, and four single-sensor ports) and runs an hour of scan passes at the example loop() cadence with
+// adaptive polling off and then on, with sensor_scan() and with scan_async().  All sensors are steady except:
+//	mux[0].port[0]		drifts 0.01°C per pass
+//	mux[1].port[2]		steps up 2°C at the half hour (a drawer opened)
+// and the control loop asks for mux[1].port[3] at full rate (poll_snap()) every 60 passes.
+//
+// Output is CSV on stdout, one row per run:
+//	kind,adaptive,passes,bus_us,transactions,mux_writes,saved_us_per_hour,estimate_us_per_hour,step_passes
+// saved_us_per_hour is the measured bus time saved compared with the adaptive=0 row of the same kind;
+// estimate_us_per_hour is what poll_saved_get() reported.  step_passes is the number of passes after the step
+// until meas showed it.  With split, mux[1] is on Wire2 (mux_bus_set()) with a 400kHz base rate while mux[0] stays
+// on Wire1 at 100kHz, and the buses are not forced to a rate, so the two branches save bus time at different rates.
+//
+//	bench_polling [rate_khz | split]		default 100kHz
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+#define	PASSES		720									// an hour at 5S per pass
+
+typedef void (*run_t) (SALT_ext_sensors* ext);
+
+SALT_ext_bus	wire2_bus {Wire2, "Wire2", I2C_PINS_3_4};
+
+static void scan (SALT_ext_sensors* ext) {ext->sensor_scan ();}
+static void async (SALT_ext_sensors* ext) {while (SCAN_BUSY == ext->scan_async ()) delayMicroseconds (20);}
+
+struct result_t
+	{
+	uint64_t	bus_ns;
+	uint32_t	transactions;
+	uint32_t	mux_writes;
+	uint32_t	estimate;
+	uint32_t	step_passes;
+	};
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// build the system, discover it, and run an hour of passes; rate_khz 0 is split
+//
+
+static result_t run (run_t pass, boolean adaptive, uint32_t rate_khz)
+	{
+	boolean				split = !rate_khz;
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	SALT_sim_tmp275*	drift;
+	SALT_sim_tmp275*	step;
+	uint8_t				n;
+	result_t			result;
+
+	for (uint8_t b = 1; b <= 2; b++)
+		{
+		sim_bus[b].clear ();
+		sim_bus[b].rate_force (rate_khz * 1000);
+		}
+	if (split)
+		{
+		sim_bus[1].sbs_board_add (0);
+		sim_bus[2].sbs_board_add (1);
+		wire2_bus.rate = I2C_RATE_400;
+		ext->mux_bus_set (1, wire2_bus);
+		}
+	else
+		sim_bus[1].sbs_add ();
+	drift = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 0, 0);
+	step = (SALT_sim_tmp275*)sim_bus[split ? 2 : 1].find (SIM_TMP275_BASE, 1, 2);
+
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->poll_adaptive_set (adaptive);
+	n = ext->meas_channel_get (1, 2, 0);
+
+	memset (&result, 0, sizeof(result));
+	sim_bus[1].stats_clear ();
+	sim_bus[2].stats_clear ();
+	for (uint32_t i = 0; i < PASSES; i++)
+		{
+		delay (5000);											// example loop() cadence
+		drift->deg_c += 0.01;
+		if ((PASSES / 2) == i)
+			step->deg_c += 2.0;
+		if (0 == (i % 60))
+			ext->poll_snap (1, 3, 0);
+		pass (ext);
+		ext->log_drain ();
+		if ((PASSES / 2) <= i && !result.step_passes && (2300 < ext->meas.centi_c[n]))	// 22.00 before the step
+			result.step_passes = i - (PASSES / 2) + 1;
+		}
+
+	result.bus_ns = sim_bus[1].stats.bus_ns + sim_bus[2].stats.bus_ns;
+	result.transactions = sim_bus[1].stats.transactions + sim_bus[2].stats.transactions;
+	result.mux_writes = sim_bus[1].stats.mux_writes + sim_bus[2].stats.mux_writes;
+	result.estimate = ext->poll_saved_get ();
+	delete ext;
+	return result;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t		rate_khz = (1 < argc) ? atoi (argv[1]) : 100;	// 0: split
+	const char*		kinds[] = {"scan", "async"};
+	run_t			passes[] = {scan, async};
+	result_t		full;
+	result_t		adaptive;
+
+	Serial.echo = false;
+	printf ("kind,adaptive,passes,bus_us,transactions,mux_writes,saved_us_per_hour,estimate_us_per_hour,step_passes\n");
+	for (uint8_t k = 0; k < 2; k++)
+		{
+		full = run (passes[k], false, rate_khz);
+		adaptive = run (passes[k], true, rate_khz);
+		printf ("%s,0,%u,%.1f,%u,%u,0,0,%u\n", kinds[k], PASSES, full.bus_ns / 1e3, full.transactions, full.mux_writes, full.step_passes);
+		printf ("%s,1,%u,%.1f,%u,%u,%.0f,%u,%u\n", kinds[k], PASSES, adaptive.bus_ns / 1e3, adaptive.transactions, adaptive.mux_writes,
+			(full.bus_ns - adaptive.bus_ns) / 1e3, adaptive.estimate, adaptive.step_passes);
+		}
+	return 0;
+	}
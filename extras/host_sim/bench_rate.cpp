@@ -0,0 +1,94 @@
+// bench_rate.cpp
+//
+// Host benchmark: automatic I2C rate selection.  Builds an SSWEC system (two mux boards, each with mux-mounted
+// TMP275 and HDC1080, and six single-sensor ports) on Wire1.  The mux[0] drawer cables are good at any rate; the
+// mux[1] cables are reliable only up to 300kHz.  Runs passes of scan_async() at the example loop() cadence with
+// auto rate off and on.  In the on run the mux[0] cables degrade to 250kHz at the half way pass.
+//
+// Output is CSV on stdout, one row per run and half (passes before and after the half way pass):
+//	auto,half,passes,bus_us,transactions,errors,rate0_khz,rate1_khz,ups,downs
+// bus_us and transactions are per-pass means.  errors is the scan pass transfers that failed on both branches,
+// rate0_khz and rate1_khz are rate_get() at the end of the half, and ups and downs are the steps taken in it
+// summed over both branches.
+//
+//	bench_rate [passes]		default 400
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+
+static void run (boolean rate_auto, uint32_t passes)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	SALT_sim_pca9548a*	muxes[2];
+	uint32_t			errors = 0;
+	uint16_t			ups;
+	uint16_t			downs;
+
+	sim_bus[1].clear ();
+	for (uint8_t m = 0; m < 2; m++)
+		muxes[m] = sim_bus[1].sbs_board_add (m, 6);
+	muxes[1]->cable_hz = 300000;
+
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->rate_auto_set (rate_auto);
+	ext->log_drain ();
+
+	for (uint8_t half = 0; half < 2; half++)
+		{
+		uint64_t	bus_ns = 0;
+		uint32_t	transactions = 0;
+
+		if (half && rate_auto)
+			muxes[0]->cable_hz = 250000;							// mux[0] cables degrade
+		ups = downs = 0;
+		for (uint8_t m = 0; m < 2; m++)
+			{
+			ups -= ext->rate_stats_ptr_get (m)->ups;
+			downs -= ext->rate_stats_ptr_get (m)->downs;
+			for (uint8_t r = 0; r < RATE_STEPS; r++)
+				errors -= ext->rate_stats_ptr_get (m)->errors[r];
+			}
+
+		for (uint32_t n = 0; n < passes / 2; n++)
+			{
+			delay (5000);											// example loop() cadence
+			sim_bus[1].stats_clear ();
+			while (SCAN_BUSY == ext->scan_async ())
+				delayMicroseconds (20);
+			bus_ns += sim_bus[1].stats.bus_ns;
+			transactions += sim_bus[1].stats.transactions;
+			ext->log_drain ();
+			}
+
+		for (uint8_t m = 0; m < 2; m++)
+			{
+			ups += ext->rate_stats_ptr_get (m)->ups;
+			downs += ext->rate_stats_ptr_get (m)->downs;
+			for (uint8_t r = 0; r < RATE_STEPS; r++)
+				errors += ext->rate_stats_ptr_get (m)->errors[r];
+			}
+		printf ("%d,%u,%u,%.1f,%u,%u,%u,%u,%u,%u\n", rate_auto, half, passes / 2, bus_ns / 1e3 / (passes / 2),
+			transactions / (passes / 2), errors, ext->rate_get (0) / 1000, ext->rate_get (1) / 1000, ups, downs);
+		errors = 0;
+		}
+	delete ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	passes = (1 < argc) ? atoi (argv[1]) : 400;
+
+	Serial.echo = false;
+	printf ("auto,half,passes,bus_us,transactions,errors,rate0_khz,rate1_khz,ups,downs\n");
+	run (false, passes);
+	run (true, passes);
+	return 0;
+	}
@@ -0,0 +1,154 @@
+// bench_telemetry.cpp
+//
+// Host benchmark: size and cost of the binary telemetry records.  Builds an SBS system (two mux boards with
+// mux-mounted TMP275s, an HDC1080 on mux[0] and an MS8607 on mux[1], and four single-sensor ports on each),
+// discovers it, sets a telemetry sink, and runs passes of sensor_scan() at the example loop() cadence:
+//	steady		nothing changes
+//	drift		every temperature, both humidities and the pressure wander a little each pass
+// then times telemetry_encode() alone.
+//
+// Output is CSV on stdout, one row per run:
+//	kind,passes,records,keys,bytes_per_record,key_bytes,delta_bytes,max_bytes,encode_ns
+// key_bytes and delta_bytes are the mean sizes of the key and the other records, max_bytes the largest record,
+// and encode_ns the host time per telemetry_encode() call.  With a file name the drift run's records are written
+// to it; telemetry_decode converts them to CSV.
+//
+//	bench_telemetry [passes [file]]		default 1000 passes, no file
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+class bench_sensors : public SALT_ext_sensors					// reaches the protected encoder
+	{
+	public:
+		uint64_t	encode_run (uint32_t encodes)
+			{
+			uint64_t	start_ns = SALT_sim_bus::host_now_ns ();
+
+			for (uint32_t n = 0; n < encodes; n++)
+				telemetry_encode (meas.valid, 0);				// as if every channel were read this pass
+			return SALT_sim_bus::host_now_ns () - start_ns;
+			}
+	};
+
+struct sink_t													// what the sink saw
+	{
+	FILE*		file;
+	uint32_t	keys;
+	uint32_t	deltas;
+	uint32_t	key_bytes;
+	uint32_t	delta_bytes;
+	uint16_t	max_bytes;
+	};
+
+static uint32_t	lcg = 1;
+
+
+//---------------------------< W A N D E R >------------------------------------------------------------------
+//
+// add a step of -step, 0 or +step to *value
+//
+
+static void wander (float* value, float step)
+	{
+	lcg = (lcg * 1103515245) + 12345;
+	*value += step * (float)((int)((lcg >> 16) % 3) - 1);
+	}
+
+
+//---------------------------< S I N K >----------------------------------------------------------------------
+
+static void sink (const uint8_t* record, uint16_t len, void* ctx)
+	{
+	sink_t*		sink_ptr = (sink_t*)ctx;
+
+	if (record[1] & TELEMETRY_KEY)
+		{
+		sink_ptr->keys++;
+		sink_ptr->key_bytes += len;
+		}
+	else
+		{
+		sink_ptr->deltas++;
+		sink_ptr->delta_bytes += len;
+		}
+	if (len > sink_ptr->max_bytes)
+		sink_ptr->max_bytes = len;
+	if (sink_ptr->file)
+		fwrite (record, 1, len, sink_ptr->file);
+	}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+
+static void run (boolean drift, uint32_t passes, const char* file_name)
+	{
+	bench_sensors*		ext = new bench_sensors ();
+	SALT_sim_tmp275*	tmp275[2][5];							// [m][0 .. 3]: port sensors; [m][4]: mux-mounted
+	SALT_sim_hdc1080*	hdc1080;
+	SALT_sim_ms8607_pt*	ms8607;
+	sink_t				seen = {};
+	uint32_t			encodes = passes * 100;
+
+	sim_bus[1].clear ();
+	for (uint8_t m = 0; m < 2; m++)
+		{
+		sim_bus[1].sbs_board_add (m, 4, 0 == m);				// mux[1] gets the MS8607
+		for (uint8_t p = 0; p < 4; p++)
+			tmp275[m][p] = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, m, p);
+		tmp275[m][4] = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE | 7, m, 7);
+		}
+	ms8607 = sim_bus[1].ms8607_add (1, 23.0, 41.0, 1002.5);
+	hdc1080 = (SALT_sim_hdc1080*)sim_bus[1].find (SIM_HDC1080_ADDR, 0, 7);
+
+	if (drift && file_name)
+		seen.file = fopen (file_name, "wb");
+
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->telemetry_sink_set (sink, &seen);
+	ext->log_drain ();
+
+	for (uint32_t n = 0; n < passes; n++)
+		{
+		if (drift)
+			{
+			for (uint8_t m = 0; m < 2; m++)
+				for (uint8_t t = 0; t < 5; t++)
+					wander (&tmp275[m][t]->deg_c, 0.0625);		// one TMP275 lsb
+			wander (&hdc1080->deg_c, 0.05);
+			wander (&hdc1080->rh, 0.1);
+			wander (&ms8607->deg_c, 0.05);
+			wander (&ms8607->mbar, 0.05);
+			}
+		delay (5000);											// example loop() cadence
+		ext->sensor_scan ();
+		ext->log_drain ();
+		}
+
+	if (seen.file)
+		fclose (seen.file);
+
+	printf ("%s,%u,%u,%u,%.1f,%.1f,%.1f,%u,%.1f\n", drift ? "drift" : "steady", passes,
+		ext->telemetry_stats.records, ext->telemetry_stats.keys,
+		ext->telemetry_stats.records ? (double)ext->telemetry_stats.bytes / ext->telemetry_stats.records : 0.0,
+		seen.keys ? (double)seen.key_bytes / seen.keys : 0.0, seen.deltas ? (double)seen.delta_bytes / seen.deltas : 0.0,
+		seen.max_bytes, encodes ? (double)ext->encode_run (encodes) / encodes : 0.0);
+	delete ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	passes = (1 < argc) ? atoi (argv[1]) : 1000;
+	const char*	file_name = (2 < argc) ? argv[2] : NULL;
+
+	Serial.echo = false;
+	printf ("kind,passes,records,keys,bytes_per_record,key_bytes,delta_bytes,max_bytes,encode_ns\n");
+	run (false, passes, file_name);
+	run (true, passes, file_name);
+	return 0;
+	}
@@ -0,0 +1,216 @@
+// bench_topologies.cpp
+//
+// Host benchmark: for each supported habitat configuration (B2B: 3 ports, SBS & SS: 4, B2BWEC: 5, SSWEC: 6) with
+// one and with two mux boards, builds the system on the simulated bus, runs a full sensor_discover(), a warm
+// boot sensor_discover() on a second instance (restores the saved topology), and then cycles passes of
+// sensor_scan() at the example loop() cadence.  With one sensor per port, a third instance then runs the
+// compile-time topology path: sensor_discover_fixed() and cycles passes of sensor_scan_fixed() for the
+// SALT_ext_topology that describes the configuration; then both scans are repeated, on one instance set up by
+// sensor_discover_fixed(), with mux boards that have no HDC1080.  Every mux board carries a mux-mounted TMP275
+// and HDC1080; every port carries sensors_per_port TMP275 sensor nodes.
+//
+// Output is CSV on stdout, one row per discovery, per scan cycle, and per configuration summary:
+//	config,muxes,ports,sensors,kind,cycle,elapsed_us,bus_us,transactions,bytes,mux_writes,writes_saved,naks,cpu_ns
+// kind is one of: discover, warm_boot, scan, fixed_discover, fixed_scan, scan_nowait, fixed_scan_nowait; each
+// scan kind also has _mean and _worst summary rows.  The _nowait passes don't spin waiting on an HDC1080
+// conversion so their cpu_ns is scan work only.  elapsed_us includes time spent
+// waiting on HDC1080 conversions; bus_us is time the bus was busy.  writes_saved is the mux control writes the
+// library skipped because the mux was already set (mux_writes_saved_get()); mux_writes + writes_saved is what the
+// pass would have written without the cache.  cpu_ns is host (real) time spent in the
+// library and drivers, excluding the bus models; compare it between rows of the same run only.
+//
+//	bench_topologies [cycles [rate_khz [sensors_per_port]]]		defaults: 10 cycles, 100kHz, 1 sensor per port
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+typedef void (*run_t) (SALT_ext_sensors* ext);
+
+static void discover (SALT_ext_sensors* ext) {ext->sensor_discover ();}
+static void scan (SALT_ext_sensors* ext) {ext->sensor_scan ();}
+template <uint8_t MUXES, uint8_t PORTS, uint8_t MMS> static void discover_fixed (SALT_ext_sensors* ext) {ext->sensor_discover_fixed<SALT_ext_topology<MUXES, PORTS, 1, MMS> > ();}
+template <uint8_t MUXES, uint8_t PORTS, uint8_t MMS> static void scan_fixed (SALT_ext_sensors* ext) {ext->sensor_scan_fixed<SALT_ext_topology<MUXES, PORTS, 1, MMS> > ();}
+
+struct config_t
+	{
+	const char*	name;
+	uint8_t		ports;
+	run_t		discover_fixed[2][MAX_MUXES];			// [nowait][muxes - 1]; one sensor per port
+	run_t		scan_fixed[2][MAX_MUXES];
+	};
+
+#define	FIXED(run, ports)	{{run<1, ports, TMP275 | HDC1080>, run<2, ports, TMP275 | HDC1080> }, {run<1, ports, TMP275>, run<2, ports, TMP275> }}
+#define	CONFIG(name, ports)	{name, ports, FIXED (discover_fixed, ports), FIXED (scan_fixed, ports)}
+
+static const config_t configs[] =
+	{
+	CONFIG ("B2B",		3),
+	CONFIG ("SBS",		4),
+	CONFIG ("SS",		4),
+	CONFIG ("B2BWEC",	5),
+	CONFIG ("SSWEC",	6),
+	};
+
+struct sample_t
+	{
+	uint64_t	elapsed_ns;
+	uint64_t	cpu_ns;
+	uint32_t	writes_saved;
+	SALT_sim_bus::stats_t	stats;
+	};
+
+
+//---------------------------< R O W >------------------------------------------------------------------------
+
+static void row (const config_t* config, uint8_t muxes, uint8_t sensors, const char* kind, uint32_t cycle, const sample_t* sample)
+	{
+	printf ("%s,%d,%d,%d,%s,%u,%.1f,%.1f,%u,%u,%u,%u,%u,%llu\n", config->name, muxes, config->ports, sensors, kind, cycle,
+		sample->elapsed_ns / 1e3, sample->stats.bus_ns / 1e3, sample->stats.transactions, sample->stats.bytes,
+		sample->stats.mux_writes, sample->writes_saved, sample->stats.addr_naks + sample->stats.data_naks, (unsigned long long)sample->cpu_ns);
+	}
+
+
+//---------------------------< M E A S U R E >----------------------------------------------------------------
+//
+// call run (ext) and return elapsed time, host cpu time, mux writes saved and bus stats
+//
+
+static sample_t measure (SALT_ext_sensors* ext, run_t run)
+	{
+	sample_t	sample;
+	uint64_t	start_ns;
+	uint64_t	host_ns;
+	uint32_t	saved = ext->mux_writes_saved_get ();
+
+	sim_bus[1].stats_clear ();
+	start_ns = sim_now_ns;
+	host_ns = SALT_sim_bus::host_now_ns ();
+	run (ext);
+	sample.cpu_ns = SALT_sim_bus::host_now_ns () - host_ns - sim_bus[1].stats.host_ns;
+	sample.elapsed_ns = sim_now_ns - start_ns;
+	sample.writes_saved = ext->mux_writes_saved_get () - saved;
+	sample.stats = sim_bus[1].stats;
+	return sample;
+	}
+
+
+//---------------------------< C Y C L E S >------------------------------------------------------------------
+//
+// cycles passes of run (ext) at the example loop() cadence; one row per pass plus <kind>_mean and <kind>_worst
+//
+
+static void cycles_run (const config_t* config, uint8_t muxes, uint8_t sensors, SALT_ext_sensors* ext, run_t run, const char* kind, uint32_t cycles)
+	{
+	sample_t	sample;
+	sample_t	mean;
+	sample_t	worst;
+	char		summary[32];
+
+	memset (&mean, 0, sizeof(mean));
+	memset (&worst, 0, sizeof(worst));
+	for (uint32_t n = 0; n < cycles; n++)
+		{
+		delay (5000);											// example loop() cadence
+		sample = measure (ext, run);
+		row (config, muxes, sensors, kind, n, &sample);
+
+		mean.elapsed_ns += sample.elapsed_ns;
+		mean.cpu_ns += sample.cpu_ns;
+		mean.stats.bus_ns += sample.stats.bus_ns;
+		mean.stats.transactions += sample.stats.transactions;
+		mean.stats.bytes += sample.stats.bytes;
+		mean.stats.mux_writes += sample.stats.mux_writes;
+		mean.writes_saved += sample.writes_saved;
+		mean.stats.addr_naks += sample.stats.addr_naks + sample.stats.data_naks;
+		if (sample.elapsed_ns > worst.elapsed_ns)
+			worst = sample;
+		}
+
+	if (cycles)
+		{
+		mean.elapsed_ns /= cycles;
+		mean.cpu_ns /= cycles;
+		mean.stats.bus_ns /= cycles;
+		mean.stats.transactions /= cycles;
+		mean.stats.bytes /= cycles;
+		mean.stats.mux_writes /= cycles;
+		mean.writes_saved /= cycles;
+		mean.stats.addr_naks /= cycles;
+		snprintf (summary, sizeof(summary), "%s_mean", kind);
+		row (config, muxes, sensors, summary, cycles, &mean);
+		snprintf (summary, sizeof(summary), "%s_worst", kind);
+		row (config, muxes, sensors, summary, cycles, &worst);
+		}
+	}
+
+
+//---------------------------< B U I L D >--------------------------------------------------------------------
+//
+// put the configuration on the simulated bus; without the mux-mounted HDC1080 when nowait is true
+//
+
+static void build (const config_t* config, uint8_t muxes, uint8_t sensors, uint32_t rate_khz, boolean nowait)
+	{
+	sim_bus[1].clear ();
+	sim_bus[1].rate_force (rate_khz * 1000);
+	for (uint8_t m = 0; m < muxes; m++)
+		{
+		sim_bus[1].mux_board_add (m, true, !nowait);
+		for (uint8_t p = 0; p < config->ports; p++)
+			for (uint8_t s = 0; s < sensors; s++)
+				sim_bus[1].port_sensor_add (m, p, s, 20.0 + s);
+		}
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	cycles = (1 < argc) ? atoi (argv[1]) : 10;
+	uint32_t	rate_khz = (2 < argc) ? atoi (argv[2]) : 100;
+	uint8_t		sensors = (3 < argc) ? atoi (argv[3]) : 1;
+
+	Serial.echo = false;
+	printf ("config,muxes,ports,sensors,kind,cycle,elapsed_us,bus_us,transactions,bytes,mux_writes,writes_saved,naks,cpu_ns\n");
+
+	for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+		{
+		for (uint8_t muxes = 1; muxes <= MAX_MUXES; muxes++)
+			{
+			SALT_ext_sensors*	ext = new SALT_ext_sensors ();		// fresh instance per configuration
+			sample_t			sample;
+
+			build (&configs[c], muxes, sensors, rate_khz, false);
+			ext->topology_forget ();									// full discovery regardless of the previous configuration
+			sample = measure (ext, discover);
+			row (&configs[c], muxes, sensors, "discover", 0, &sample);
+
+			SALT_ext_sensors*	warm = new SALT_ext_sensors ();
+			sample = measure (warm, discover);
+			row (&configs[c], muxes, sensors, "warm_boot", 0, &sample);
+			delete warm;
+
+			cycles_run (&configs[c], muxes, sensors, ext, scan, "scan", cycles);
+			delete ext;
+
+			if (1 != sensors)											// SALT_ext_topology instances are for one sensor per port
+				continue;
+
+			SALT_ext_sensors*	fixed = new SALT_ext_sensors ();
+			sample = measure (fixed, configs[c].discover_fixed[0][muxes - 1]);
+			row (&configs[c], muxes, sensors, "fixed_discover", 0, &sample);
+			cycles_run (&configs[c], muxes, sensors, fixed, configs[c].scan_fixed[0][muxes - 1], "fixed_scan", cycles);
+			delete fixed;
+
+			build (&configs[c], muxes, sensors, rate_khz, true);		// no HDC1080 conversion wait: cpu_ns is scan work only
+			fixed = new SALT_ext_sensors ();
+			configs[c].discover_fixed[1][muxes - 1] (fixed);			// both scans run on the same set up
+			cycles_run (&configs[c], muxes, sensors, fixed, scan, "scan_nowait", cycles);
+			cycles_run (&configs[c], muxes, sensors, fixed, configs[c].scan_fixed[1][muxes - 1], "fixed_scan_nowait", cycles);
+			delete fixed;
+			}
+		}
+	return 0;
+	}
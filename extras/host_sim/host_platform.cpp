@@ -0,0 +1,210 @@
+// host_platform.cpp
+//
+// definitions for the host stand-ins: simulated time, Serial, the i2c_t3 bus objects, and the SALT globals that
+// SALT_ext_sensors uses
+//
+
+#include <Arduino.h>
+#include <i2c_t3.h>
+#include <EEPROM.h>
+#include <SALT_exceptions.h>
+#include <SALT_logging.h>
+#include <SALT_utilities.h>
+#include <SALT_sim_bus.h>
+
+uint64_t			sim_now_ns;
+SALT_host_serial	Serial;
+SALT_host_eeprom	EEPROM;
+
+SALT_exceptions		e7n;
+SALT_logging		logs;
+SALT_utilities		utils;
+
+i2c_t3				Wire (0);
+i2c_t3				Wire1 (1);
+i2c_t3				Wire2 (2);
+i2c_t3				Wire3 (3);
+i2c_t3::i2c_state_t	i2c_t3::state[I2C_BUS_NUM];
+
+
+//---------------------------< T I M E >----------------------------------------------------------------------
+
+uint32_t millis (void)
+	{
+	sim_now_ns += SIM_CALL_NS;
+	return (uint32_t)(sim_now_ns / 1000000);
+	}
+
+uint32_t micros (void)
+	{
+	sim_now_ns += SIM_CALL_NS;
+	return (uint32_t)(sim_now_ns / 1000);
+	}
+
+void delay (uint32_t ms)
+	{
+	sim_now_ns += (uint64_t)ms * 1000000;
+	}
+
+void delayMicroseconds (uint32_t us)
+	{
+	sim_now_ns += (uint64_t)us * 1000;
+	}
+
+
+//---------------------------< S E R I A L >------------------------------------------------------------------
+
+int SALT_host_serial::printf (const char* format, ...)
+	{
+	va_list	args;
+	int		ret_val;
+
+	if (!echo)
+		return 0;
+
+	va_start (args, format);
+	ret_val = vprintf (format, args);
+	va_end (args);
+	return ret_val;
+	}
+
+
+//---------------------------< I 2 C _ T 3 >------------------------------------------------------------------
+
+void i2c_t3::begin (i2c_mode mode, uint8_t address, i2c_pins pins, i2c_pullup pullup, uint32_t rate, i2c_op_mode op_mode)
+	{
+	setRate (rate);
+	}
+
+void i2c_t3::setRate (uint32_t rate)
+	{
+	sim_bus[bus].rate_set (rate);
+	}
+
+uint32_t i2c_t3::getClock (void)
+	{
+	return sim_bus[bus].rate_get ();
+	}
+
+void i2c_t3::beginTransmission (uint8_t address)
+	{
+	state[bus].tx_addr = address;
+	state[bus].tx_len = 0;
+	}
+
+size_t i2c_t3::write (uint8_t data)
+	{
+	if (I2C_TX_BUFFER_LENGTH <= state[bus].tx_len)
+		{
+		state[bus].status = I2C_BUF_OVF;
+		return 0;
+		}
+	state[bus].tx_buf[state[bus].tx_len++] = data;
+	return 1;
+	}
+
+size_t i2c_t3::write (const uint8_t* data, size_t count)
+	{
+	size_t	n;
+
+	for (n = 0; (n < count) && write (data[n]); n++)
+		;
+	return n;
+	}
+
+uint8_t i2c_t3::endTransmission (i2c_stop stop)
+	{
+	uint8_t		ret_val;
+	uint64_t	host_ns;
+
+	finish ();
+	host_ns = SALT_sim_bus::host_now_ns ();
+	ret_val = sim_bus[bus].write (state[bus].tx_addr, state[bus].tx_buf, state[bus].tx_len, I2C_STOP == stop);
+	sim_bus[bus].stats.host_ns += SALT_sim_bus::host_now_ns () - host_ns;
+	state[bus].error = ret_val;
+	state[bus].status = (SIM_ACK == ret_val) ? I2C_WAITING : ((SIM_ADDR_NAK == ret_val) ? I2C_ADDR_NAK : I2C_DATA_NAK);
+	return ret_val;
+	}
+
+size_t i2c_t3::requestFrom (uint8_t address, size_t length, i2c_stop stop)
+	{
+	uint64_t	host_ns;
+
+	finish ();
+	if (I2C_RX_BUFFER_LENGTH < length)
+		length = I2C_RX_BUFFER_LENGTH;
+
+	host_ns = SALT_sim_bus::host_now_ns ();
+	state[bus].rx_len = sim_bus[bus].read (address, state[bus].rx_buf, length, I2C_STOP == stop);
+	sim_bus[bus].stats.host_ns += SALT_sim_bus::host_now_ns () - host_ns;
+	state[bus].rx_idx = 0;
+	state[bus].error = state[bus].rx_len ? SIM_ACK : SIM_ADDR_NAK;
+	state[bus].status = state[bus].rx_len ? I2C_WAITING : I2C_ADDR_NAK;
+	return state[bus].rx_len;
+	}
+
+void i2c_t3::sendTransmission (i2c_stop stop)
+	{
+	uint64_t	start_ns;
+
+	finish ();
+	start_ns = sim_now_ns;
+	endTransmission (stop);
+	state[bus].done_ns = sim_now_ns;
+	sim_now_ns = start_ns;								// the ISR does the transfer; the caller keeps running
+	}
+
+void i2c_t3::sendRequest (uint8_t address, size_t length, i2c_stop stop)
+	{
+	uint64_t	start_ns;
+
+	finish ();
+	start_ns = sim_now_ns;
+	requestFrom (address, length, stop);
+	state[bus].done_ns = sim_now_ns;
+	sim_now_ns = start_ns;
+	}
+
+uint8_t i2c_t3::done (void)
+	{
+	if (sim_now_ns >= state[bus].done_ns)
+		return 1;
+	sim_now_ns += SIM_CALL_NS;							// a poll that finds the bus busy costs a call; spin loops advance
+	return 0;
+	}
+
+uint8_t i2c_t3::finish (uint32_t timeout)
+	{
+	if (sim_now_ns < state[bus].done_ns)
+		sim_now_ns = state[bus].done_ns;				// wait for the transfer in progress
+	return I2C_WAITING == state[bus].status;
+	}
+
+int i2c_t3::available (void)
+	{
+	return (int)(state[bus].rx_len - state[bus].rx_idx);
+	}
+
+int i2c_t3::read (void)
+	{
+	if (state[bus].rx_idx >= state[bus].rx_len)
+		return -1;
+	return state[bus].rx_buf[state[bus].rx_idx++];
+	}
+
+int i2c_t3::peek (void)
+	{
+	if (state[bus].rx_idx >= state[bus].rx_len)
+		return -1;
+	return state[bus].rx_buf[state[bus].rx_idx];
+	}
+
+uint8_t i2c_t3::getError (void)
+	{
+	return state[bus].error;
+	}
+
+i2c_status i2c_t3::status (void)
+	{
+	return state[bus].status;
+	}
@@ -0,0 +1,86 @@
+#ifndef SALT_HOST_I2C_T3_H_
+#define SALT_HOST_I2C_T3_H_
+
+// i2c_t3.h host stand-in
+//
+// The subset of the i2c_t3 master API used by SALT_ext_sensors and the Systronix sensor drivers.  Transfers are
+// routed to sim_bus[n] (SALT_sim_bus.h) where n is the bus number: Wire is 0, Wire1 is 1, etc.  Like the real
+// i2c_t3, copies of an i2c_t3 object share the bus state so the drivers' by-value copies behave the same as
+// they do on the Teensy.
+//
+// Non-blocking transfers (sendTransmission(), sendRequest()) model the ISR/DMA modes: the transfer is carried
+// out on the simulated bus immediately but simulated time is handed back so that the caller keeps running; the
+// bus is busy, and done() returns 0 (and charges SIM_CALL_NS), until simulated time reaches the end of the
+// transfer.  Any other transfer, and finish(), first waits for (advances simulated time to) the end of the one in
+// progress.
+//
+
+#include <Arduino.h>
+
+enum i2c_mode		{I2C_MASTER, I2C_SLAVE};
+enum i2c_pullup		{I2C_PULLUP_EXT, I2C_PULLUP_INT};
+enum i2c_stop		{I2C_NOSTOP, I2C_STOP};
+enum i2c_op_mode	{I2C_OP_MODE_IMM, I2C_OP_MODE_ISR, I2C_OP_MODE_DMA};
+enum i2c_pins		{I2C_PINS_16_17, I2C_PINS_18_19, I2C_PINS_29_30, I2C_PINS_26_31, I2C_PINS_37_38, I2C_PINS_3_4, I2C_PINS_56_57};
+enum i2c_rate		{I2C_RATE_100 = 100000, I2C_RATE_200 = 200000, I2C_RATE_300 = 300000, I2C_RATE_400 = 400000,
+					I2C_RATE_600 = 600000, I2C_RATE_800 = 800000, I2C_RATE_1000 = 1000000, I2C_RATE_1200 = 1200000};
+enum i2c_status		{I2C_WAITING, I2C_TIMEOUT, I2C_ADDR_NAK, I2C_DATA_NAK, I2C_ARB_LOST, I2C_BUF_OVF, I2C_NOT_ACQ,
+					I2C_DMA_ERR, I2C_SENDING, I2C_SEND_ADDR, I2C_RECEIVING, I2C_SLAVE_TX, I2C_SLAVE_RX};
+
+#define	I2C_BUS_NUM			4
+#define	I2C_TX_BUFFER_LENGTH	259
+#define	I2C_RX_BUFFER_LENGTH	259
+
+class i2c_t3
+	{
+	public:
+		struct i2c_state_t									// per-bus state shared by all copies of an i2c_t3
+			{
+			uint8_t		tx_addr;
+			uint8_t		tx_buf[I2C_TX_BUFFER_LENGTH];
+			size_t		tx_len;
+			uint8_t		rx_buf[I2C_RX_BUFFER_LENGTH];
+			size_t		rx_len;
+			size_t		rx_idx;
+			uint8_t		error;								// 0 or the last endTransmission() error
+			i2c_status	status;
+			uint64_t	done_ns;							// non-blocking transfer in progress until this time
+			};
+
+		i2c_t3 (uint8_t bus) : bus (bus) {}
+
+		void		begin (void) {}
+		void		begin (i2c_mode mode, uint8_t address, i2c_pins pins, i2c_pullup pullup, uint32_t rate, i2c_op_mode op_mode = I2C_OP_MODE_ISR);
+		void		setRate (uint32_t rate);
+		void		setClock (uint32_t rate) {setRate (rate);}	// Wire-compatible name
+		uint32_t	getClock (void);
+		uint8_t		setOpMode (i2c_op_mode op_mode) {return 1;}
+
+		void		beginTransmission (uint8_t address);
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t count);
+		uint8_t		endTransmission (i2c_stop stop = I2C_STOP);
+		size_t		requestFrom (uint8_t address, size_t length, i2c_stop stop = I2C_STOP);
+		void		sendTransmission (i2c_stop stop = I2C_STOP);
+		void		sendRequest (uint8_t address, size_t length, i2c_stop stop = I2C_STOP);
+		uint8_t		done (void);
+		uint8_t		finish (uint32_t timeout = 0);
+
+		int			available (void);
+		int			read (void);
+		uint8_t		readByte (void) {return (uint8_t)read ();}
+		int			peek (void);
+
+		uint8_t		getError (void);
+		i2c_status	status (void);
+
+		uint8_t		bus;									// 0: Wire, 1: Wire1 ...
+		static i2c_state_t	state[I2C_BUS_NUM];
+	};
+
+extern i2c_t3 Wire;
+extern i2c_t3 Wire1;
+extern i2c_t3 Wire2;
+extern i2c_t3 Wire3;
+
+#endif	// SALT_HOST_I2C_T3_H_
@@ -0,0 +1,132 @@
+// sim_discover.cpp
+//
+// Host run: mux eeprom faults at discovery.  Builds the SBS system sim_scan uses and runs full discoveries with
+// the mux[0] eeprom healthy, glitching once (the retry reads it), failing both reads, and erased.  Checks what
+// each one sets up and what it leaves in the topology record for the next boot:
+//	healthy			installed_sensors from the eeprom, no fault, the record saved
+//	one glitch		the same as healthy
+//	read fails		a mux fault, no mux-mounted sensors on mux[0], mux[1] and the port sensors set up, and no record
+//					saved; the next discovery on healthy hardware sets mux[0] up from its eeprom
+//	erased			the uninitialized eeprom exception, installed_sensors from the port[7] probe, and the record
+//					saved with uninit_eep so that a warm boot raises it too
+//
+// Each check prints one line ending ok or FAIL, then a summary.  Exits 1 when a check failed.
+//
+//	sim_discover
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+class check_sensors : public SALT_ext_sensors					// reaches the protected discovery state
+	{
+	public:
+		uint8_t		installed_get (uint8_t m) {return mux[m].installed_sensors;}
+		boolean		partial_get (void) {return topology_partial;}
+		uint8_t		record_load (void) {return topology_load ();}
+		uint8_t		record_installed_get (uint8_t m) {return topology.mux[m].installed_sensors;}
+		boolean		record_uninit_get (uint8_t m) {return topology.mux[m].uninit_eep;}
+	};
+
+static uint32_t	checks = 0;
+static uint32_t	failed = 0;
+
+
+//---------------------------< E X P E C T >------------------------------------------------------------------
+
+static void expect (const char* step, boolean ok)
+	{
+	checks++;
+	if (!ok)
+		failed++;
+	printf ("%-52s  %s\n", step, ok ? "ok" : "FAIL");
+	}
+
+
+//---------------------------< D I S C O V E R >--------------------------------------------------------------
+//
+// a new instance that runs sensor_discover(); with forget, after forgetting the saved record (a full discovery)
+//
+
+static check_sensors* discover (boolean forget)
+	{
+	check_sensors*	ext = new check_sensors ();
+
+	if (forget)
+		ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->log_drain ();
+	return ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	check_sensors*		ext;
+	check_sensors*		boot;									// the next boot's view of the saved record
+	SALT_sim_m24c32*	eep;
+	uint8_t				both = TMP275 | HDC1080;
+	uint8_t				sensors;
+	uint8_t				byte0;
+	uint32_t			mux_faults;
+	uint32_t			uninit;
+
+	Serial.echo = false;
+	sim_bus[1].sbs_add ();
+	eep = (SALT_sim_m24c32*)sim_bus[1].find (SIM_EEP_BASE | 7, 0, 7);
+
+	mux_faults = e7n.e7n_msg[E7N_MUX_FAULT_IDX].count;
+	ext = discover (true);
+	sensors = ext->sensor_count;
+	expect ("healthy: mux[0] sensors from the eeprom", both == ext->installed_get (0));
+	expect ("healthy: no mux fault", mux_faults == e7n.e7n_msg[E7N_MUX_FAULT_IDX].count);
+	boot = new check_sensors ();
+	expect ("healthy: record saved", (SUCCESS == boot->record_load ()) && (both == boot->record_installed_get (0)));
+	delete boot;
+	delete ext;
+
+	eep->read_faults = 1;
+	ext = discover (true);
+	expect ("one glitch: retry reads the eeprom", both == ext->installed_get (0));
+	expect ("one glitch: no mux fault", mux_faults == e7n.e7n_msg[E7N_MUX_FAULT_IDX].count);
+	boot = new check_sensors ();
+	expect ("one glitch: record saved", (SUCCESS == boot->record_load ()) && (both == boot->record_installed_get (0)));
+	delete boot;
+	delete ext;
+
+	eep->read_faults = 2;
+	ext = discover (true);
+	expect ("read fails: mux fault", mux_faults + 1 == e7n.e7n_msg[E7N_MUX_FAULT_IDX].count);
+	expect ("read fails: no mux[0] mux-mounted sensors", 0 == ext->installed_get (0));
+	expect ("read fails: mux[1] set up", both == ext->installed_get (1));
+	expect ("read fails: port sensors set up", sensors == ext->sensor_count);
+	boot = new check_sensors ();
+	expect ("read fails: record not saved", ext->partial_get () && (SUCCESS != boot->record_load ()));
+	delete boot;
+	delete ext;
+
+	ext = discover (false);
+	expect ("after read fails: next boot reads the eeprom", both == ext->installed_get (0));
+	boot = new check_sensors ();
+	expect ("after read fails: record saved", (SUCCESS == boot->record_load ()) && (both == boot->record_installed_get (0)) &&
+		!boot->record_uninit_get (0));
+	delete boot;
+	delete ext;
+
+	byte0 = eep->mem[0];
+	eep->mem[0] = 0xFF;
+	uninit = e7n.e7n_msg[E7N_UNINIT_MUX_IDX].count;
+	ext = discover (true);
+	expect ("erased: uninitialized eeprom exception", uninit + 1 == e7n.e7n_msg[E7N_UNINIT_MUX_IDX].count);
+	expect ("erased: mux[0] sensors from the probe", both == ext->installed_get (0));
+	boot = new check_sensors ();
+	expect ("erased: record saved with uninit_eep", (SUCCESS == boot->record_load ()) && boot->record_uninit_get (0));
+	delete boot;
+	delete ext;
+	eep->mem[0] = byte0;
+
+	printf ("%u checks, %u failed\n", checks, failed);
+	return failed ? 1 : 0;
+	}
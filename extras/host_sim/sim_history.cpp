@@ -0,0 +1,192 @@
+// sim_history.cpp
+//
+// Host run: SALT_ext_history against brute force.  Pushes known sample sequences into one history and, after every
+// push, compares count_get(), min_get(), max_get() and mean_get() of both windows with the same figures computed
+// from a plain copy of every sample pushed.  Steps:
+//	fill			default windows (HIST_SHORT_DEFAULT, HIST_LONG_DEFAULT) while the ring fills
+//	wrap			pseudo-random samples, with ties and negative values, well past HIST_SIZE and past the
+//					sequence number wrap at 256
+//	ramps			rising and falling runs, which keep the min and max queues at their longest
+//	resize			window_set() to 1, 5, HIST_SIZE, 0 (clamps to 1) and 200 (clamps to HIST_SIZE) with the ring
+//					full; each is checked at once and then as more samples are pushed
+//	resize filling	window_set() after clear(), while the ring holds fewer samples than the window
+//	rounding		means that fall on .5, positive and negative: rounded half away from zero
+// No bus is involved; the sim only supplies the stand-in headers.
+//
+// Each step prints one line ending ok or FAIL (with the first mismatch), then a summary.  Exits 1 when a check
+// failed.
+//
+//	sim_history
+//
+
+#include <math.h>
+#include <SALT_ext_sensors.h>
+
+#define	SAMPLES_MAX		2048
+
+static int16_t	samples[SAMPLES_MAX];							// every sample pushed since the last clear()
+static uint16_t	pushed = 0;
+static uint8_t	lens[HIST_WINDOWS] = {HIST_SHORT_DEFAULT, HIST_LONG_DEFAULT};
+static uint32_t	mismatch;										// mismatches in the current step
+static uint32_t	compared;
+static char		first[96];										// the first of them
+static uint32_t	checks = 0;
+static uint32_t	failed = 0;
+static uint32_t	lcg = 1;
+
+
+//---------------------------< R A N D >----------------------------------------------------------------------
+//
+// deterministic pseudo-random value in -range .. range
+//
+
+static int16_t rand_value (int16_t range)
+	{
+	lcg = (lcg * 1103515245) + 12345;
+	return (int16_t)((lcg >> 16) % ((2 * range) + 1)) - range;
+	}
+
+
+//---------------------------< C O M P A R E >----------------------------------------------------------------
+//
+// compare both windows with the brute force figures over the newest samples
+//
+
+static void compare (SALT_ext_history* hist)
+	{
+	for (uint8_t w = 0; w < HIST_WINDOWS; w++)
+		{
+		uint16_t	count = (pushed < HIST_SIZE) ? pushed : HIST_SIZE;
+		int32_t		sum = 0;
+		int16_t		min = 0;
+		int16_t		max = 0;
+		int16_t		mean = 0;
+
+		if (count > lens[w])
+			count = lens[w];
+		for (uint16_t i = pushed - count; i < pushed; i++)
+			{
+			if ((i == pushed - count) || (samples[i] < min))
+				min = samples[i];
+			if ((i == pushed - count) || (samples[i] > max))
+				max = samples[i];
+			sum += samples[i];
+			}
+		if (count)
+			mean = (int16_t)lround ((double)sum / count);
+
+		compared++;
+		if ((count == hist->count_get (w)) && (min == hist->min_get (w)) && (max == hist->max_get (w)) &&
+			(mean == hist->mean_get (w)))
+			continue;
+		if (!mismatch++)
+			snprintf (first, sizeof(first), "sample %u window %u: count %u min %d max %d mean %d (%u %d %d %d)", pushed, w,
+				hist->count_get (w), hist->min_get (w), hist->max_get (w), hist->mean_get (w), count, min, max, mean);
+		}
+	}
+
+
+//---------------------------< P U S H >----------------------------------------------------------------------
+
+static void push (SALT_ext_history* hist, int16_t value)
+	{
+	hist->push (value);
+	samples[pushed++] = value;
+	compare (hist);
+	}
+
+
+//---------------------------< W I N D O W _ S E T >----------------------------------------------------------
+
+static void window_set (SALT_ext_history* hist, uint8_t w, uint8_t len)
+	{
+	hist->window_set (w, len);
+	lens[w] = (0 == len) ? 1 : ((HIST_SIZE < len) ? HIST_SIZE : len);
+	compare (hist);
+	}
+
+
+//---------------------------< C L E A R >--------------------------------------------------------------------
+
+static void clear (SALT_ext_history* hist)
+	{
+	hist->clear ();
+	pushed = 0;
+	compare (hist);
+	}
+
+
+//---------------------------< S T E P >----------------------------------------------------------------------
+//
+// end a step: one line with its result
+//
+
+static void step (const char* name)
+	{
+	checks++;
+	if (mismatch)
+		failed++;
+	printf ("%-16s %5u compares  %s", name, compared, mismatch ? "FAIL" : "ok");
+	if (mismatch)
+		printf ("  %u mismatches; first %s", mismatch, first);
+	printf ("\n");
+	mismatch = 0;
+	compared = 0;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	SALT_ext_history*	hist = new SALT_ext_history ();
+	uint8_t				resize[] = {1, 5, HIST_SIZE, 0, 200, 3};
+
+	compare (hist);
+	for (uint8_t i = 0; i < HIST_SIZE; i++)
+		push (hist, (i * 37) - 500);
+	step ("fill");
+
+	for (uint16_t i = 0; i < 600; i++)
+		push (hist, rand_value (i & 0x40 ? 5 : 3000));				// narrow stretches give ties
+	step ("wrap");
+
+	for (uint8_t r = 0; r < 4; r++)
+		{
+		for (uint8_t i = 0; i < (HIST_SIZE + 8); i++)
+			push (hist, (r & 1) ? (1000 - (i * 10)) : ((i * 10) - 1000));
+		}
+	step ("ramps");
+
+	for (uint8_t k = 0; k < sizeof(resize); k++)
+		{
+		window_set (hist, k & 1, resize[k]);
+		for (uint8_t i = 0; i < 20; i++)
+			push (hist, rand_value (200));
+		}
+	step ("resize");
+
+	clear (hist);
+	for (uint8_t k = 0; k < sizeof(resize); k++)
+		{
+		push (hist, rand_value (200));
+		window_set (hist, HIST_SHORT, resize[k]);
+		window_set (hist, HIST_LONG, resize[sizeof(resize) - 1 - k]);
+		}
+	step ("resize filling");
+
+	clear (hist);
+	window_set (hist, HIST_SHORT, 2);
+	window_set (hist, HIST_LONG, 4);
+	push (hist, 1);
+	push (hist, 2);													// short 1.5 is 2
+	push (hist, -4);
+	push (hist, -1);												// short -2.5 is -3; long -0.5 is -1
+	push (hist, 6);													// short 2.5 is 3
+	push (hist, -7);												// short -0.5 is -1; long -1.5 is -2
+	step ("rounding");
+
+	printf ("%u checks, %u failed\n", checks, failed);
+	delete hist;
+	return failed ? 1 : 0;
+	}
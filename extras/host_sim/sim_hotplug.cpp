@@ -0,0 +1,225 @@
+// sim_hotplug.cpp
+//
+// Host run: sensor health and the hot-plug registry changes.  Builds the SBS system sim_scan uses, with a
+// different temperature on every port sensor, discovers it, and runs passes of sensor_scan() at the example
+// loop() cadence.  Checks:
+//	backoff				with hot-plug off the mux[1].port[1] sensor stops responding: faults_get() counts the passes
+//						1, 2 and 3, the third starts a backoff of 2 (backoff_get()), and the recovery probes come on
+//						passes 5, 9, 17 and 33 as the backoff doubles; put back on pass 40, it is read again on the
+//						next probe, pass 65, and not before
+//	insert				with hot-plug on a sensor is plugged into mux[0].port[4]; in the pass that adds its registry
+//						entry (registry_insert()) every mux[1] sensor moves up one channel and keeps its measurement,
+//						faults, backoff and transfer counters; the new channel starts with none
+//	delete				mux[0].port[3] is unplugged; in the pass that removes its entry (registry_delete()) the
+//						later sensors move down one channel and keep theirs
+//
+// Each check prints one line ending ok or FAIL, then a summary.  Exits 1 when a check failed.
+//
+//	sim_hotplug
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+struct snap_t													// what one sensor's meas channel holds
+	{
+	uint8_t		n;
+	int16_t		centi_c;
+	boolean		valid;
+	uint16_t	faults;
+	uint8_t		backoff;
+	uint32_t	transfers;
+	uint16_t	naks;
+	};
+
+static uint32_t	checks = 0;
+static uint32_t	failed = 0;
+
+
+//---------------------------< E X P E C T >------------------------------------------------------------------
+
+static void expect (const char* step, boolean ok)
+	{
+	checks++;
+	if (!ok)
+		failed++;
+	printf ("%-52s  %s\n", step, ok ? "ok" : "FAIL");
+	}
+
+
+//---------------------------< P A S S >----------------------------------------------------------------------
+
+static void pass (SALT_ext_sensors* ext)
+	{
+	delay (5000);												// example loop() cadence
+	ext->sensor_scan ();
+	ext->log_drain ();
+	}
+
+
+//---------------------------< D E G _ C >--------------------------------------------------------------------
+//
+// the temperature given to the mux[m].port[p] sensor; all different
+//
+
+static float deg_c (uint8_t m, uint8_t p)
+	{
+	return 20.5 + (m * 5) + p;
+	}
+
+
+//---------------------------< S N A P >----------------------------------------------------------------------
+
+static void snap (SALT_ext_sensors* ext, uint8_t m, uint8_t p, snap_t* snap_ptr)
+	{
+	SALT_ext_istats*	istats_ptr = ext->istats_ptr_get (m, p, 0);
+
+	memset (snap_ptr, 0, sizeof(snap_t));
+	snap_ptr->n = ext->meas_channel_get (m, p, 0);
+	if (MEAS_NONE == snap_ptr->n)
+		return;
+	snap_ptr->centi_c = ext->meas.centi_c[snap_ptr->n];
+	snap_ptr->valid = (ext->meas.valid >> snap_ptr->n) & 1;
+	snap_ptr->faults = ext->faults_get (m, p, 0);
+	snap_ptr->backoff = ext->backoff_get (m, p, 0);
+	snap_ptr->transfers = istats_ptr->transfers;
+	snap_ptr->naks = istats_ptr->naks;
+	}
+
+
+//---------------------------< C H A N G E >------------------------------------------------------------------
+//
+// Run passes until the registry size changes (at most 40); returns the passes, 0 when it didn't change.  before[]
+// holds the mux[1].port[0 .. 3] and mux[0].port[4] sensors as they were at the start of the pass that changed it.
+//
+
+static uint8_t change (SALT_ext_sensors* ext, snap_t before[5])
+	{
+	uint8_t	sensors = ext->sensor_count;
+
+	for (uint8_t k = 1; k <= 40; k++)
+		{
+		for (uint8_t p = 0; p < 4; p++)
+			snap (ext, 1, p, &before[p]);
+		snap (ext, 0, 4, &before[4]);
+		pass (ext);
+		if (sensors != ext->sensor_count)
+			return k;
+		}
+	return 0;
+	}
+
+
+//---------------------------< M O V E D >--------------------------------------------------------------------
+//
+// check that the mux[m].port[p] sensor moved by shift channels in the last pass and kept its state; it was read
+// in that pass, which added reads transfers
+//
+
+static void moved (SALT_ext_sensors* ext, const char* kind, uint8_t m, uint8_t p, const snap_t* before, int8_t shift, uint32_t reads)
+	{
+	snap_t	after;
+	char	step[64];
+
+	snap (ext, m, p, &after);
+	snprintf (step, sizeof(step), "%s: mux[%u].port[%u] channel %u -> %u", kind, m, p, before->n, after.n);
+	expect (step, (MEAS_NONE != before->n) && (before->n + shift == after.n));
+	snprintf (step, sizeof(step), "%s: mux[%u].port[%u] meas %d", kind, m, p, after.centi_c);
+	expect (step, after.valid && ((int16_t)(deg_c (m, p) * 100) == after.centi_c));
+	snprintf (step, sizeof(step), "%s: mux[%u].port[%u] faults %u backoff %u", kind, m, p, after.faults, after.backoff);
+	expect (step, (before->faults == after.faults) && (before->backoff == after.backoff));
+	snprintf (step, sizeof(step), "%s: mux[%u].port[%u] istats %u (%u) naks %u (%u)", kind, m, p, after.transfers,
+		before->transfers + reads, after.naks, before->naks);
+	expect (step, (before->transfers + reads == after.transfers) && (before->naks == after.naks));
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	SALT_sim_tmp275*	dead;										// mux[1].port[1]
+	SALT_sim_device*	unplug[2];									// mux[0].port[3] sensor node: tmp275 and eeprom
+	snap_t				before[5];
+	snap_t				after;
+	uint8_t				probes[] = {1, 2, 3, 5, 9, 17, 33};			// passes that count a fault
+	uint8_t				probe = 0;
+	uint32_t			reads;										// transfers of one tmp275 read
+	uint16_t			faults;
+	uint8_t				k;
+	char				step[64];
+
+	Serial.echo = false;
+	sim_bus[1].sbs_add ();
+	for (uint8_t m = 0; m < 2; m++)
+		for (uint8_t p = 0; p < 4; p++)
+			((SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, m, p))->deg_c = deg_c (m, p);
+	dead = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 1, 1);
+	unplug[0] = sim_bus[1].find (SIM_TMP275_BASE, 0, 3);
+	unplug[1] = sim_bus[1].find (SIM_EEP_BASE, 0, 3);
+
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	ext->log_drain ();
+	pass (ext);
+	snap (ext, 1, 0, &before[0]);
+	pass (ext);
+	snap (ext, 1, 0, &after);
+	reads = after.transfers - before[0].transfers;
+
+	dead->present = false;
+	for (k = 1; k <= 64; k++)
+		{
+		faults = ext->faults_get (1, 1, 0);
+		pass (ext);
+		if (faults != ext->faults_get (1, 1, 0))
+			{
+			if ((sizeof(probes) > probe) && (probes[probe] == k))
+				probe++;
+			else
+				probe = 0xFF;										// a fault on the wrong pass
+			}
+		if (3 == k)
+			expect ("backoff: 2 after HEALTH_FAILS_MAX passes", 2 == ext->backoff_get (1, 1, 0));
+		if (40 == k)
+			{
+			dead->present = true;
+			dead->deg_c = 25.0;
+			}
+		}
+	snprintf (step, sizeof(step), "backoff: faults on passes 1 2 3 5 9 17 33 (%u)", ext->faults_get (1, 1, 0));
+	expect (step, sizeof(probes) == probe);
+	expect ("backoff: 32 after the pass 33 probe", 32 == ext->backoff_get (1, 1, 0));
+	expect ("backoff: put back, not read before its probe", (int16_t)(deg_c (1, 1) * 100) == ext->meas.centi_c[ext->meas_channel_get (1, 1, 0)]);
+	pass (ext);
+	expect ("backoff: recovered on the pass 65 probe", !ext->backoff_get (1, 1, 0) && (2500 == ext->meas.centi_c[ext->meas_channel_get (1, 1, 0)]));
+	dead->deg_c = deg_c (1, 1);
+	pass (ext);
+
+	ext->hotplug_set (true);
+	sim_bus[1].port_sensor_add (0, 4, 0, deg_c (0, 4));
+	k = change (ext, before);
+	snprintf (step, sizeof(step), "insert: mux[0].port[4] added (%u passes)", k);
+	expect (step, k && (MEAS_NONE != ext->meas_channel_get (0, 4, 0)));
+	for (uint8_t p = 0; p < 4; p++)
+		moved (ext, "insert", 1, p, &before[p], 1, reads);
+	snap (ext, 0, 4, &after);
+	expect ("insert: new channel is where mux[1] started", after.n == before[0].n);
+	expect ("insert: new channel starts clean", !after.valid && !after.faults && !after.transfers && !after.naks);
+	pass (ext);
+	expect ("insert: new sensor read", (int16_t)(deg_c (0, 4) * 100) == ext->meas.centi_c[ext->meas_channel_get (0, 4, 0)]);
+
+	unplug[0]->present = false;
+	unplug[1]->present = false;
+	k = change (ext, before);
+	snprintf (step, sizeof(step), "delete: mux[0].port[3] removed (%u passes)", k);
+	expect (step, k && (MEAS_NONE == ext->meas_channel_get (0, 3, 0)));
+	moved (ext, "delete", 0, 4, &before[4], -1, reads);
+	for (uint8_t p = 0; p < 4; p++)
+		moved (ext, "delete", 1, p, &before[p], -1, reads);
+
+	printf ("%u checks, %u failed\n", checks, failed);
+	delete ext;
+	return failed ? 1 : 0;
+	}
@@ -0,0 +1,107 @@
+// sim_scan.cpp
+//
+// Host program: runs SALT_ext_sensors discovery and scans against the simulated bus and reports the bus time
+// and transaction counts of each.  The simulated system is an SBS: two mux boards, each with mux-mounted TMP275
+// and HDC1080, and four ports with one TMP275 sensor node each.  Discovery runs twice: the first is a cold boot
+// (full discovery; EEPROM empty), the second, on a fresh SALT_ext_sensors instance, is a warm boot that restores
+// the topology the first one saved.  The scans are then repeated with scan_async() which also reports the time
+// spent inside scan_async() calls; the rest of the elapsed time is free for other loop() work.
+//
+//	sim_scan [rate_khz [scans]]		rate_khz: 100 (default) or 400; forces the simulated bus rate
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+SALT_ext_sensors cold_sensors;
+SALT_ext_sensors ext_sensors;
+
+
+//---------------------------< R E P O R T >------------------------------------------------------------------
+
+static void report (const char* what, uint64_t start_ns)
+	{
+	SALT_sim_bus::stats_t*	stats = &sim_bus[1].stats;
+
+	printf ("%-10s elapsed: %8.3fmS  bus: %8.3fmS  transactions: %4u  bytes: %5u  mux writes: %3u  addr naks: %3u  data naks: %u\n",
+		what, (sim_now_ns - start_ns) / 1e6, stats->bus_ns / 1e6, stats->transactions, stats->bytes, stats->mux_writes,
+		stats->addr_naks, stats->data_naks);
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	rate_khz = (1 < argc) ? atoi (argv[1]) : 100;
+	uint32_t	scans = (2 < argc) ? atoi (argv[2]) : 3;
+	uint64_t	start_ns;
+	char		what[24];								// "async " and a uint32_t
+
+	sim_bus[1].rate_force (rate_khz * 1000);			// ext_sensors is on Wire1
+
+	sim_bus[1].sbs_add ();
+
+	Serial.echo = false;
+	start_ns = sim_now_ns;
+	cold_sensors.sensor_discover ();
+	report ("cold boot", start_ns);
+
+	sim_bus[1].stats_clear ();
+	start_ns = sim_now_ns;
+	ext_sensors.sensor_discover ();
+	report ("warm boot", start_ns);
+	cold_sensors.log_drain ();
+	ext_sensors.log_drain ();
+
+	for (uint32_t n = 0; n < scans; n++)
+		{
+		delay (5000);										// example loop() cadence
+		sim_bus[1].stats_clear ();
+		start_ns = sim_now_ns;
+		ext_sensors.sensor_scan ();
+		ext_sensors.log_drain ();
+		snprintf (what, sizeof(what), "scan %u", n);
+		report (what, start_ns);
+		}
+
+	for (uint32_t n = 0; n < scans; n++)					// the same passes on the transaction queue
+		{
+		uint64_t	blocked_ns = 0;							// time spent inside scan_async() calls
+		uint64_t	call_ns;
+		uint8_t		ret_val;
+
+		delay (5000);
+		sim_bus[1].stats_clear ();
+		start_ns = sim_now_ns;
+		do
+			{
+			call_ns = sim_now_ns;
+			ret_val = ext_sensors.scan_async ();
+			blocked_ns += sim_now_ns - call_ns;
+			delayMicroseconds (20);							// other loop() work between calls
+			}
+		while (SCAN_BUSY == ret_val);
+		ext_sensors.log_drain ();
+		snprintf (what, sizeof(what), "async %u", n);
+		report (what, start_ns);
+		printf ("           cpu in scan_async(): %.3fmS\n", blocked_ns / 1e6);
+		}
+
+	for (uint8_t m = 0; m < 2; m++)
+		printf ("mux[%d] tmp275: %.2fC  hdc1080: %.2fC %.1f%%rh\n", m, ext_sensors.mux_tmp275_data_ptr_get (m)->deg_c,
+			ext_sensors.mux_hdc1080_data_ptr_get (m)->deg_c, ext_sensors.mux_hdc1080_data_ptr_get (m)->rh);
+	printf ("mux[0].port[0].sensor[0] tmp275: %.2fC\n", ext_sensors.tmp275_data_ptr_get (0, 0, 0)->deg_c);
+
+	uint8_t	n = ext_sensors.meas_channel_get (0, 7, 1);			// mux[0] hdc1080
+	printf ("mux[0] hdc1080 meas: %d centi-C  %d centi-F  %d centi-%%rh\n", ext_sensors.meas.centi_c[n],
+		ext_sensors.meas.centi_f[n], ext_sensors.meas.centi_rh[0]);
+
+	SALT_ext_history*	rh = ext_sensors.mux_hdc1080_rh_history_ptr_get (0);
+	printf ("mux[0] hdc1080 rh history: %d samples  min %.2f  max %.2f  mean %.2f%%rh\n", rh->count_get (HIST_LONG),
+		rh->min_get (HIST_LONG) / 100.0, rh->max_get (HIST_LONG) / 100.0, rh->mean_get (HIST_LONG) / 100.0);
+	printf ("exceptions: %u  mux writes saved: %u\n", logs.events, ext_sensors.mux_writes_saved_get ());
+	Serial.echo = true;
+	ext_sensors.istats_dump ();
+	return 0;
+	}
@@ -0,0 +1,145 @@
+// sim_select.cpp
+//
+// Host run: failed port selects in the blocking scans.  Builds the SBS system sim_scan uses, discovers it, and
+// makes the mux[0] control write that enables port[2] fail (stuck_ports), so the mux stays on port[1], whose
+// TMP275 has the same address.  Checks, for sensor_scan() and for sensor_scan_fixed<SALT_TOPOLOGY_SBS>():
+//	the port[2] channel keeps its last reading and doesn't take the port[1] one
+//	port[3] is still read, and the failed select is a mux fault (mux_faults_get())
+// and for sensor_scan(), that the selects of the other ports keep the mux in service, that a mux that nacks every
+// select backs off after HEALTH_FAILS_MAX passes, and that it recovers on its first probe once its selects work.
+//
+// Each check prints one line ending ok or FAIL, then a summary.  Exits 1 when a check failed.
+//
+//	sim_select
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_ext_topology.h>
+#include <SALT_sim_bus.h>
+
+class check_sensors : public SALT_ext_sensors					// reaches the protected scan path state
+	{
+	public:
+		boolean		fixed_get (void) {return 0 != topology_fixed;}
+	};
+
+static uint32_t	checks = 0;
+static uint32_t	failed = 0;
+
+
+//---------------------------< E X P E C T >------------------------------------------------------------------
+
+static void expect (const char* step, boolean ok)
+	{
+	checks++;
+	if (!ok)
+		failed++;
+	printf ("%-52s  %s\n", step, ok ? "ok" : "FAIL");
+	}
+
+
+//---------------------------< P A S S >----------------------------------------------------------------------
+
+static void pass (check_sensors* ext, boolean fixed)
+	{
+	delay (5000);												// example loop() cadence
+	if (fixed)
+		ext->sensor_scan_fixed<SALT_TOPOLOGY_SBS> ();
+	else
+		ext->sensor_scan ();
+	ext->log_drain ();
+	}
+
+
+//---------------------------< C E N T I _ C >----------------------------------------------------------------
+//
+// last mux[0].port[p] reading
+//
+
+static int16_t centi_c (check_sensors* ext, uint8_t p)
+	{
+	return ext->meas.centi_c[ext->meas_channel_get (0, p, 0)];
+	}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// one good pass, then one with the port[2] select failing; returns the instance for more passes
+//
+
+static check_sensors* run (boolean fixed, SALT_sim_pca9548a* mux, SALT_sim_tmp275* tmp275[4])
+	{
+	check_sensors*	ext = new check_sensors ();
+	char			step[64];
+	const char*		kind = fixed ? "fixed" : "scan";
+
+	mux->stuck_ports = 0;
+	tmp275[1]->deg_c = 30.0;
+	tmp275[2]->deg_c = 22.0;
+	tmp275[3]->deg_c = 23.0;
+	ext->topology_forget ();
+	if (fixed)
+		ext->sensor_discover_fixed<SALT_TOPOLOGY_SBS> ();
+	else
+		ext->sensor_discover ();
+	ext->log_drain ();
+	pass (ext, fixed);
+	if (fixed)
+		expect ("fixed: sensor_scan_fixed() on the unrolled path", ext->fixed_get ());
+	snprintf (step, sizeof(step), "%s: good pass reads port[2]", kind);
+	expect (step, (2200 == centi_c (ext, 2)) && (0 == ext->mux_faults_get (0)));
+
+	tmp275[1]->deg_c = 35.0;
+	tmp275[2]->deg_c = 24.0;
+	tmp275[3]->deg_c = 27.0;
+	mux->stuck_ports = (1 << 2);
+	pass (ext, fixed);
+	snprintf (step, sizeof(step), "%s: port[2] keeps its reading (%d)", kind, centi_c (ext, 2));
+	expect (step, 2200 == centi_c (ext, 2));
+	snprintf (step, sizeof(step), "%s: port[1] and port[3] read", kind);
+	expect (step, (3500 == centi_c (ext, 1)) && (2700 == centi_c (ext, 3)));
+	snprintf (step, sizeof(step), "%s: failed select is a mux fault", kind);
+	expect (step, 1 == ext->mux_faults_get (0));
+	return ext;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	check_sensors*		ext;
+	SALT_sim_pca9548a*	mux;
+	SALT_sim_tmp275*	tmp275[4];
+	uint8_t				n;
+
+	Serial.echo = false;
+	sim_bus[1].sbs_add ();
+	mux = (SALT_sim_pca9548a*)sim_bus[1].find (SIM_PCA9548A_BASE, SIM_MAIN_NET, 0);
+	for (uint8_t p = 0; p < 4; p++)
+		tmp275[p] = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 0, p);
+
+	ext = run (false, mux, tmp275);
+	for (n = 1; n < HEALTH_FAILS_MAX; n++)
+		pass (ext, false);
+	expect ("scan: other ports' selects keep the mux in service", (HEALTH_FAILS_MAX == ext->mux_faults_get (0)) &&
+		!ext->mux_backoff_get (0));
+	mux->stuck_ports = 0xFF;									// nacks every select
+	for (n = 0; (n < HEALTH_FAILS_MAX) && !ext->mux_backoff_get (0); n++)
+		pass (ext, false);
+	expect ("scan: backed off after HEALTH_FAILS_MAX passes", (HEALTH_FAILS_MAX == n) && (2 == ext->mux_backoff_get (0)));
+	mux->stuck_ports = 0;
+	tmp275[2]->deg_c = 25.0;
+	for (n = 0; (n < 4) && ext->mux_backoff_get (0); n++)
+		pass (ext, false);
+	expect ("scan: recovered on the first probe (2 passes)", (2 == n) && !ext->mux_backoff_get (0));
+	pass (ext, false);
+	expect ("scan: port[2] read after recovery", 2500 == centi_c (ext, 2));
+	delete ext;
+
+	ext = run (true, mux, tmp275);
+	delete ext;
+
+	printf ("%u checks, %u failed\n", checks, failed);
+	return failed ? 1 : 0;
+	}
@@ -0,0 +1,207 @@
+// sim_thresh.cpp
+//
+// Host run: threshold subscriptions.  Builds the SBS system sim_scan uses, discovers it, subscribes, and moves
+// simulated sensors across the limits, running two passes of sensor_scan() at the example loop() cadence after
+// each move (the HDC1080 reading lags its trigger by one pass).  After each step it checks the subscriptions'
+// callback counts and states:
+//	crossings			mux[0].port[1] temperature, low 20.00°C, high 25.00°C, hyst 1.00°C: into and out of each side,
+//						holding inside the hysteresis band, and going straight from above high to below low and back
+//	remove in callback	two subscriptions on the mux[0] humidity; the first removes itself from its callback, the
+//						second must still be called, and neither again
+//	hot-plug rebinding	with hot-plug on, mux[0].port[3] (above its limit) is unplugged and plugged back: its
+//						subscription unbinds to THRESH_IN and is reported again once its sensor is back, while the
+//						mux[1].port[0] subscription keeps its state on the channel its sensor moves to
+//
+// Each check prints one line, ending ok or FAIL (a count check shows the count and state, then the expected ones in
+// parentheses), then a summary.  Exits 1 when a check failed.
+//
+//	sim_thresh
+//
+
+#include <SALT_ext_sensors.h>
+#include <SALT_sim_bus.h>
+
+struct seen_t													// what a subscription's callback saw
+	{
+	SALT_ext_sensors*	ext;
+	uint32_t	calls;
+	uint8_t		state;
+	int32_t		value;
+	boolean		remove;											// thresh_remove() itself from the callback
+	};
+
+static const char*	state_names[] = {"IN", "ABOVE", "BELOW"};
+static uint32_t	checks = 0;
+static uint32_t	failed = 0;
+
+
+//---------------------------< S E E N _ C B >----------------------------------------------------------------
+
+static void seen_cb (const SALT_ext_sensors::thresh_t* thresh)
+	{
+	seen_t*		seen = (seen_t*)thresh->ctx;
+
+	seen->calls++;
+	seen->state = thresh->state;
+	seen->value = thresh->value;
+	if (seen->remove)
+		seen->ext->thresh_remove (thresh - seen->ext->thresh);
+	}
+
+
+//---------------------------< P A S S E S >------------------------------------------------------------------
+
+static void passes (SALT_ext_sensors* ext, uint8_t count)
+	{
+	for (uint8_t n = 0; n < count; n++)
+		{
+		delay (5000);											// example loop() cadence
+		ext->sensor_scan ();
+		ext->log_drain ();
+		}
+	}
+
+
+//---------------------------< T A L L Y >--------------------------------------------------------------------
+//
+// count a check and end its line
+//
+
+static void tally (boolean ok)
+	{
+	checks++;
+	if (!ok)
+		failed++;
+	printf ("  %s\n", ok ? "ok" : "FAIL");
+	}
+
+
+//---------------------------< E X P E C T >------------------------------------------------------------------
+
+static void expect (const char* step, boolean ok)
+	{
+	printf ("%-44s", step);
+	tally (ok);
+	}
+
+
+//---------------------------< C H E C K >--------------------------------------------------------------------
+//
+// thresh[i] has been called back calls times and is in state
+//
+
+static void check (SALT_ext_sensors* ext, const char* step, uint8_t i, const seen_t* seen, uint32_t calls, uint8_t state)
+	{
+	printf ("%-44s calls %u (%u)  state %-5s (%-5s)", step, seen->calls, calls, state_names[ext->thresh[i].state],
+		state_names[state]);
+	tally ((calls == seen->calls) && (state == ext->thresh[i].state));
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	SALT_ext_sensors*	ext = new SALT_ext_sensors ();
+	SALT_sim_tmp275*	cross;
+	SALT_sim_tmp275*	plug;
+	SALT_sim_tmp275*	moved;
+	SALT_sim_hdc1080*	hdc1080;
+	SALT_sim_device*	unplug;									// mux[0].port[3] node eeprom
+	seen_t				seen[5] = {};
+	uint8_t				i[5];
+	uint8_t				n;
+	uint8_t				sensors;
+
+	Serial.echo = false;
+	sim_bus[1].sbs_add ();
+	cross = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 0, 1);
+	plug = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 0, 3);
+	unplug = sim_bus[1].find (SIM_EEP_BASE, 0, 3);
+	moved = (SALT_sim_tmp275*)sim_bus[1].find (SIM_TMP275_BASE, 1, 0);
+	hdc1080 = (SALT_sim_hdc1080*)sim_bus[1].find (SIM_HDC1080_ADDR, 0, 7);
+
+	for (uint8_t k = 0; k < 5; k++)
+		seen[k].ext = ext;
+	seen[1].remove = true;
+
+	i[0] = ext->thresh_add (0, 1, 0, THRESH_C, 2000, 2500, 100, seen_cb, &seen[0]);	// before discovery
+	ext->topology_forget ();
+	ext->sensor_discover ();
+	i[1] = ext->thresh_add (0, 7, 1, THRESH_RH, THRESH_NO_LOW, 6000, 200, seen_cb, &seen[1]);
+	i[2] = ext->thresh_add (0, 7, 1, THRESH_RH, THRESH_NO_LOW, 6000, 200, seen_cb, &seen[2]);
+	i[3] = ext->thresh_add (0, 3, 0, THRESH_C, THRESH_NO_LOW, 2500, 100, seen_cb, &seen[3]);
+	i[4] = ext->thresh_add (1, 0, 0, THRESH_C, THRESH_NO_LOW, 2100, 100, seen_cb, &seen[4]);
+	ext->log_drain ();
+
+	passes (ext, 2);
+	check (ext, "crossings: inside", i[0], &seen[0], 0, THRESH_IN);
+	cross->deg_c = 25.5;
+	passes (ext, 2);
+	check (ext, "crossings: above high", i[0], &seen[0], 1, THRESH_ABOVE);
+	expect ("crossings: reported value 2550", 2550 == seen[0].value);
+	cross->deg_c = 24.5;
+	passes (ext, 2);
+	check (ext, "crossings: inside high, within hyst", i[0], &seen[0], 1, THRESH_ABOVE);
+	cross->deg_c = 25.5;
+	passes (ext, 2);
+	check (ext, "crossings: above high again", i[0], &seen[0], 1, THRESH_ABOVE);
+	cross->deg_c = 23.5;
+	passes (ext, 2);
+	check (ext, "crossings: back inside", i[0], &seen[0], 2, THRESH_IN);
+	cross->deg_c = 19.5;
+	passes (ext, 2);
+	check (ext, "crossings: below low", i[0], &seen[0], 3, THRESH_BELOW);
+	cross->deg_c = 20.5;
+	passes (ext, 2);
+	check (ext, "crossings: inside low, within hyst", i[0], &seen[0], 3, THRESH_BELOW);
+	cross->deg_c = 26.0;
+	passes (ext, 2);
+	check (ext, "crossings: below low to above high", i[0], &seen[0], 4, THRESH_ABOVE);
+	cross->deg_c = 19.0;
+	passes (ext, 2);
+	check (ext, "crossings: above high to below low", i[0], &seen[0], 5, THRESH_BELOW);
+
+	check (ext, "remove in callback: inside", i[2], &seen[2], 0, THRESH_IN);
+	hdc1080->rh = 65.0;
+	passes (ext, 2);
+	expect ("remove in callback: called once and removed", !ext->thresh[i[1]].cb && (1 == seen[1].calls));
+	check (ext, "remove in callback: other above high", i[2], &seen[2], 1, THRESH_ABOVE);
+	hdc1080->rh = 40.0;
+	passes (ext, 2);
+	hdc1080->rh = 65.0;
+	passes (ext, 2);
+	check (ext, "remove in callback: other again", i[2], &seen[2], 3, THRESH_ABOVE);
+	expect ("remove in callback: removed not called again", 1 == seen[1].calls);
+
+	plug->deg_c = 30.0;
+	moved->deg_c = 22.0;
+	passes (ext, 2);
+	check (ext, "hot-plug: port sensor above high", i[3], &seen[3], 1, THRESH_ABOVE);
+	check (ext, "hot-plug: other mux above high", i[4], &seen[4], 1, THRESH_ABOVE);
+
+	ext->hotplug_set (true);
+	n = ext->thresh[i[4]].n;
+	sensors = ext->sensor_count;
+	plug->present = false;
+	unplug->present = false;
+	for (uint8_t k = 0; (k < 40) && (sensors == ext->sensor_count); k++)
+		passes (ext, 1);
+	check (ext, "hot-plug: unplugged, unbound", i[3], &seen[3], 1, THRESH_IN);
+	check (ext, "hot-plug: moved channel, state kept", i[4], &seen[4], 1, THRESH_ABOVE);
+	expect ("hot-plug: unplugged on no channel", MEAS_NONE == ext->thresh[i[3]].n);
+	expect ("hot-plug: moved one channel down", n - 1 == ext->thresh[i[4]].n);
+
+	plug->present = true;
+	unplug->present = true;
+	for (uint8_t k = 0; (k < 40) && (sensors != ext->sensor_count); k++)
+		passes (ext, 1);
+	passes (ext, 1);
+	check (ext, "hot-plug: plugged back, reported again", i[3], &seen[3], 2, THRESH_ABOVE);
+	check (ext, "hot-plug: moved back, state kept", i[4], &seen[4], 1, THRESH_ABOVE);
+	expect ("hot-plug: moved back to its channel", n == ext->thresh[i[4]].n);
+
+	printf ("%u checks, %u failed\n", checks, failed);
+	delete ext;
+	return failed ? 1 : 0;
+	}
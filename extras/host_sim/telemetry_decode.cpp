@@ -0,0 +1,254 @@
+// telemetry_decode.cpp
+//
+// Host tool: converts a stream of SALT_ext_sensors telemetry records (see T E L E M E T R Y   R E C O R D in
+// SALT_ext_sensors.h) to CSV on stdout, one row per sensor per record:
+//	ms,n,m,p,s,deg_c,rh,mbar,valid,fresh,failed
+// n is the meas channel; m, p and s locate the sensor as meas_channel_get() does (mux-mounted TMP275: p = 7, s = 0;
+// HDC1080 or MS8607: p = 7, s = 1).  rh and mbar are empty except on the humidity channels; mbar is also empty
+// when there is no pressure reading.  deg_c, rh and mbar are the last reading when valid is 0 or fresh is 0.
+//
+// Decoding starts at the first key record.  A record with a bad magic, version, length or check is skipped a byte
+// at a time until one that checks, and decoding starts again at the next key record.  A summary goes to stderr.
+//
+// Self-contained so that it builds without the library:
+//	g++ -O2 extras/host_sim/telemetry_decode.cpp -o telemetry_decode
+//
+//	telemetry_decode [file]		default stdin
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define	TELEMETRY_MAGIC			0xB5						// as SALT_ext_sensors.h
+#define	TELEMETRY_VERSION		1
+#define	TELEMETRY_KEY			1
+#define	TELEMETRY_HEADER		8							// magic, flags, length, ms
+#define	CHANNELS				32							// meas channel bitmaps are 32 bits
+
+static struct
+	{
+	uint8_t		reg;										// MAX_REG_SENSORS and MAX_MUXES of the writer
+	uint8_t		muxes;
+	uint8_t		m[CHANNELS];								// port sensor channel locations
+	uint8_t		p[CHANNELS];
+	uint8_t		s[CHANNELS];
+	uint32_t	present;
+	int32_t		centi_c[CHANNELS];							// values of the previous record
+	int32_t		centi_rh[CHANNELS];
+	int32_t		pa[CHANNELS];
+	} layout;
+
+static struct
+	{
+	uint32_t	records;
+	uint32_t	keys;
+	uint32_t	unkeyed;									// good records skipped while waiting for a key record
+	uint32_t	bad_bytes;									// bytes skipped to resynchronize
+	} counts;
+
+
+//---------------------------< V A R I N T _ G E T >----------------------------------------------------------
+//
+// read one varint at *ptr_ptr, not past end; returns false when it runs past end or is too long
+//
+
+static bool varint_get (const uint8_t** ptr_ptr, const uint8_t* end, uint32_t* value)
+	{
+	const uint8_t*	ptr = *ptr_ptr;
+	uint32_t		shift = 0;
+
+	*value = 0;
+	do
+		{
+		if ((ptr >= end) || (28 < shift))
+			return false;
+		*value |= (uint32_t)(*ptr & 0x7F) << shift;
+		shift += 7;
+		}
+	while (*ptr++ & 0x80);
+
+	*ptr_ptr = ptr;
+	return true;
+	}
+
+
+//---------------------------< S I G N E D _ G E T >----------------------------------------------------------
+//
+// read one zigzag varint and add it to *value
+//
+
+static bool signed_get (const uint8_t** ptr_ptr, const uint8_t* end, int32_t* value)
+	{
+	uint32_t	zigzag;
+
+	if (!varint_get (ptr_ptr, end, &zigzag))
+		return false;
+	*value += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+	return true;
+	}
+
+
+//---------------------------< R E C O R D _ C H E C K >------------------------------------------------------
+//
+// returns the length of the record at ptr, or 0 when avail bytes don't hold one that checks
+//
+
+static uint16_t record_check (const uint8_t* ptr, size_t avail)
+	{
+	uint16_t	len;
+	uint8_t		sum = 0;
+
+	if ((TELEMETRY_HEADER + 1 > avail) || (TELEMETRY_MAGIC != ptr[0]) || (TELEMETRY_VERSION != (ptr[1] >> 4)))
+		return 0;
+
+	len = ptr[2] | (ptr[3] << 8);
+	if ((TELEMETRY_HEADER + 1 > len) || (len > avail))
+		return 0;
+
+	for (uint16_t i = 0; i < len - 1; i++)
+		sum += ptr[i];
+	return ((uint8_t)~sum == ptr[len - 1]) ? len : 0;
+	}
+
+
+//---------------------------< R E C O R D _ D E C O D E >----------------------------------------------------
+//
+// decode the len byte record at record and print its rows; returns false when its contents are inconsistent
+// (the layout is then unknown until the next key record)
+//
+
+static bool record_decode (const uint8_t* record, uint16_t len)
+	{
+	const uint8_t*	ptr = &record[TELEMETRY_HEADER];
+	const uint8_t*	end = &record[len - 1];					// the check byte
+	uint32_t		ms = record[4] | (record[5] << 8) | (record[6] << 16) | ((uint32_t)record[7] << 24);
+	uint32_t		present;
+	uint32_t		valid;
+	uint32_t		fresh;
+	uint32_t		failed;
+	uint8_t			n;
+
+	if (!varint_get (&ptr, end, &present) || !varint_get (&ptr, end, &valid) ||
+			!varint_get (&ptr, end, &fresh) || !varint_get (&ptr, end, &failed))
+		return false;
+
+	if (record[1] & TELEMETRY_KEY)
+		{
+		memset (&layout, 0, sizeof(layout));				// key record entries are the values
+		if (2 > end - ptr)
+			return false;
+		layout.reg = *ptr++;
+		layout.muxes = *ptr++;
+		if (CHANNELS < layout.reg + (2 * layout.muxes))
+			return false;
+		for (n = 0; (n < layout.reg) && (present & (1UL << n)); n++)
+			{
+			if (2 > end - ptr)
+				return false;
+			layout.m[n] = *ptr++;
+			layout.p[n] = *ptr >> 4;
+			layout.s[n] = *ptr++ & 0x0F;
+			}
+		layout.present = present;
+		counts.keys++;
+		}
+	else if (present != layout.present)						// writers key a change of sensors
+		return false;
+
+	for (n = 0; n < CHANNELS; n++)
+		{
+		uint8_t		m;
+		uint8_t		p;
+		uint8_t		s;
+		bool		humidity = (layout.reg + layout.muxes <= n);
+
+		if (!(present & (1UL << n)))
+			continue;
+
+		if (!signed_get (&ptr, end, &layout.centi_c[n]))
+			return false;
+		if (humidity && (!signed_get (&ptr, end, &layout.centi_rh[n]) || !signed_get (&ptr, end, &layout.pa[n])))
+			return false;
+
+		if (layout.reg > n)
+			{
+			m = layout.m[n];
+			p = layout.p[n];
+			s = layout.s[n];
+			}
+		else
+			{
+			m = (n - layout.reg) % layout.muxes;
+			p = 7;
+			s = humidity ? 1 : 0;
+			}
+
+		printf ("%u,%u,%u,%u,%u,%.2f,", ms, n, m, p, s, layout.centi_c[n] / 100.0);
+		if (humidity)
+			printf ("%.2f,", layout.centi_rh[n] / 100.0);
+		else
+			printf (",");
+		if (humidity && layout.pa[n])
+			printf ("%.2f,", layout.pa[n] / 100.0);
+		else
+			printf (",");
+		printf ("%d,%d,%d\n", 0 != (valid & (1UL << n)), 0 != (fresh & (1UL << n)), 0 != (failed & (1UL << n)));
+		}
+
+	counts.records++;
+	return ptr == end;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	FILE*		file = (1 < argc) ? fopen (argv[1], "rb") : stdin;
+	uint8_t*	buf = NULL;
+	size_t		size = 0;
+	size_t		got;
+	size_t		pos = 0;
+	bool		keyed = false;								// layout is known
+
+	if (NULL == file)
+		{
+		perror (argv[1]);
+		return 1;
+		}
+
+	do
+		{
+		buf = (uint8_t*)realloc (buf, size + 65536);
+		got = fread (&buf[size], 1, 65536, file);
+		size += got;
+		}
+	while (got);
+
+	printf ("ms,n,m,p,s,deg_c,rh,mbar,valid,fresh,failed\n");
+	while (pos < size)
+		{
+		uint16_t	len = record_check (&buf[pos], size - pos);
+
+		if (0 == len)
+			{
+			counts.bad_bytes++;
+			keyed = false;
+			pos++;
+			continue;
+			}
+
+		if (keyed || (buf[pos + 1] & TELEMETRY_KEY))
+			keyed = record_decode (&buf[pos], len);
+		else
+			counts.unkeyed++;
+		pos += len;
+		}
+
+	fprintf (stderr, "%u records, %u key records, %u skipped before a key record, %u bad bytes\n",
+		counts.records, counts.keys, counts.unkeyed, counts.bad_bytes);
+	free (buf);
+	return 0;
+	}